@@ -1,16 +1,52 @@
 ﻿#include "shell.h"
+#include "server.h"
+#include "stats.h"
+#include <string.h>
 
-int main() 
+int main(int argc, char* argv[])
 { 
 	Shell shell;
+	const char* stats_path = NULL;
+	int format = OUTPUT_TEXT;
+	int i;
+
+	/* --serve path 로 실행하면 socket으로 여러 client를 받는 server mode */
+	if (argc == 3 && !strcmp(argv[1], "--serve"))
+		return startServer(argv[2]);
+
+	for (i = 1; i + 1 < argc; i += 2) {
+		/* --stats-json path 로 실행하면 종료할 때 명령별 통계를 JSON으로 저장 */
+		if (!strcmp(argv[i], "--stats-json"))
+			stats_path = argv[i + 1];
+		/* --format json 으로 실행하면 명령마다 결과를 JSON 객체 한 줄로 출력 */
+		else if (!strcmp(argv[i], "--format") && !strcmp(argv[i + 1], "json"))
+			format = OUTPUT_JSON;
+		else if (!strcmp(argv[i], "--format") && !strcmp(argv[i + 1], "text"))
+			format = OUTPUT_TEXT;
+		else
+			break;
+	}
+	if (i != argc) {
+		fprintf(stderr, "사용법: %s [--format text|json] [--stats-json path] | --serve path\n", argv[0]);
+		return 1;
+	}
 	
 	/* 초기화 */
 	initializeShell(&shell);
+	shell.format = format;
 
 	/* shell이 초기화 되었으면 실행 */
 	if (shell.init)
 		startShell(&shell);
 
+#ifdef SHELL_STATS
+	if (stats_path != NULL && shell.stats != NULL && !exportStats(shell.stats, stats_path))
+		fprintf(stderr, "%s: 통계를 저장하지 못했습니다.\n", stats_path);
+#else
+	if (stats_path != NULL)
+		fprintf(stderr, "통계 기능 없이(SHELL_STATS) 빌드되었습니다.\n");
+#endif
+
 	/* shell이 종료되면 사용된 모든 자원을 해제 */
 	releaseShell(&shell);
 
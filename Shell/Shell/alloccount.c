@@ -0,0 +1,113 @@
+﻿#include "alloccount.h"
+#include <stdlib.h>
+
+/*************************************************************************************
+* 설명: ALLOC_COUNT로 빌드하고 -Wl,--wrap=malloc 등으로 link하면(Makefile 참고)
+*       우리 코드가 부르는 malloc, calloc, realloc, posix_memalign, aligned_alloc이
+*       이 파일의 __wrap_* 함수로 연결된다. 여기서 횟수와 크기를 센 뒤 원래의
+*       함수(__real_*)를 호출한다. libc 안에서 하는 할당(strdup, fopen 등)은 세지
+*       않는다. 세는 값은 thread마다 따로 두므로 lock이 필요 없고, 한 thread에서
+*       실행한 작업의 전후 값의 차이가 그 작업의 할당 횟수가 된다. libc의 함수를
+*       바꾸지 않으므로 sanitizer와 함께 쓸 수 있다. ALLOC_COUNT 없이 빌드하면
+*       세지 않는다.
+*************************************************************************************/
+#if defined(ALLOC_COUNT)
+
+extern void* __real_malloc(size_t size);
+extern void* __real_calloc(size_t cnt, size_t size);
+extern void* __real_realloc(void* ptr, size_t size);
+extern int __real_posix_memalign(void** ptr, size_t align, size_t size);
+extern void* __real_aligned_alloc(size_t align, size_t size);
+
+extern void* __wrap_malloc(size_t size);
+extern void* __wrap_calloc(size_t cnt, size_t size);
+extern void* __wrap_realloc(void* ptr, size_t size);
+extern int __wrap_posix_memalign(void** ptr, size_t align, size_t size);
+extern void* __wrap_aligned_alloc(size_t align, size_t size);
+
+static __thread unsigned long long alloc_count;
+static __thread unsigned long long alloc_bytes;
+
+void* __wrap_malloc(size_t size)
+{
+	alloc_count++;
+	alloc_bytes += size;
+	return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t cnt, size_t size)
+{
+	alloc_count++;
+	alloc_bytes += cnt * size;
+	return __real_calloc(cnt, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+	alloc_count++;
+	alloc_bytes += size;
+	return __real_realloc(ptr, size);
+}
+
+int __wrap_posix_memalign(void** ptr, size_t align, size_t size)
+{
+	alloc_count++;
+	alloc_bytes += size;
+	return __real_posix_memalign(ptr, align, size);
+}
+
+void* __wrap_aligned_alloc(size_t align, size_t size)
+{
+	alloc_count++;
+	alloc_bytes += size;
+	return __real_aligned_alloc(align, size);
+}
+
+/*************************************************************************************
+* 설명: 할당 횟수를 셀 수 있는 환경인지 확인한다.
+* 인자: 없음
+* 반환값: 셀 수 있으면 true(1), 아니면 false(0)
+*************************************************************************************/
+int isAllocCounted(void)
+{
+	return 1;
+}
+
+/*************************************************************************************
+* 설명: 현재 thread에서 지금까지 메모리를 할당한 횟수를 구한다.
+* 인자: 없음
+* 반환값: 할당 횟수
+*************************************************************************************/
+unsigned long long getAllocCount(void)
+{
+	return alloc_count;
+}
+
+/*************************************************************************************
+* 설명: 현재 thread에서 지금까지 할당을 요청한 메모리의 크기를 구한다.
+* 인자: 없음
+* 반환값: 요청한 byte 수의 합
+*************************************************************************************/
+unsigned long long getAllocBytes(void)
+{
+	return alloc_bytes;
+}
+
+#else
+
+int isAllocCounted(void)
+{
+	return 0;
+}
+
+unsigned long long getAllocCount(void)
+{
+	return 0;
+}
+
+unsigned long long getAllocBytes(void)
+{
+	return 0;
+}
+
+#endif
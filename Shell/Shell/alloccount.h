@@ -0,0 +1,9 @@
+﻿#ifndef ALLOCCOUNT_H_
+#define ALLOCCOUNT_H_
+
+/* 메모리 할당 횟수 관련 함수 */
+extern int isAllocCounted(void);
+extern unsigned long long getAllocCount(void);
+extern unsigned long long getAllocBytes(void);
+
+#endif
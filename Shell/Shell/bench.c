@@ -0,0 +1,1971 @@
+﻿#include "shell.h"
+#include "histogram.h"
+#include "alloccount.h"
+#include "macro.h"
+#include "sicfloat.h"
+#include "objfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define BENCH_KEY_CNT    1000
+#define BENCH_KEY_LEN    7
+#define BENCH_LIST_CNT   1000
+#define BENCH_MIN_NS     10000000ULL
+#define BENCH_TARGET_NS  200000000ULL
+#define BENCH_IMAGE      "sicsim-bench.img"
+#define BENCH_OBJ_TEXT   "sicsim-bench.obj"
+#define BENCH_OBJ_BINARY "sicsim-bench.sob"
+#define BENCH_OBJ_SIZE   0x10000
+#define BENCH_MACRO_CNT  1000
+#define BENCH_FLOAT_CNT  1024
+#define VERIFY_FLOAT_CNT 2000000
+#define VERIFY_OBJ_CNT    300
+#define VERIFY_OBJ_LENGTH 0x2000
+#define VERIFY_OBJ_FLIPS  32
+#define VERIFY_OBJ_SOURCE "sicsim-verify.obj"
+#define VERIFY_OBJ_TEXT   "sicsim-verify.txt"
+#define VERIFY_OBJ_BINARY "sicsim-verify.sob"
+#define VERIFY_OBJ_COPY   "sicsim-verify.cpy"
+#define VERIFY_OBJ_BAD    "sicsim-verify.bad"
+#define VERIFY_BINARY_KINDS 18
+#define VERIFY_TEXT_KINDS   11
+#define REF_FRAC         ((1ULL << SICF_FRAC_BITS) - 1)
+#define REF_EXP_SHIFT    (SICF_EXP_BIAS + SICF_FRAC_BITS)
+#define REF_DIV_SHIFT    80
+#define REF_LIMB_BITS    16
+#define REF_LIMBS        ((SICF_EXP_MAX + SICF_FRAC_BITS + REF_DIV_SHIFT) / REF_LIMB_BITS + 2)
+
+/*************************************************************************************
+* 설명: benchmark 하나에 대한 정보
+* name: 이름. 결과 출력과 filter에 사용한다.
+* run: 측정할 작업을 iterations번 반복하는 함수
+* items: run이 한 번 반복할 때 처리하는 작업(op)의 수
+* bytes: run이 한 번 반복할 때 처리하는 byte 수. 처리량 계산에 사용하며 없으면 0
+*************************************************************************************/
+typedef struct {
+	const char* name;
+	void(*run)(long long iterations);
+	long long items;
+	long long bytes;
+} Benchmark;
+
+/*************************************************************************************
+* 설명: benchmark 하나의 측정 결과
+* iterations: run을 반복한 횟수
+* ns_per_op: op 하나에 걸린 시간 (ns)
+* allocs_per_op: op 하나가 메모리를 할당한 횟수
+* ops_per_sec: 초당 처리한 op의 수
+* mb_per_sec: 초당 처리한 byte 수 (MB), bytes가 0이면 0
+*************************************************************************************/
+typedef struct {
+	long long iterations;
+	double ns_per_op;
+	double allocs_per_op;
+	double ops_per_sec;
+	double mb_per_sec;
+} BenchResult;
+
+/*************************************************************************************
+* 설명: 부동소수점 검증에 사용하는 음이 아닌 큰 정수. limb마다 16 bit씩 little endian
+*       으로 저장한다.
+* cnt: 사용하는 limb의 수
+* limb: 각 limb의 값
+*************************************************************************************/
+typedef struct {
+	int cnt;
+	unsigned int limb[REF_LIMBS];
+} RefNumber;
+
+static Shell shell;
+static char symbol_keys[BENCH_KEY_CNT][BENCH_KEY_LEN];
+static char collide_keys[BENCH_KEY_CNT][BENCH_KEY_LEN];
+static char* symbol_ptrs[BENCH_KEY_CNT];
+static char* collide_ptrs[BENCH_KEY_CNT];
+static char opcode_names[BENCH_KEY_CNT][BENCH_KEY_LEN];
+static char* opcode_keys[BENCH_KEY_CNT];
+static HashTable symbol_table;
+static HashTable collide_table;
+static int opcode_cnt;
+static volatile long long sink;
+static FILE* null_file;
+static SicFloat float_fast[BENCH_FLOAT_CNT];
+static SicFloat float_slow[BENCH_FLOAT_CNT];
+static unsigned long long float_seed = 0x9E3779B97F4A7C15ULL;
+
+static const char* command_lines[] = {
+	"dump 100, 1FF", "fill 0, FFF, 2A", "e 10, 41", "opcode LDA",
+	"opcodelist", "hi", "du", "  f   100 ,  10F , FF  "
+};
+static const char* command_names[] = {
+	"h", "help", "d", "dir", "q", "quit", "hi", "history", "du", "dump", "e", "edit",
+	"f", "fill", "reset", "opcode", "opcodelist", "disasm", "unknown"
+};
+
+static void makeKeys(void);
+static void collectOpcode(void* data, void* aux);
+static void releaseEntry(void* data, void* aux);
+static void runHashInsert(char keys[][BENCH_KEY_LEN], long long iterations);
+static void runHashGet(HashTable* hash, char** keys, int cnt, long long iterations);
+static void setArgs(int argc, const char* a0, const char* a1, const char* a2);
+static BenchResult measure(const Benchmark* bench);
+static void makeFloats(void);
+static void runFloatOps(const SicFloat* values, int fast, long long iterations);
+static unsigned long long nextRandom(void);
+static SicFloat makeRandomFloat(int exp_lo, int exp_hi, int frac_bits);
+static int verifyFloat(void);
+static int referenceSicFloat(int op, SicFloat* f, SicFloat m);
+static int roundRefNumber(int sign, const RefNumber* n, int exp, int sticky, SicFloat* out);
+static void setRefNumber(RefNumber* n, unsigned long long value, int shift);
+static int getRefLength(const RefNumber* n);
+static int getRefBit(const RefNumber* n, int pos);
+static int hasRefBitsBelow(const RefNumber* n, int pos);
+static int compareRefNumber(const RefNumber* a, const RefNumber* b);
+static void addRefNumber(RefNumber* a, const RefNumber* b);
+static void subRefNumber(RefNumber* a, const RefNumber* b);
+static void mulRefNumber(const RefNumber* a, const RefNumber* b, RefNumber* out);
+static unsigned long long divRefNumber(RefNumber* n, unsigned long long d);
+static int verifyObjfile(void);
+static void writeRandomObject(const char* path);
+static int convertObject(const char* src, const char* dst, int binary);
+static char* readBenchFile(const char* path, size_t* len);
+static int openBenchObject(const char* data, size_t len, ObjectFile* obj);
+static int isObjectRejected(const char* data, size_t len);
+static int checkCorruptObject(const char* data, size_t len, SicMachine* machine);
+static int corruptBinary(unsigned char* data, size_t* len, int kind);
+static char* corruptText(const char* text, int kind);
+static void flipBytes(char* data, size_t len, int binary);
+static unsigned int getBenchWord(const unsigned char* src);
+static void putBenchWord(unsigned char* dst, unsigned int value);
+static void makeObject(void);
+static void removeObject(void);
+
+/*************************************************************************************
+* 각 benchmark의 run 함수들
+*************************************************************************************/
+static void benchHashInsertSymbols(long long iterations)
+{
+	runHashInsert(symbol_keys, iterations);
+}
+
+static void benchHashInsertCollide(long long iterations)
+{
+	runHashInsert(collide_keys, iterations);
+}
+
+static void benchHashGetOpcodes(long long iterations)
+{
+	runHashGet(&shell.machine.opcodes->current->table, opcode_keys, opcode_cnt, iterations);
+}
+
+static void benchFindOpcode(long long iterations)
+{
+	long long i;
+
+	for (i = 0; i < iterations; i++) {
+		const SicOpTable* table = beginSicLookup(&shell.machine);
+		sink += findSicOpcode(table, opcode_keys[i % opcode_cnt]) != NULL;
+		endSicLookup(&shell.machine);
+	}
+}
+
+static void benchOpreload(long long iterations)
+{
+	long long i;
+
+	setArgs(0, NULL, NULL, NULL);
+	for (i = 0; i < iterations; i++)
+		runCmdOpreload(&shell);
+}
+
+static void benchHashGetSymbols(long long iterations)
+{
+	runHashGet(&symbol_table, symbol_ptrs, BENCH_KEY_CNT, iterations);
+}
+
+static void benchHashGetCollide(long long iterations)
+{
+	runHashGet(&collide_table, collide_ptrs, BENCH_KEY_CNT, iterations);
+}
+
+static void benchSymbolIndex(long long iterations)
+{
+	long long i;
+	int j;
+
+	for (i = 0; i < iterations; i++) {
+		SymbolTable symbols;
+
+		initializeSymbols(&symbols);
+		for (j = 0; j < BENCH_KEY_CNT; j++)
+			insertSymbol(&symbols, symbol_keys[j], (unsigned int)j * 0x400);
+		sortSymbols(&symbols);
+		releaseSymbols(&symbols);
+	}
+}
+
+static void benchSymbolFindAt(long long iterations)
+{
+	SymbolTable symbols;
+	unsigned int seed = 12345;
+	long long i;
+	int j;
+
+	initializeSymbols(&symbols);
+	for (j = 0; j < BENCH_KEY_CNT; j++)
+		insertSymbol(&symbols, symbol_keys[j], (unsigned int)j * 0x400);
+	sortSymbols(&symbols);
+
+	for (i = 0; i < iterations; i++) {
+		seed = seed * 1103515245 + 12345;
+		sink += findSymbolAt(&symbols, seed % MEM_SIZE) != NULL;
+	}
+	releaseSymbols(&symbols);
+}
+
+static void benchListAddClear(long long iterations)
+{
+	List list;
+	long long i;
+	int j;
+
+	initializeList(&list);
+	for (i = 0; i < iterations; i++) {
+		for (j = 0; j < BENCH_LIST_CNT; j++)
+			addList(&list, &list);
+		clearList(&list);
+	}
+}
+
+static void benchParseCommandLine(long long iterations)
+{
+	int cnt = sizeof(command_lines) / sizeof(command_lines[0]);
+	long long i;
+
+	for (i = 0; i < iterations; i++) {
+		shell.error = ERR_NONE;
+		parseCommandLine(&shell, command_lines[i % cnt]);
+		sink += shell.argc;
+	}
+}
+
+static void benchGetCommandCode(long long iterations)
+{
+	int cnt = sizeof(command_names) / sizeof(command_names[0]);
+	long long i;
+
+	for (i = 0; i < iterations; i++)
+		sink += getCommandCode((char*)command_names[i % cnt]);
+}
+
+static void benchDump160(long long iterations)
+{
+	long long i;
+
+	setArgs(0, NULL, NULL, NULL);
+	for (i = 0; i < iterations; i++) {
+		shell.mem_addr = 0;
+		runCmdDump(&shell);
+	}
+}
+
+static void benchDump4K(long long iterations)
+{
+	long long i;
+
+	setArgs(2, "0", "FFF", NULL);
+	for (i = 0; i < iterations; i++)
+		runCmdDump(&shell);
+}
+
+static void benchDumpAll(long long iterations)
+{
+	long long i;
+
+	setArgs(2, "0", "FFFFF", NULL);
+	for (i = 0; i < iterations; i++)
+		runCmdDump(&shell);
+}
+
+static void benchJsonDump4K(long long iterations)
+{
+	long long i;
+
+	shell.format = OUTPUT_JSON;
+	for (i = 0; i < iterations; i++)
+		runCommandLine(&shell, "dump 0, FFF");
+	shell.format = OUTPUT_TEXT;
+}
+
+static void benchEdit(long long iterations)
+{
+	long long i;
+
+	setArgs(2, "100", "2A", NULL);
+	for (i = 0; i < iterations; i++)
+		runCmdEdit(&shell);
+}
+
+static void benchLibEdit(long long iterations)
+{
+	unsigned char value = 0x2A;
+	long long i;
+
+	for (i = 0; i < iterations; i++)
+		writeSicMemory(&shell.machine, 0x100, &value, 1);
+}
+
+static void benchLibRead4K(long long iterations)
+{
+	static unsigned char buffer[0x1000];
+	long long i;
+
+	for (i = 0; i < iterations; i++)
+		sink += readSicMemory(&shell.machine, (unsigned int)(i & 0xFF) << 12, buffer, sizeof(buffer));
+}
+
+static void benchLibFill4K(long long iterations)
+{
+	long long i;
+
+	for (i = 0; i < iterations; i++)
+		fillSicMemory(&shell.machine, 0, 0x1000, 0x2A);
+}
+
+static void readNullDevice(SicDevice* device, unsigned int offset, unsigned char* dst, unsigned int len)
+{
+	memset(dst, 0, len);
+}
+
+static void writeNullDevice(SicDevice* device, unsigned int offset, const unsigned char* src, unsigned int len)
+{
+	sink += src[0];
+}
+
+static SicDevice null_device = { "null", readNullDevice, writeNullDevice, NULL, 0 };
+
+/* 다른 곳에 ROM과 장치가 있을 때 RAM page를 읽고 쓰는 비용을 잰다 */
+static void benchLibFill4KPaged(long long iterations)
+{
+	long long i;
+
+	setSicPages(&shell.machine, 0xFE000, SIC_PAGE_SIZE, SIC_PAGE_ROM);
+	mapSicDevice(&shell.machine, 0xFF000, SIC_PAGE_SIZE, &null_device);
+	for (i = 0; i < iterations; i++)
+		fillSicMemory(&shell.machine, 0, 0x1000, 0x2A);
+	setSicPages(&shell.machine, 0xFE000, 2 * SIC_PAGE_SIZE, SIC_PAGE_RAM);
+}
+
+static void benchLibReadMmio4K(long long iterations)
+{
+	static unsigned char buffer[0x1000];
+	long long i;
+
+	mapSicDevice(&shell.machine, 0xFF000, SIC_PAGE_SIZE, &null_device);
+	for (i = 0; i < iterations; i++)
+		sink += readSicMemory(&shell.machine, 0xFF000, buffer, sizeof(buffer));
+	setSicPages(&shell.machine, 0xFF000, SIC_PAGE_SIZE, SIC_PAGE_RAM);
+}
+
+static void benchFill16(long long iterations)
+{
+	long long i;
+
+	setArgs(3, "100", "10F", "2A");
+	for (i = 0; i < iterations; i++)
+		runCmdFill(&shell);
+}
+
+static void benchFill4K(long long iterations)
+{
+	long long i;
+
+	setArgs(3, "0", "FFF", "2A");
+	for (i = 0; i < iterations; i++)
+		runCmdFill(&shell);
+}
+
+static void benchFillAll(long long iterations)
+{
+	long long i;
+
+	setArgs(3, "0", "FFFFF", "2A");
+	for (i = 0; i < iterations; i++)
+		runCmdFill(&shell);
+}
+
+static void benchFillPatternAll(long long iterations)
+{
+	long long i;
+
+	setArgs(3, "0", "FFFFF", "DEADBEEF");
+	for (i = 0; i < iterations; i++)
+		runCmdFill(&shell);
+}
+
+/* 겹치는 범위를 1 byte씩 밀어서 memmove 경로를 잰다 */
+static void benchMoveAll(long long iterations)
+{
+	long long i;
+
+	setArgs(3, "0", "1", "FFFFF");
+	for (i = 0; i < iterations; i++)
+		runCmdMove(&shell);
+}
+
+static void benchCompareHalf(long long iterations)
+{
+	long long i;
+
+	fillSicMemory(&shell.machine, 0, MEM_SIZE, 0x2A);
+	setArgs(3, "0", "80000", "80000");
+	for (i = 0; i < iterations; i++)
+		runCmdCompare(&shell);
+}
+
+static void benchResetAll(long long iterations)
+{
+	long long i;
+
+	setArgs(0, NULL, NULL, NULL);
+	for (i = 0; i < iterations; i++)
+		runCmdReset(&shell);
+}
+
+static void benchUndoRedoFillAll(long long iterations)
+{
+	long long i;
+
+	setArgs(3, "0", "FFFFF", "55");
+	runCmdFill(&shell);
+	setArgs(0, NULL, NULL, NULL);
+	for (i = 0; i < iterations; i++) {
+		runCmdUndo(&shell);
+		runCmdRedo(&shell);
+	}
+}
+
+static void benchSaveAll(long long iterations)
+{
+	long long i;
+
+	setArgs(1, BENCH_IMAGE, NULL, NULL);
+	for (i = 0; i < iterations; i++)
+		runCmdSave(&shell);
+}
+
+static void benchLoadAll(long long iterations)
+{
+	long long i;
+
+	setArgs(1, BENCH_IMAGE, NULL, NULL);
+	runCmdSave(&shell);
+	for (i = 0; i < iterations; i++)
+		runCmdLoad(&shell);
+	remove(BENCH_IMAGE);
+}
+
+static void benchLoadObjText(long long iterations)
+{
+	long long i;
+
+	makeObject();
+	setArgs(2, BENCH_OBJ_TEXT, "1000", NULL);
+	for (i = 0; i < iterations; i++)
+		runCmdLoadobj(&shell);
+	removeObject();
+}
+
+static void benchLoadObjBinary(long long iterations)
+{
+	long long i;
+
+	makeObject();
+	setArgs(2, BENCH_OBJ_BINARY, "1000", NULL);
+	for (i = 0; i < iterations; i++)
+		runCmdLoadobj(&shell);
+	removeObject();
+}
+
+static void benchMacroExpand(long long iterations)
+{
+	static const char* header =
+		"COPY     START   0\n"
+		"RDBUFF   MACRO   &INDEV,&BUFADR,&RECLTH,&EOR=04\n"
+		"         CLEAR   X\n"
+		"         IF      (&EOR NE '')\n"
+		"         LDCH    =X'&EOR'\n"
+		"         ENDIF\n"
+		"$LOOP    TD      =X'&INDEV'\n"
+		"         JEQ     $LOOP\n"
+		"         STCH    &BUFADR,X\n"
+		"         STX     &RECLTH\n"
+		"         MEND\n";
+	static char source[BENCH_MACRO_CNT * 40 + 512];
+	long long i;
+	int len;
+
+	len = sprintf(source, "%s", header);
+	for (i = 0; i < BENCH_MACRO_CNT; i++)
+		len += sprintf(source + len, "         RDBUFF  F1,BUFFER,LENGTH\n");
+
+	for (i = 0; i < iterations; i++) {
+		MacroProcessor mp;
+		FILE* in = fmemopen(source, len, "r");
+
+		initializeMacro(&mp);
+		processMacroFile(&mp, in, null_file);
+		releaseMacro(&mp);
+		fclose(in);
+	}
+}
+
+static void benchFloatFast(long long iterations)
+{
+	runFloatOps(float_fast, true, iterations);
+}
+
+static void benchFloatSlow(long long iterations)
+{
+	runFloatOps(float_fast, false, iterations);
+}
+
+static void benchFloatEdge(long long iterations)
+{
+	runFloatOps(float_slow, true, iterations);
+}
+
+static void benchParseOpcode(long long iterations)
+{
+	SicOpcodes opcodes = { NULL, };
+	Shell tmp;
+	long long i;
+
+	tmp.machine.opcodes = &opcodes;
+	for (i = 0; i < iterations; i++) {
+		tmp.error = ERR_NONE;
+		parseOpcode(&tmp);
+		clearSicOpcodes(&tmp.machine);
+	}
+	free(opcodes.current);
+}
+
+static void benchShellStartup(long long iterations)
+{
+	Shell tmp;
+	long long i;
+
+	for (i = 0; i < iterations; i++) {
+		initializeShell(&tmp);
+		releaseShell(&tmp);
+	}
+}
+
+static const Benchmark benchmarks[] = {
+	{ "hash_insert_symbols",  benchHashInsertSymbols, BENCH_KEY_CNT,  0 },
+	{ "hash_insert_collide",  benchHashInsertCollide, BENCH_KEY_CNT,  0 },
+	{ "hash_get_opcodes",     benchHashGetOpcodes,    1,              0 },
+	{ "lib_find_opcode",      benchFindOpcode,        1,              0 },
+	{ "hash_get_symbols",     benchHashGetSymbols,    1,              0 },
+	{ "hash_get_collide",     benchHashGetCollide,    1,              0 },
+	{ "symbol_index_build",   benchSymbolIndex,       BENCH_KEY_CNT,  0 },
+	{ "symbol_find_at",       benchSymbolFindAt,      1,              0 },
+	{ "list_add_clear",       benchListAddClear,      BENCH_LIST_CNT, 0 },
+	{ "parse_command_line",   benchParseCommandLine,  1,              0 },
+	{ "get_command_code",     benchGetCommandCode,    1,              0 },
+	{ "cmd_dump_160",         benchDump160,           1,              160 },
+	{ "cmd_dump_4k",          benchDump4K,            1,              0x1000 },
+	{ "cmd_dump_all",         benchDumpAll,           1,              MEM_SIZE },
+	{ "json_dump_4k",         benchJsonDump4K,        1,              0x1000 },
+	{ "cmd_edit",             benchEdit,              1,              1 },
+	{ "lib_edit",             benchLibEdit,           1,              1 },
+	{ "lib_read_4k",          benchLibRead4K,         1,              0x1000 },
+	{ "lib_fill_4k",          benchLibFill4K,         1,              0x1000 },
+	{ "lib_fill_4k_paged",    benchLibFill4KPaged,    1,              0x1000 },
+	{ "lib_read_mmio_4k",     benchLibReadMmio4K,     1,              0x1000 },
+	{ "cmd_fill_16",          benchFill16,            1,              0x10 },
+	{ "cmd_fill_4k",          benchFill4K,            1,              0x1000 },
+	{ "cmd_fill_all",         benchFillAll,           1,              MEM_SIZE },
+	{ "cmd_fill_pattern_all", benchFillPatternAll,    1,              MEM_SIZE },
+	{ "cmd_move_all",         benchMoveAll,           1,              MEM_SIZE - 1 },
+	{ "cmd_compare_half",     benchCompareHalf,       1,              MEM_SIZE },
+	{ "cmd_reset",            benchResetAll,          1,              MEM_SIZE },
+	{ "cmd_undo_redo_all",    benchUndoRedoFillAll,   2,              2 * MEM_SIZE },
+	{ "cmd_save_all",         benchSaveAll,           1,              MEM_SIZE },
+	{ "cmd_load_all",         benchLoadAll,           1,              MEM_SIZE },
+	{ "loadobj_text_64k",     benchLoadObjText,       1,              BENCH_OBJ_SIZE },
+	{ "loadobj_binary_64k",   benchLoadObjBinary,     1,              BENCH_OBJ_SIZE },
+	{ "macro_expand",         benchMacroExpand,       BENCH_MACRO_CNT, 0 },
+	{ "float_ops_fast",       benchFloatFast,         BENCH_FLOAT_CNT, 0 },
+	{ "float_ops_slow",       benchFloatSlow,         BENCH_FLOAT_CNT, 0 },
+	{ "float_ops_edge",       benchFloatEdge,         BENCH_FLOAT_CNT, 0 },
+	{ "parse_opcode",         benchParseOpcode,       1,              0 },
+	{ "cmd_opreload",         benchOpreload,          1,              0 },
+	{ "shell_startup",        benchShellStartup,      1,              0 },
+};
+
+/*************************************************************************************
+* 설명: shell의 핵심 자료구조와 명령들의 성능을 측정한다. opcode.txt가 있는
+*       디렉토리에서 실행해야 한다.
+* 사용법: sicsim-bench [--json] [--verify-float] [--verify-objfile] [name...]
+* - --json: 결과를 JSON 배열로 출력한다. 버전 간 성능 변화를 기록하는데 사용한다.
+* - --verify-float: 측정하지 않고 부동소수점 연산의 fast path와 slow path의 결과를
+*   손으로 계산한 결과 및 큰 정수로 계산한 결과와 비교한다. 다른 결과가 있으면
+*   1을 반환한다.
+* - --verify-objfile: 측정하지 않고 임의의 object program으로 text와 binary 형식의
+*   변환과 load를 비교하고, 망가뜨린 file을 거절하는지 확인한다. 틀린 것이 있으면
+*   1을 반환한다.
+* - name: 이름에 해당 문자열이 들어있는 benchmark만 실행한다.
+*************************************************************************************/
+int main(int argc, char* argv[])
+{
+	int bench_cnt = sizeof(benchmarks) / sizeof(benchmarks[0]);
+	int json = false;
+	int filter_cnt = 0;
+	int printed = 0;
+	int i, j;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--json"))
+			json = true;
+		else if (!strcmp(argv[i], "--verify-float"))
+			return verifyFloat();
+		else if (!strcmp(argv[i], "--verify-objfile"))
+			return verifyObjfile();
+		else
+			argv[1 + filter_cnt++] = argv[i];
+	}
+
+	initializeShell(&shell);
+	if (!shell.init)
+		return 1;
+	null_file = fopen("/dev/null", "w");
+	shell.out.fd = open("/dev/null", O_WRONLY);
+	if (null_file == NULL || shell.out.fd < 0)
+		return 1;
+	makeKeys();
+	makeFloats();
+
+	if (json)
+		printf("[\n");
+	else
+		printf("%-22s %12s %12s %12s %14s %10s\n",
+			"benchmark", "iterations", "ns/op", "allocs/op", "ops/s", "MB/s");
+
+	for (i = 0; i < bench_cnt; i++) {
+		const Benchmark* bench = &benchmarks[i];
+		BenchResult result;
+		int selected = filter_cnt == 0;
+
+		for (j = 0; j < filter_cnt; j++) {
+			if (strstr(bench->name, argv[1 + j]) != NULL)
+				selected = true;
+		}
+		if (!selected)
+			continue;
+
+		result = measure(bench);
+		if (json) {
+			printf("%s  {\"name\": \"%s\", \"iterations\": %lld, \"ns_per_op\": %.3f, "
+				"\"allocs_per_op\": %.3f, \"ops_per_sec\": %.1f, \"mb_per_sec\": %.3f}",
+				printed ? ",\n" : "", bench->name, result.iterations, result.ns_per_op,
+				isAllocCounted() ? result.allocs_per_op : -1.0, result.ops_per_sec, result.mb_per_sec);
+		}
+		else {
+			printf("%-22s %12lld %12.1f %12.2f %14.0f %10.1f\n", bench->name, result.iterations,
+				result.ns_per_op, result.allocs_per_op, result.ops_per_sec, result.mb_per_sec);
+		}
+		fflush(stdout);
+		printed++;
+	}
+
+	if (json)
+		printf("\n]\n");
+
+	foreachHash(&symbol_table, NULL, releaseEntry);
+	clearHash(&symbol_table);
+	foreachHash(&collide_table, NULL, releaseEntry);
+	clearHash(&collide_table);
+	fclose(null_file);
+	flushOutput(&shell.out);
+	close(shell.out.fd);
+	shell.out.fd = -1;
+	releaseShell(&shell);
+
+	return 0;
+}
+
+/*************************************************************************************
+* 설명: benchmark를 반복 실행하여 op당 시간과 할당 횟수를 측정한다. 반복 횟수를
+*       두 배씩 늘려가며 BENCH_MIN_NS 이상 걸리는 횟수를 찾고, 그 결과로 BENCH_TARGET_NS
+*       동안 실행할 횟수를 정해서 다시 측정한다.
+* 인자:
+* - bench: 측정할 benchmark
+* 반환값: 측정 결과
+*************************************************************************************/
+static BenchResult measure(const Benchmark* bench)
+{
+	BenchResult result;
+	unsigned long long begin;
+	unsigned long long elapsed;
+	unsigned long long allocs;
+	long long iterations = 1;
+	double ops;
+
+	/* 반복 횟수 조정 */
+	for (;;) {
+		begin = getTimeNs();
+		bench->run(iterations);
+		elapsed = getTimeNs() - begin;
+		if (elapsed >= BENCH_MIN_NS)
+			break;
+		iterations *= 2;
+	}
+	iterations = (long long)((double)iterations * BENCH_TARGET_NS / elapsed) + 1;
+
+	/* 측정 */
+	allocs = getAllocCount();
+	begin = getTimeNs();
+	bench->run(iterations);
+	elapsed = getTimeNs() - begin;
+	allocs = getAllocCount() - allocs;
+
+	ops = (double)iterations * bench->items;
+	result.iterations = iterations;
+	result.ns_per_op = elapsed / ops;
+	result.allocs_per_op = allocs / ops;
+	result.ops_per_sec = ops * 1e9 / elapsed;
+	result.mb_per_sec = (double)bench->bytes * iterations * 1e9 / elapsed / (1024.0 * 1024.0);
+
+	return result;
+}
+
+/*************************************************************************************
+* 설명: hash table benchmark에 사용할 key들을 만든다.
+*       - symbol_keys: label처럼 생긴 임의의 6글자 문자열 (보통의 경우)
+*       - collide_keys: 문자 코드의 합이 20으로 나누어 떨어져서 shell의 hash 함수로
+*         모두 같은 bucket에 들어가는 문자열 (최악의 경우)
+*       - opcode_keys: opcode table에 들어있는 mnemonic들
+*       그리고 symbol_keys와 collide_keys로 조회용 hash table을 미리 만들어둔다.
+* 인자: 없음
+* 반환값: 없음
+*************************************************************************************/
+static void makeKeys(void)
+{
+	unsigned int seed = 12345;
+	int cnt = 0;
+	int i, j;
+
+	for (i = 0; i < BENCH_KEY_CNT; i++) {
+		for (j = 0; j < BENCH_KEY_LEN - 1; j++) {
+			seed = seed * 1103515245 + 12345;
+			symbol_keys[i][j] = 'A' + (seed >> 16) % 26;
+		}
+		symbol_keys[i][j] = 0;
+	}
+
+	while (cnt < BENCH_KEY_CNT) {
+		int sum = 0;
+		for (j = 0; j < BENCH_KEY_LEN - 1; j++) {
+			seed = seed * 1103515245 + 12345;
+			collide_keys[cnt][j] = 'A' + (seed >> 16) % 26;
+			sum += collide_keys[cnt][j];
+		}
+		collide_keys[cnt][j] = 0;
+		if (sum % 20 == 0)
+			cnt++;
+	}
+
+	opcode_cnt = 0;
+	foreachHash(&shell.machine.opcodes->current->table, NULL, collectOpcode);
+
+	initializeHash(&symbol_table, shell.machine.opcodes->current->table.hash_func, shell.machine.opcodes->current->table.cmp);
+	initializeHash(&collide_table, shell.machine.opcodes->current->table.hash_func, shell.machine.opcodes->current->table.cmp);
+	for (i = 0; i < BENCH_KEY_CNT; i++) {
+		symbol_ptrs[i] = symbol_keys[i];
+		collide_ptrs[i] = collide_keys[i];
+		insertHash(&symbol_table, symbol_keys[i], symbol_keys[i]);
+		insertHash(&collide_table, collide_keys[i], collide_keys[i]);
+	}
+}
+
+/*************************************************************************************
+* 설명: 부동소수점 benchmark에 사용할 operand들을 만든다.
+*       - float_fast: 1e-6 ~ 1e6 정도의 정규화된 수. 대부분 fast path로 계산된다.
+*       - float_slow: 정규화되지 않았거나 exponent가 범위의 끝에 있어서 항상 slow
+*         path로 계산되는 수
+* 인자: 없음
+* 반환값: 없음
+*************************************************************************************/
+static void makeFloats(void)
+{
+	int i;
+
+	for (i = 0; i < BENCH_FLOAT_CNT; i++) {
+		float_fast[i] = makeRandomFloat(SICF_EXP_BIAS - 20, SICF_EXP_BIAS + 20, SICF_FRAC_BITS);
+		if (i % 2 == 0)
+			float_slow[i] = makeRandomFloat(0, 40, SICF_FRAC_BITS) >> 3;
+		else
+			float_slow[i] = makeRandomFloat(SICF_EXP_MAX - 4, SICF_EXP_MAX, SICF_FRAC_BITS);
+	}
+}
+
+/*************************************************************************************
+* 설명: values의 이웃한 수끼리 네 가지 연산을 차례로 하는 작업을 iterations번
+*       반복한다. 한 번 반복할 때 BENCH_FLOAT_CNT번 연산한다.
+* 인자:
+* - values: operand들
+* - fast: fast path를 사용할지 여부
+* - iterations: 반복 횟수
+* 반환값: 없음
+*************************************************************************************/
+static void runFloatOps(const SicFloat* values, int fast, long long iterations)
+{
+	long long i;
+	int j;
+
+	for (i = 0; i < iterations; i++) {
+		for (j = 0; j < BENCH_FLOAT_CNT; j++) {
+			SicFloat f = values[j];
+			sink += operateSicFloat(j & 3, &f, values[(j + 1) % BENCH_FLOAT_CNT], fast);
+			sink += (long long)f;
+		}
+	}
+}
+
+/*************************************************************************************
+* 설명: xorshift64*로 다음 난수를 만든다. 결과가 항상 같도록 seed는 고정되어 있다.
+* 인자: 없음
+* 반환값: 64 bit 난수
+*************************************************************************************/
+static unsigned long long nextRandom(void)
+{
+	float_seed ^= float_seed >> 12;
+	float_seed ^= float_seed << 25;
+	float_seed ^= float_seed >> 27;
+	return float_seed * 0x2545F4914F6CDD1DULL;
+}
+
+/*************************************************************************************
+* 설명: exponent가 [exp_lo, exp_hi]이고 부호가 임의인 정규화된 수를 만든다.
+*       fraction은 위쪽 frac_bits개의 bit만 임의로 정하고 나머지는 0으로 두어서,
+*       frac_bits가 작으면 연산 결과가 정확히 중간값이 되는 경우가 자주 생긴다.
+* 인자:
+* - exp_lo, exp_hi: exponent의 범위
+* - frac_bits: 임의로 정할 fraction의 bit 수 (1 ~ 36)
+* 반환값: 만든 수
+*************************************************************************************/
+static SicFloat makeRandomFloat(int exp_lo, int exp_hi, int frac_bits)
+{
+	unsigned long long r = nextRandom();
+	unsigned long long frac = (nextRandom() >> (64 - frac_bits)) << (SICF_FRAC_BITS - frac_bits);
+	int exp = exp_lo + (int)(r % (unsigned)(exp_hi - exp_lo + 1));
+
+	frac |= 1ULL << (SICF_FRAC_BITS - 1);
+	return ((r >> 32) & 1ULL) << 47 | (SicFloat)exp << SICF_FRAC_BITS | frac;
+}
+
+/*************************************************************************************
+* 설명: 부동소수점 연산을 검사한다. 먼저 손으로 계산한 결과(중간값의 짝수 round,
+*       fraction의 자리 올림, overflow/underflow 경계, 정규화되지 않은 operand)를
+*       확인하고, 임의의 operand에 대해 fast path와 slow path의 결과(값과 상태)를
+*       sicfloat.c와 따로 구현한 큰 정수 모델(referenceSicFloat)의 결과와
+*       VERIFY_FLOAT_CNT번 비교한다. operand는 fast path 범위의 수, 중간값이 되기
+*       쉬운 짧은 fraction의 수, exponent가 비슷한 수(뺄셈의 자릿수 소실),
+*       overflow/underflow 근처의 수, 정규화되지 않은 수를 섞어서 만든다.
+* 인자: 없음
+* 반환값: 모두 같으면 0, 다른 것이 있으면 1
+*************************************************************************************/
+static int verifyFloat(void)
+{
+	static const struct {
+		int op;
+		SicFloat f, m, expect;
+		int status;
+	} known[] = {
+		{ SICF_ADD, 0x401800000000ULL, 0x401800000000ULL, 0x402800000000ULL, SICF_OK },        /* 1 + 1 = 2 */
+		{ SICF_SUB, 0x401800000000ULL, 0x401800000000ULL, 0, SICF_OK },                        /* 1 - 1 = 0 */
+		{ SICF_DIV, 0x402C00000000ULL, 0x402800000000ULL, 0x401C00000000ULL, SICF_OK },        /* 3 / 2 = 1.5 */
+		{ SICF_DIV, 0x401800000000ULL, 0x402C00000000ULL, 0x3FFAAAAAAAABULL, SICF_OK },        /* 1 / 3 */
+		{ SICF_MUL, 0xC02C00000000ULL, 0x402C00000000ULL, 0xC04900000000ULL, SICF_OK },        /* -3 * 3 = -9 */
+		{ SICF_ADD, 0x401800000000ULL, 0x3DD800000000ULL, 0x401800000000ULL, SICF_OK },        /* 1 + 2^-37: tie, even */
+		{ SICF_ADD, 0x401800000001ULL, 0x3DD800000000ULL, 0x401800000002ULL, SICF_OK },        /* tie, odd → 올림 */
+		{ SICF_MUL, 0x7FFFFFFFFFFFULL, 0x402800000000ULL, 0x7FFFFFFFFFFFULL, SICF_OVERFLOW },
+		{ SICF_MUL, 0x000800000000ULL, 0x000800000000ULL, 0, SICF_UNDERFLOW },
+		{ SICF_DIV, 0x401800000000ULL, 0, 0x401800000000ULL, SICF_DIVZERO },
+		{ SICF_SUB, 0x401800000000ULL, 0x3DC800000000ULL, 0x401800000000ULL, SICF_OK },        /* 1 - 2^-37: tie, odd → 올림, 자리 올림 */
+		{ SICF_ADD, 0x401FFFFFFFFFULL, 0x3DDC00000000ULL, 0x402800000000ULL, SICF_OK },        /* 2 - 2^-37: 올림, 자리 올림 */
+		{ SICF_MUL, 0x401800000001ULL, 0x401800000001ULL, 0x401800000002ULL, SICF_OK },        /* (1 + 2^-35)^2 */
+		{ SICF_DIV, 0x401800000000ULL, 0x400FFFFFFFFFULL, 0x401800000001ULL, SICF_OK },        /* 1 / (1 - 2^-36) */
+		{ SICF_MUL, 0x7FFFFFFFFFFFULL, 0x401800000000ULL, 0x7FFFFFFFFFFFULL, SICF_OK },        /* 가장 큰 수 × 1 */
+		{ SICF_ADD, 0x7FFFFFFFFFFFULL, 0x7DB800000000ULL, 0x7FFFFFFFFFFFULL, SICF_OVERFLOW },  /* 올림으로 overflow */
+		{ SICF_ADD, 0x7FFFFFFFFFFFULL, 0x7DB7FFFFFFFFULL, 0x7FFFFFFFFFFFULL, SICF_OK },        /* 중간값 아래 */
+		{ SICF_MUL, 0xFFFFFFFFFFFFULL, 0x402800000000ULL, 0xFFFFFFFFFFFFULL, SICF_OVERFLOW },
+		{ SICF_MUL, 0x000800000000ULL, 0x401800000000ULL, 0x000800000000ULL, SICF_OK },        /* 가장 작은 수 × 1 */
+		{ SICF_DIV, 0x000800000000ULL, 0x402800000000ULL, 0, SICF_UNDERFLOW },
+		{ SICF_ADD, 0x000000000001ULL, 0, 0, SICF_UNDERFLOW },                                 /* 정규화하면 범위 밖 */
+		{ SICF_ADD, 0x401400000000ULL, 0x401400000000ULL, 0x401800000000ULL, SICF_OK },        /* 0.5 + 0.5, 정규화 안 됨 */
+		{ SICF_MUL, 0x402000000001ULL, 0x401800000000ULL, 0x3DF800000000ULL, SICF_OK },        /* 2^-34 × 1 */
+		{ SICF_DIV, 0x401400000000ULL, 0x400400000000ULL, 0x402800000000ULL, SICF_OK },        /* 0.5 / 0.25 */
+		{ SICF_ADD, 0xFFF000000000ULL, 0x401800000000ULL, 0x401800000000ULL, SICF_OK },        /* fraction이 0이면 0 */
+	};
+	int known_cnt = sizeof(known) / sizeof(known[0]);
+	long long mismatch = 0;
+	long long i;
+	int value;
+
+	for (i = 0; i < known_cnt; i++) {
+		int fast;
+		for (fast = 0; fast <= 2; fast++) {
+			SicFloat f = known[i].f;
+			int status;
+			if (fast == 2)
+				status = referenceSicFloat(known[i].op, &f, known[i].m);
+			else
+				status = operateSicFloat(known[i].op, &f, known[i].m, fast);
+			if (f != known[i].expect || status != known[i].status) {
+				printf("known %lld (%s): got %012llX/%d, expected %012llX/%d\n", i,
+					fast == 2 ? "reference" : fast ? "fast" : "slow",
+					f, status, known[i].expect, known[i].status);
+				mismatch++;
+			}
+		}
+	}
+
+	for (value = -0x800000; value <= 0x7FFFFF; value += 0x1235) {
+		int a = 0;
+		if (fixSicFloat(floatSicFloat(value), &a) != SICF_OK || a != value) {
+			printf("float/fix %d: got %d\n", value, a);
+			mismatch++;
+		}
+	}
+
+	for (i = 0; i < VERIFY_FLOAT_CNT; i++) {
+		int kind = (int)(i % 5);
+		int op = (int)((i / 5) % 4);
+		SicFloat f, m, fast_f, slow_f, ref_f;
+		int fast_status, slow_status, ref_status;
+
+		switch (kind) {
+		case 0:
+			f = makeRandomFloat(64, SICF_EXP_MAX - 8, SICF_FRAC_BITS);
+			m = makeRandomFloat(SICF_EXP_BIAS - 300, SICF_EXP_BIAS + 300, SICF_FRAC_BITS);
+			break;
+		case 1:
+			f = makeRandomFloat(SICF_EXP_BIAS - 40, SICF_EXP_BIAS + 40, 1 + (int)(nextRandom() % 20));
+			m = makeRandomFloat(SICF_EXP_BIAS - 40, SICF_EXP_BIAS + 40, 1 + (int)(nextRandom() % 20));
+			break;
+		case 2:
+			f = makeRandomFloat(SICF_EXP_BIAS, SICF_EXP_BIAS + 1, SICF_FRAC_BITS);
+			m = makeRandomFloat(SICF_EXP_BIAS, SICF_EXP_BIAS + 1, SICF_FRAC_BITS - (int)(nextRandom() % 30));
+			break;
+		case 3:
+			f = makeRandomFloat(SICF_EXP_MAX - 1100, SICF_EXP_MAX, SICF_FRAC_BITS);
+			m = makeRandomFloat(0, 1100, SICF_FRAC_BITS);
+			if (nextRandom() & 1) {
+				SicFloat tmp = f;
+				f = m;
+				m = tmp;
+			}
+			break;
+		default:
+			f = makeRandomFloat(0, SICF_EXP_MAX, SICF_FRAC_BITS) >> (nextRandom() % 8);
+			m = makeRandomFloat(0, SICF_EXP_MAX, SICF_FRAC_BITS) >> (nextRandom() % 8);
+			break;
+		}
+
+		fast_f = slow_f = ref_f = f;
+		fast_status = operateSicFloat(op, &fast_f, m, true);
+		slow_status = operateSicFloat(op, &slow_f, m, false);
+		ref_status = referenceSicFloat(op, &ref_f, m);
+		if (fast_f != ref_f || fast_status != ref_status || slow_f != ref_f || slow_status != ref_status) {
+			if (mismatch < 20)
+				printf("op %d %012llX, %012llX: fast %012llX/%d, slow %012llX/%d, reference %012llX/%d\n",
+					op, f, m, fast_f, fast_status, slow_f, slow_status, ref_f, ref_status);
+			mismatch++;
+		}
+	}
+
+	printf("verify-float: %d known, %lld random, %lld mismatches\n", known_cnt, (long long)VERIFY_FLOAT_CNT, mismatch);
+	return mismatch != 0;
+}
+
+/*************************************************************************************
+* 설명: F ← F op m 을 검증용으로 계산한다. sicfloat.c의 정규화와 sticky bit를 쓰지
+*       않고, operand의 fraction을 정규화하지 않은 채 큰 정수로 옮겨서 정확한 값을
+*       구한 다음 한 번만 round 한다. 덧셈과 뺄셈은 작은 exponent에 맞추어 자리를
+*       옮긴 정수끼리 더하고, 곱셈은 fraction끼리 곱하고, 나눗셈은 fraction을
+*       REF_DIV_SHIFT bit 올려서 나눈 몫과 나머지를 사용한다.
+* 인자:
+* - op: SICF_ADD, SICF_SUB, SICF_MUL, SICF_DIV 중 하나
+* - f: F register
+* - m: 메모리에서 읽은 operand
+* 반환값: operateSicFloat과 같다.
+*************************************************************************************/
+static int referenceSicFloat(int op, SicFloat* f, SicFloat m)
+{
+	static RefNumber a, b, r;
+	unsigned long long fa = *f & REF_FRAC, fb = m & REF_FRAC;
+	int ea = (int)((*f >> SICF_FRAC_BITS) & SICF_EXP_MAX), eb = (int)((m >> SICF_FRAC_BITS) & SICF_EXP_MAX);
+	int sa = (int)((*f >> 47) & 1), sb = (int)((m >> 47) & 1);
+	int base, cmp, sticky;
+
+	switch (op) {
+	case SICF_ADD:
+	case SICF_SUB:
+		sb ^= op == SICF_SUB;
+		if (fa == 0 && fb == 0) {
+			*f = 0;
+			return SICF_OK;
+		}
+		if (fa == 0)
+			ea = eb;
+		if (fb == 0)
+			eb = ea;
+		base = ea < eb ? ea : eb;
+		setRefNumber(&a, fa, ea - base);
+		setRefNumber(&b, fb, eb - base);
+		if (sa == sb) {
+			addRefNumber(&a, &b);
+			return roundRefNumber(sa, &a, base - REF_EXP_SHIFT, 0, f);
+		}
+		cmp = compareRefNumber(&a, &b);
+		if (cmp == 0) {
+			*f = 0;
+			return SICF_OK;
+		}
+		if (cmp > 0) {
+			subRefNumber(&a, &b);
+			return roundRefNumber(sa, &a, base - REF_EXP_SHIFT, 0, f);
+		}
+		subRefNumber(&b, &a);
+		return roundRefNumber(sb, &b, base - REF_EXP_SHIFT, 0, f);
+
+	case SICF_MUL:
+		if (fa == 0 || fb == 0) {
+			*f = 0;
+			return SICF_OK;
+		}
+		setRefNumber(&a, fa, 0);
+		setRefNumber(&b, fb, 0);
+		mulRefNumber(&a, &b, &r);
+		return roundRefNumber(sa ^ sb, &r, ea + eb - 2 * REF_EXP_SHIFT, 0, f);
+
+	default:
+		if (fb == 0)
+			return SICF_DIVZERO;
+		if (fa == 0) {
+			*f = 0;
+			return SICF_OK;
+		}
+		setRefNumber(&a, fa, REF_DIV_SHIFT);
+		sticky = divRefNumber(&a, fb) != 0;
+		return roundRefNumber(sa ^ sb, &a, ea - eb - REF_DIV_SHIFT, sticky, f);
+	}
+}
+
+/*************************************************************************************
+* 설명: n × 2^exp를 fraction 36 bit로 round-to-nearest-even 하여 정규화된 수를 만든다.
+*       잘려나가는 bit 중 가장 위의 bit가 1이고 나머지 bit와 sticky가 모두 0이면
+*       정확히 중간값이다.
+* 인자:
+* - sign: 부호
+* - n: 0이 아닌 정수
+* - exp: 2의 지수
+* - sticky: n의 가장 아래 bit보다 작은 0이 아닌 값이 더 있는지 여부
+* - out: 결과를 저장할 곳
+* 반환값: SICF_OK, SICF_OVERFLOW, SICF_UNDERFLOW 중 하나
+*************************************************************************************/
+static int roundRefNumber(int sign, const RefNumber* n, int exp, int sticky, SicFloat* out)
+{
+	int len = getRefLength(n);
+	unsigned long long frac = 0;
+	int i, e;
+
+	for (i = 1; i <= SICF_FRAC_BITS; i++)
+		frac = (frac << 1) | (unsigned long long)(len - i >= 0 && getRefBit(n, len - i));
+
+	if (len > SICF_FRAC_BITS && getRefBit(n, len - SICF_FRAC_BITS - 1) &&
+		(sticky || hasRefBitsBelow(n, len - SICF_FRAC_BITS - 1) || (frac & 1))) {
+		if (++frac >> SICF_FRAC_BITS) {
+			frac >>= 1;
+			len++;
+		}
+	}
+
+	/* 값 = 0.frac × 2^(exp + len) */
+	e = exp + len + SICF_EXP_BIAS;
+	if (e > SICF_EXP_MAX) {
+		*out = (SicFloat)sign << 47 | (SicFloat)SICF_EXP_MAX << SICF_FRAC_BITS | REF_FRAC;
+		return SICF_OVERFLOW;
+	}
+	if (e < 0) {
+		*out = 0;
+		return SICF_UNDERFLOW;
+	}
+	*out = (SicFloat)sign << 47 | (SicFloat)e << SICF_FRAC_BITS | frac;
+	return SICF_OK;
+}
+
+/*************************************************************************************
+* 설명: n을 value × 2^shift로 정한다.
+* 인자:
+* - n: 정할 정수
+* - value: 값
+* - shift: 올릴 bit 수
+* 반환값: 없음
+*************************************************************************************/
+static void setRefNumber(RefNumber* n, unsigned long long value, int shift)
+{
+	int i;
+
+	n->cnt = (shift + 64) / REF_LIMB_BITS + 2;
+	memset(n->limb, 0, n->cnt * sizeof(n->limb[0]));
+	for (i = 0; i < 64; i++) {
+		if ((value >> i) & 1)
+			n->limb[(shift + i) / REF_LIMB_BITS] |= 1U << ((shift + i) % REF_LIMB_BITS);
+	}
+}
+
+/*************************************************************************************
+* 설명: 정수의 bit 길이를 구한다.
+* 인자:
+* - n: 정수
+* 반환값: 최상위 1 bit의 위치 + 1, 0이면 0
+*************************************************************************************/
+static int getRefLength(const RefNumber* n)
+{
+	int i, len;
+
+	for (i = n->cnt - 1; i >= 0; i--) {
+		if (n->limb[i] != 0) {
+			for (len = REF_LIMB_BITS; !((n->limb[i] >> (len - 1)) & 1); len--)
+				;
+			return i * REF_LIMB_BITS + len;
+		}
+	}
+	return 0;
+}
+
+/*************************************************************************************
+* 설명: 정수의 pos번째 bit를 구한다.
+* 인자:
+* - n: 정수
+* - pos: 0 이상의 bit 위치
+* 반환값: 0 또는 1
+*************************************************************************************/
+static int getRefBit(const RefNumber* n, int pos)
+{
+	if (pos / REF_LIMB_BITS >= n->cnt)
+		return 0;
+	return (int)((n->limb[pos / REF_LIMB_BITS] >> (pos % REF_LIMB_BITS)) & 1);
+}
+
+/*************************************************************************************
+* 설명: 정수의 pos번째 bit보다 아래에 1인 bit가 있는지 확인한다.
+* 인자:
+* - n: 정수
+* - pos: 0 이상의 bit 위치
+* 반환값: 있으면 1, 없으면 0
+*************************************************************************************/
+static int hasRefBitsBelow(const RefNumber* n, int pos)
+{
+	int i;
+
+	for (i = 0; i < pos / REF_LIMB_BITS; i++) {
+		if (n->limb[i] != 0)
+			return 1;
+	}
+	return (n->limb[pos / REF_LIMB_BITS] & ((1U << (pos % REF_LIMB_BITS)) - 1)) != 0;
+}
+
+/*************************************************************************************
+* 설명: 두 정수를 비교한다.
+* 인자:
+* - a, b: 비교할 정수
+* 반환값: a < b이면 음수, 같으면 0, a > b이면 양수
+*************************************************************************************/
+static int compareRefNumber(const RefNumber* a, const RefNumber* b)
+{
+	int i = a->cnt > b->cnt ? a->cnt : b->cnt;
+
+	while (--i >= 0) {
+		unsigned int x = i < a->cnt ? a->limb[i] : 0;
+		unsigned int y = i < b->cnt ? b->limb[i] : 0;
+		if (x != y)
+			return x > y ? 1 : -1;
+	}
+	return 0;
+}
+
+/*************************************************************************************
+* 설명: a ← a + b. a의 limb 수는 b보다 적으면 늘린다.
+* 인자:
+* - a: 더할 정수이자 결과를 저장할 곳
+* - b: 더할 정수
+* 반환값: 없음
+*************************************************************************************/
+static void addRefNumber(RefNumber* a, const RefNumber* b)
+{
+	unsigned int carry = 0;
+	int i;
+
+	while (a->cnt < b->cnt)
+		a->limb[a->cnt++] = 0;
+	for (i = 0; i < a->cnt; i++) {
+		carry += a->limb[i] + (i < b->cnt ? b->limb[i] : 0);
+		a->limb[i] = carry & ((1U << REF_LIMB_BITS) - 1);
+		carry >>= REF_LIMB_BITS;
+	}
+	if (carry)
+		a->limb[a->cnt++] = carry;
+}
+
+/*************************************************************************************
+* 설명: a ← a - b. a는 b보다 크거나 같아야 한다.
+* 인자:
+* - a: 빼질 정수이자 결과를 저장할 곳
+* - b: 뺄 정수
+* 반환값: 없음
+*************************************************************************************/
+static void subRefNumber(RefNumber* a, const RefNumber* b)
+{
+	int borrow = 0;
+	int i;
+
+	for (i = 0; i < a->cnt; i++) {
+		int x = (int)a->limb[i] - (i < b->cnt ? (int)b->limb[i] : 0) - borrow;
+		borrow = x < 0;
+		a->limb[i] = (unsigned int)(x + (borrow << REF_LIMB_BITS));
+	}
+}
+
+/*************************************************************************************
+* 설명: out ← a × b. 한 limb씩 곱해서 더한다.
+* 인자:
+* - a, b: 곱할 정수
+* - out: 결과를 저장할 곳
+* 반환값: 없음
+*************************************************************************************/
+static void mulRefNumber(const RefNumber* a, const RefNumber* b, RefNumber* out)
+{
+	int i, j;
+
+	out->cnt = a->cnt + b->cnt;
+	memset(out->limb, 0, out->cnt * sizeof(out->limb[0]));
+	for (i = 0; i < a->cnt; i++) {
+		unsigned long long carry = 0;
+		for (j = 0; j < b->cnt; j++) {
+			carry += (unsigned long long)a->limb[i] * b->limb[j] + out->limb[i + j];
+			out->limb[i + j] = (unsigned int)(carry & ((1U << REF_LIMB_BITS) - 1));
+			carry >>= REF_LIMB_BITS;
+		}
+		out->limb[i + b->cnt] = (unsigned int)carry;
+	}
+}
+
+/*************************************************************************************
+* 설명: n ← n / d. 위쪽 limb부터 나누어 내려간다(long division).
+* 인자:
+* - n: 나눌 정수이자 몫을 저장할 곳
+* - d: 0이 아니고 2^36보다 작은 수
+* 반환값: 나머지
+*************************************************************************************/
+static unsigned long long divRefNumber(RefNumber* n, unsigned long long d)
+{
+	unsigned long long rem = 0;
+	int i;
+
+	for (i = n->cnt - 1; i >= 0; i--) {
+		unsigned long long cur = (rem << REF_LIMB_BITS) | n->limb[i];
+		n->limb[i] = (unsigned int)(cur / d);
+		rem = cur % d;
+	}
+	return rem;
+}
+
+/*************************************************************************************
+* 설명: keys를 모두 hash table에 넣고 비우는 작업을 iterations번 반복한다.
+*       key와 value는 keys의 문자열을 그대로 사용하므로 entry만 해제한다.
+* 인자:
+* - keys: 넣을 key들
+* - iterations: 반복 횟수
+* 반환값: 없음
+*************************************************************************************/
+static void runHashInsert(char keys[][BENCH_KEY_LEN], long long iterations)
+{
+	HashTable hash;
+	long long i;
+	int j;
+
+	initializeHash(&hash, shell.machine.opcodes->current->table.hash_func, shell.machine.opcodes->current->table.cmp);
+	for (i = 0; i < iterations; i++) {
+		for (j = 0; j < BENCH_KEY_CNT; j++)
+			insertHash(&hash, keys[j], keys[j]);
+		foreachHash(&hash, NULL, releaseEntry);
+		clearHash(&hash);
+	}
+}
+
+/*************************************************************************************
+* 설명: hash table에서 keys를 차례로 찾는 작업을 iterations번 반복한다.
+* 인자:
+* - hash: 찾을 hash table
+* - keys: 찾을 key들
+* - cnt: key의 수
+* - iterations: 반복 횟수
+* 반환값: 없음
+*************************************************************************************/
+static void runHashGet(HashTable* hash, char** keys, int cnt, long long iterations)
+{
+	long long i;
+
+	for (i = 0; i < iterations; i++)
+		sink += getValue(hash, keys[i % cnt]) != NULL;
+}
+
+/*************************************************************************************
+* 설명: object file의 parser를 검사한다. 임의로 만든 object program마다
+*       - text → binary → text로 바꾼 결과가 처음 text를 다시 쓴 결과와 같은지,
+*         두 형식을 같은 주소에 load한 메모리의 내용이 같은지 확인하고
+*       - 잘렸거나 header, segment, relocation, symbol이 범위를 벗어난 binary file과
+*         잘못된 record가 들어간 text file을 모두 거절하는지 확인하고
+*       - 임의의 byte를 바꾼 file은 거절하거나, 읽은 내용이 모두 프로그램의 범위
+*         안에 있고 load할 수 있는지 확인한다. sanitizer로 빌드하면 메모리 오류도
+*         함께 찾을 수 있다.
+* 인자: 없음
+* 반환값: 모두 맞으면 0, 틀린 것이 있으면 1
+*************************************************************************************/
+static int verifyObjfile(void)
+{
+	static SicMachine machines[2];
+	long long corrupted = 0;
+	long long flipped = 0;
+	long long mismatch = 0;
+	int i, j, kind;
+
+	if (initializeSicMachine(&machines[0]) != SIC_OK || initializeSicMachine(&machines[1]) != SIC_OK) {
+		printf("verify-objfile: 메모리를 할당하지 못했습니다.\n");
+		return 1;
+	}
+
+	for (i = 0; i < VERIFY_OBJ_CNT; i++) {
+		ObjectFile objs[2];
+		char* text;
+		char* copy;
+		unsigned char* binary;
+		size_t text_len, copy_len, binary_len;
+		unsigned int progaddr;
+
+		/* text → binary → text */
+		writeRandomObject(VERIFY_OBJ_SOURCE);
+		if (!convertObject(VERIFY_OBJ_SOURCE, VERIFY_OBJ_TEXT, false) ||
+			!convertObject(VERIFY_OBJ_TEXT, VERIFY_OBJ_BINARY, true) ||
+			!convertObject(VERIFY_OBJ_BINARY, VERIFY_OBJ_COPY, false)) {
+			printf("object %d: 형식을 바꾸지 못했습니다.\n", i);
+			mismatch++;
+			continue;
+		}
+		text = readBenchFile(VERIFY_OBJ_TEXT, &text_len);
+		copy = readBenchFile(VERIFY_OBJ_COPY, &copy_len);
+		binary = (unsigned char*)readBenchFile(VERIFY_OBJ_BINARY, &binary_len);
+		if (text == NULL || copy == NULL || binary == NULL) {
+			printf("object %d: file을 읽지 못했습니다.\n", i);
+			mismatch++;
+			free(text);
+			free(copy);
+			free(binary);
+			continue;
+		}
+		if (text_len != copy_len || memcmp(text, copy, text_len)) {
+			printf("object %d: text → binary → text의 결과가 다릅니다.\n", i);
+			mismatch++;
+		}
+
+		/* 두 형식을 같은 주소에 load한 결과 */
+		initializeObject(&objs[0]);
+		initializeObject(&objs[1]);
+		if (openObjectFile(&objs[0], VERIFY_OBJ_TEXT) && openObjectFile(&objs[1], VERIFY_OBJ_BINARY) &&
+			objs[0].length == objs[1].length) {
+			progaddr = (unsigned int)(nextRandom() % (MEM_SIZE - objs[0].length + 1));
+			for (j = 0; j < 2; j++) {
+				fillSicMemory(&machines[j], progaddr, objs[j].length, 0xA5);
+				if (!loadObject(&objs[j], &machines[j], progaddr))
+					mismatch++;
+			}
+			if (memcmp(getSicDirect(&machines[0], progaddr, objs[0].length),
+				getSicDirect(&machines[1], progaddr, objs[1].length), objs[0].length)) {
+				printf("object %d: 두 형식을 %05X번지에 load한 내용이 다릅니다.\n", i, progaddr);
+				mismatch++;
+			}
+		}
+		else {
+			printf("object %d: 바꾼 file을 읽지 못했습니다.\n", i);
+			mismatch++;
+		}
+		releaseObject(&objs[0]);
+		releaseObject(&objs[1]);
+
+		/* 정해진 방법으로 망가뜨린 file은 모두 거절해야 한다 */
+		for (kind = 0; kind < VERIFY_BINARY_KINDS; kind++) {
+			unsigned char* bad = (unsigned char*)malloc(binary_len);
+			size_t len = binary_len;
+
+			if (bad == NULL)
+				break;
+			memcpy(bad, binary, binary_len);
+			if (corruptBinary(bad, &len, kind)) {
+				corrupted++;
+				if (!isObjectRejected((char*)bad, len)) {
+					printf("object %d: 망가뜨린 binary file(%d)을 거절하지 않았습니다.\n", i, kind);
+					mismatch++;
+				}
+			}
+			free(bad);
+		}
+		for (kind = 0; kind < VERIFY_TEXT_KINDS; kind++) {
+			char* bad = corruptText(text, kind);
+
+			if (bad == NULL)
+				break;
+			corrupted++;
+			if (!isObjectRejected(bad, strlen(bad))) {
+				printf("object %d: 망가뜨린 text file(%d)을 거절하지 않았습니다.\n", i, kind);
+				mismatch++;
+			}
+			free(bad);
+		}
+
+		/* 임의의 byte를 바꾼 file */
+		for (j = 0; j < VERIFY_OBJ_FLIPS; j++) {
+			int is_binary = j % 2 == 0;
+			char* bad = (char*)malloc(is_binary ? binary_len : text_len);
+
+			if (bad == NULL)
+				break;
+			if (is_binary)
+				memcpy(bad, binary, binary_len);
+			else
+				memcpy(bad, text, text_len);
+			flipBytes(bad, is_binary ? binary_len : text_len, is_binary);
+			flipped++;
+			if (!checkCorruptObject(bad, is_binary ? binary_len : text_len, &machines[0])) {
+				printf("object %d: 바꾼 %s file을 읽은 내용이 프로그램의 범위를 벗어납니다.\n",
+					i, is_binary ? "binary" : "text");
+				mismatch++;
+			}
+			free(bad);
+		}
+
+		free(text);
+		free(copy);
+		free(binary);
+	}
+
+	remove(VERIFY_OBJ_SOURCE);
+	remove(VERIFY_OBJ_TEXT);
+	remove(VERIFY_OBJ_BINARY);
+	remove(VERIFY_OBJ_COPY);
+	remove(VERIFY_OBJ_BAD);
+	releaseSicMachine(&machines[0]);
+	releaseSicMachine(&machines[1]);
+
+	printf("verify-objfile: %d objects, %lld corrupted, %lld flipped, %lld mismatches\n",
+		VERIFY_OBJ_CNT, corrupted, flipped, mismatch);
+	return mismatch != 0;
+}
+
+/*************************************************************************************
+* 설명: 임의의 object program을 text 형식으로 쓴다. T record는 길이가 제각각이고
+*       중간에 빈 구간이 있으며, D record의 주소는 프로그램의 끝을 포함하고,
+*       M record는 정렬되어 있지 않다.
+* 인자:
+* - path: 쓸 file
+* 반환값: 없음
+*************************************************************************************/
+static void writeRandomObject(const char* path)
+{
+	FILE* fp = fopen(path, "w");
+	unsigned int length = 3 + (unsigned int)(nextRandom() % (VERIFY_OBJ_LENGTH - 3));
+	unsigned int start = (unsigned int)(nextRandom() % (MEM_SIZE - length + 1));
+	unsigned int addr;
+	char name[OBJ_NAME_LEN + 1];
+	int name_len = 1 + (int)(nextRandom() % OBJ_NAME_LEN);
+	int cnt, i;
+
+	if (fp == NULL)
+		return;
+
+	for (i = 0; i < name_len; i++)
+		name[i] = (char)('A' + nextRandom() % 26);
+	name[name_len] = 0;
+	fprintf(fp, "H%-6s%06X%06X\n", name, start, length);
+
+	cnt = (int)(nextRandom() % 16);
+	for (i = 0; i < cnt; i++) {
+		addr = start + (unsigned int)(nextRandom() % (length + 1));
+		fprintf(fp, "%sS%05X%06X", i % 4 == 0 ? "D" : "", (unsigned int)(nextRandom() & 0xFFFFF), addr);
+		if (i % 4 == 3 || i == cnt - 1)
+			fputc('\n', fp);
+	}
+
+	for (addr = 0; addr < length; ) {
+		unsigned int size = 1 + (unsigned int)(nextRandom() % OBJ_RECORD_MAX);
+
+		if (nextRandom() % 32 == 0) {
+			addr += (unsigned int)(nextRandom() % 64);
+			continue;
+		}
+		if (size > length - addr)
+			size = length - addr;
+		fprintf(fp, "T%06X%02X", start + addr, size);
+		for (i = 0; i < (int)size; i++)
+			fprintf(fp, "%02X", (unsigned int)(nextRandom() & 0xFF));
+		fputc('\n', fp);
+		addr += size;
+	}
+
+	cnt = (int)(nextRandom() % 24);
+	for (i = 0; i < cnt; i++) {
+		addr = start + (unsigned int)(nextRandom() % (length - 2));
+		if (nextRandom() % 2)
+			fprintf(fp, "M%06X%02X+%s\n", addr, nextRandom() % 2 ? 5 : 6, name);
+		else
+			fprintf(fp, "M%06X%02X\n", addr, nextRandom() % 2 ? 5 : 6);
+	}
+
+	fprintf(fp, "E%06X\n", start + (unsigned int)(nextRandom() % length));
+	fclose(fp);
+}
+
+/*************************************************************************************
+* 설명: object file을 읽어서 다른 형식으로 쓴다. (objconv와 같다)
+* 인자:
+* - src: 읽을 file
+* - dst: 쓸 file
+* - binary: binary 형식으로 쓸지 여부
+* 반환값: 성공하면 true, 실패하면 false
+*************************************************************************************/
+static int convertObject(const char* src, const char* dst, int binary)
+{
+	ObjectFile obj;
+	FILE* fp;
+	int success;
+
+	initializeObject(&obj);
+	if (!openObjectFile(&obj, src)) {
+		releaseObject(&obj);
+		return false;
+	}
+	fp = fopen(dst, binary ? "wb" : "w");
+	success = fp != NULL && (binary ? writeObjectBinary(&obj, fp) : writeObjectText(&obj, fp));
+	if (fp != NULL && fclose(fp) != 0)
+		success = false;
+	releaseObject(&obj);
+	return success;
+}
+
+/*************************************************************************************
+* 설명: file 전체를 읽는다. 끝에 0을 붙여서 text file은 문자열로 쓸 수 있다.
+* 인자:
+* - path: 읽을 file
+* - len: 읽은 byte 수를 저장할 곳
+* 반환값: 할당한 buffer. 실패하면 NULL
+*************************************************************************************/
+static char* readBenchFile(const char* path, size_t* len)
+{
+	FILE* fp = fopen(path, "rb");
+	char* data;
+	long size;
+
+	if (fp == NULL)
+		return NULL;
+	if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0 || fseek(fp, 0, SEEK_SET) != 0 ||
+		(data = (char*)malloc((size_t)size + 1)) == NULL) {
+		fclose(fp);
+		return NULL;
+	}
+	*len = fread(data, 1, (size_t)size, fp);
+	data[*len] = 0;
+	fclose(fp);
+	return data;
+}
+
+/*************************************************************************************
+* 설명: data를 VERIFY_OBJ_BAD에 쓰고 object file로 읽어본다.
+* 인자:
+* - data, len: file의 내용
+* - obj: 읽은 결과를 저장할 곳. 성공하면 releaseObject로 해제해야 한다.
+* 반환값: 읽으면 true, 거절하면 false
+*************************************************************************************/
+static int openBenchObject(const char* data, size_t len, ObjectFile* obj)
+{
+	FILE* fp = fopen(VERIFY_OBJ_BAD, "wb");
+
+	initializeObject(obj);
+	if (fp == NULL)
+		return false;
+	fwrite(data, 1, len, fp);
+	fclose(fp);
+	if (!openObjectFile(obj, VERIFY_OBJ_BAD)) {
+		releaseObject(obj);
+		return false;
+	}
+	return true;
+}
+
+/*************************************************************************************
+* 설명: data로 된 object file을 거절하는지 확인한다.
+* 인자:
+* - data, len: file의 내용
+* 반환값: 거절하면 true
+*************************************************************************************/
+static int isObjectRejected(const char* data, size_t len)
+{
+	ObjectFile obj;
+
+	if (!openBenchObject(data, len, &obj))
+		return true;
+	releaseObject(&obj);
+	return false;
+}
+
+/*************************************************************************************
+* 설명: 바뀐 object file을 읽어본다. 읽었다면 segment, relocation, symbol이 모두
+*       프로그램의 범위 안에 있어야 하고, 임의의 주소에 load할 수 있어야 한다.
+* 인자:
+* - data, len: file의 내용
+* - machine: load할 machine
+* 반환값: 거절하거나 읽은 내용이 맞으면 true, 아니면 false
+*************************************************************************************/
+static int checkCorruptObject(const char* data, size_t len, SicMachine* machine)
+{
+	ObjectFile obj;
+	unsigned int end = 0;
+	int valid;
+	int i;
+
+	if (!openBenchObject(data, len, &obj))
+		return true;
+
+	valid = obj.start <= MEM_SIZE && obj.length <= MEM_SIZE - obj.start;
+	for (i = 0; i < obj.seg_cnt && valid; i++) {
+		valid = obj.segs[i].addr >= obj.start &&
+			obj.segs[i].addr - obj.start <= obj.length &&
+			obj.segs[i].size <= obj.length - (obj.segs[i].addr - obj.start);
+	}
+	for (i = 0; i < obj.reloc_cnt && valid; i++) {
+		unsigned int offset = OBJ_RELOC_OFFSET(obj.relocs[i]);
+
+		valid = (OBJ_RELOC_HALF(obj.relocs[i]) == 5 || OBJ_RELOC_HALF(obj.relocs[i]) == 6) &&
+			offset >= end && obj.length >= 3 && offset <= obj.length - 3;
+		end = offset;
+	}
+	for (i = 0; i < obj.sym_cnt && valid; i++)
+		valid = obj.syms[i].addr >= obj.start && obj.syms[i].addr - obj.start <= obj.length;
+
+	if (valid)
+		valid = loadObject(&obj, machine, (unsigned int)(nextRandom() % (MEM_SIZE - obj.length + 1)));
+	releaseObject(&obj);
+	return valid;
+}
+
+/*************************************************************************************
+* 설명: binary 형식의 object file을 kind에 따라 한 군데 망가뜨린다.
+*       0~4는 header, table, segment의 내용 중간에서 file을 자르고, 5~9는 header,
+*       10~12는 첫 segment, 13~15는 relocation, 16~17은 symbol을 범위 밖으로 바꾼다.
+* 인자:
+* - data: file의 내용
+* - len: file의 길이. 자르면 바뀐다.
+* - kind: 망가뜨릴 방법
+* 반환값: 망가뜨렸으면 true, 해당하는 table이 비어있으면 false
+*************************************************************************************/
+static int corruptBinary(unsigned char* data, size_t* len, int kind)
+{
+	unsigned int start = getBenchWord(data + 16);
+	unsigned int length = getBenchWord(data + 20);
+	unsigned int seg_cnt = getBenchWord(data + 28);
+	unsigned int reloc_cnt = getBenchWord(data + 32);
+	unsigned int sym_cnt = getBenchWord(data + 36);
+	unsigned int reloc_offset = getBenchWord(data + 40);
+	unsigned int sym_offset = getBenchWord(data + 44);
+	unsigned char* seg = data + OBJ_HEADER_SIZE;
+	unsigned char* reloc = data + reloc_offset;
+	unsigned char* sym = data + sym_offset;
+	unsigned int value;
+
+	if ((kind == 1 || kind == 4 || (kind >= 10 && kind <= 12)) && seg_cnt == 0)
+		return false;
+	if ((kind == 2 || (kind >= 13 && kind <= 15)) && reloc_cnt == 0)
+		return false;
+	if ((kind == 3 || kind == 9 || kind >= 16) && sym_cnt == 0)
+		return false;
+
+	switch (kind) {
+	case 0:
+		*len = OBJ_HEADER_SIZE - 1;
+		break;
+	case 1:
+		*len = OBJ_HEADER_SIZE + seg_cnt * OBJ_SEGMENT_SIZE - 1;
+		break;
+	case 2:
+		*len = reloc_offset + reloc_cnt * OBJ_RELOC_SIZE - 1;
+		break;
+	case 3:
+		*len = sym_offset + sym_cnt * OBJ_SYMBOL_SIZE - 1;
+		break;
+	case 4:
+		*len -= 1;
+		break;
+	case 5:
+		putBenchWord(data + 16, MEM_SIZE + 1);
+		break;
+	case 6:
+		putBenchWord(data + 20, MEM_SIZE - start + 1);
+		break;
+	case 7:
+		putBenchWord(data + 28, 0xFFFFFFFF);
+		break;
+	case 8:
+		putBenchWord(data + 32, MEM_SIZE);
+		break;
+	case 9:
+		putBenchWord(data + 44, (unsigned int)*len);
+		break;
+	case 10:
+		putBenchWord(seg, start - 1);
+		break;
+	case 11:
+		putBenchWord(seg + 4, length - (getBenchWord(seg) - start) + 1);
+		break;
+	case 12:
+		putBenchWord(seg + 8, (unsigned int)*len);
+		break;
+	case 13:
+		putBenchWord(reloc, OBJ_RELOC(OBJ_RELOC_OFFSET(getBenchWord(reloc)), 4));
+		break;
+	case 14:
+		reloc += (reloc_cnt - 1) * OBJ_RELOC_SIZE;
+		putBenchWord(reloc, OBJ_RELOC(length - 2, OBJ_RELOC_HALF(getBenchWord(reloc))));
+		break;
+	case 15:
+		/* 뒤의 entry가 앞의 것보다 작아지도록 바꾼다 */
+		if (reloc_cnt < 2 || OBJ_RELOC_OFFSET(getBenchWord(reloc + OBJ_RELOC_SIZE)) == 0)
+			return false;
+		value = getBenchWord(reloc + OBJ_RELOC_SIZE);
+		putBenchWord(reloc, OBJ_RELOC(OBJ_RELOC_OFFSET(value), 5));
+		putBenchWord(reloc + OBJ_RELOC_SIZE, OBJ_RELOC(OBJ_RELOC_OFFSET(value) - 1, 5));
+		break;
+	case 16:
+		putBenchWord(sym + 8, start + length + 1);
+		break;
+	default:
+		putBenchWord(sym + 8, start - 1);
+		break;
+	}
+	return true;
+}
+
+/*************************************************************************************
+* 설명: writeObjectText로 쓴 text file의 H record 뒤에 kind에 따라 잘못된 record를
+*       하나 넣거나 H record를 바꾼다.
+* 인자:
+* - text: file의 내용
+* - kind: 망가뜨릴 방법
+* 반환값: 할당한 새 내용. 실패하면 NULL
+*************************************************************************************/
+static char* corruptText(const char* text, int kind)
+{
+	const char* body = strchr(text, '\n');
+	char header[OBJ_LINE_MAX];
+	char record[OBJ_LINE_MAX];
+	char* result;
+	unsigned int start, length;
+	size_t header_len;
+
+	if (body == NULL || sscanf(text + 7, "%6X%6X", &start, &length) != 2)
+		return NULL;
+	body++;
+	header_len = (size_t)(body - text);
+	if (header_len >= OBJ_LINE_MAX)
+		return NULL;
+	memcpy(header, text, header_len);
+	header[header_len] = 0;
+	record[0] = 0;
+
+	switch (kind) {
+	case 0:
+		/* 길이가 없는 H record */
+		strcpy(header + 13, "\n");
+		break;
+	case 1:
+		sprintf(header + 13, "%06X\n", MEM_SIZE - start + 1);
+		break;
+	case 2:
+		sprintf(record, "T%06X01FF\n", start + length);
+		break;
+	case 3:
+		sprintf(record, "T%06X02FF\n", start);
+		break;
+	case 4:
+		/* H record 앞의 T record */
+		sprintf(header, "T%06X01FF\n", start);
+		memcpy(header + strlen(header), text, header_len);
+		header[11 + header_len] = 0;
+		break;
+	case 5:
+		sprintf(record, "M%06X05\n", start + length - 2);
+		break;
+	case 6:
+		sprintf(record, "M%06X04\n", start);
+		break;
+	case 7:
+		sprintf(record, "M%06X05+OTHER\n", start);
+		break;
+	case 8:
+		sprintf(record, "DOUTSID%06X\n", start + length + 1);
+		break;
+	case 9:
+		sprintf(record, "DSHORT %05X\n", start);
+		break;
+	default:
+		strcpy(record, "X000000\n");
+		break;
+	}
+
+	result = (char*)malloc(strlen(header) + strlen(record) + strlen(body) + 1);
+	if (result != NULL)
+		sprintf(result, "%s%s%s", header, record, body);
+	return result;
+}
+
+/*************************************************************************************
+* 설명: object file의 byte를 1~4개 바꾼다. binary 형식은 주로 header와 table을
+*       임의의 값으로 바꾸고, text 형식은 record에 쓰이는 문자로 바꾼다.
+* 인자:
+* - data, len: file의 내용
+* - binary: binary 형식인지 여부
+* 반환값: 없음
+*************************************************************************************/
+static void flipBytes(char* data, size_t len, int binary)
+{
+	static const char text_chars[] = "0123456789ABCDEF+HDTME \n";
+	size_t table_end = len;
+	int cnt = 1 + (int)(nextRandom() % 4);
+	int i;
+
+	if (binary) {
+		table_end = getBenchWord((unsigned char*)data + 44) +
+			getBenchWord((unsigned char*)data + 36) * OBJ_SYMBOL_SIZE;
+		if (table_end < OBJ_HEADER_SIZE || table_end > len)
+			table_end = len;
+	}
+
+	for (i = 0; i < cnt; i++) {
+		size_t limit = nextRandom() % 4 ? table_end : len;
+		size_t pos = (size_t)(nextRandom() % limit);
+
+		if (binary)
+			data[pos] = (char)nextRandom();
+		else
+			data[pos] = text_chars[nextRandom() % (sizeof(text_chars) - 1)];
+	}
+}
+
+/*************************************************************************************
+* 설명: little endian으로 저장된 4 byte를 읽고 쓴다. (binary object 형식)
+*************************************************************************************/
+static unsigned int getBenchWord(const unsigned char* src)
+{
+	return (unsigned int)src[0] | ((unsigned int)src[1] << 8) |
+		((unsigned int)src[2] << 16) | ((unsigned int)src[3] << 24);
+}
+
+static void putBenchWord(unsigned char* dst, unsigned int value)
+{
+	dst[0] = (unsigned char)value;
+	dst[1] = (unsigned char)(value >> 8);
+	dst[2] = (unsigned char)(value >> 16);
+	dst[3] = (unsigned char)(value >> 24);
+}
+
+/*************************************************************************************
+* 설명: 명령 함수를 직접 호출하기 위해 shell의 인자를 설정한다.
+* 인자:
+* - argc: 인자의 수
+* - a0, a1, a2: 인자 문자열. 사용하지 않는 인자는 NULL
+* 반환값: 없음
+*************************************************************************************/
+static void setArgs(int argc, const char* a0, const char* a1, const char* a2)
+{
+	shell.argc = argc;
+	shell.error = ERR_NONE;
+	strcpy(shell.args[0], a0 != NULL ? a0 : "");
+	strcpy(shell.args[1], a1 != NULL ? a1 : "");
+	strcpy(shell.args[2], a2 != NULL ? a2 : "");
+}
+
+/*************************************************************************************
+* 설명: 16 byte마다 relocation할 format 4 명령어가 있는 BENCH_OBJ_SIZE 크기의
+*       object program을 text 형식으로 쓰고, objconv로 binary 형식도 만든다.
+* 인자: 없음
+* 반환값: 없음
+*************************************************************************************/
+static void makeObject(void)
+{
+	FILE* fp = fopen(BENCH_OBJ_TEXT, "w");
+	unsigned int addr;
+	int i;
+
+	fprintf(fp, "HBENCH 000000%06X\n", BENCH_OBJ_SIZE);
+	for (addr = 0; addr < BENCH_OBJ_SIZE; addr += 0x1E) {
+		int len = BENCH_OBJ_SIZE - addr < 0x1E ? BENCH_OBJ_SIZE - addr : 0x1E;
+
+		fprintf(fp, "T%06X%02X", addr, len);
+		for (i = 0; i < len; i++)
+			fprintf(fp, "%02X", (addr + i) % 16 == 0 ? 0x4B : (addr + i) % 16 == 1 ? 0x10 : (addr + i) & 0xFF);
+		fputc('\n', fp);
+	}
+	for (addr = 0; addr < BENCH_OBJ_SIZE; addr += 16)
+		fprintf(fp, "M%06X05+BENCH\n", addr + 1);
+	fprintf(fp, "E000000\n");
+	fclose(fp);
+
+	setArgs(2, BENCH_OBJ_TEXT, BENCH_OBJ_BINARY, NULL);
+	runCmdObjconv(&shell);
+}
+
+/*************************************************************************************
+* 설명: makeObject로 만든 파일들을 지운다.
+* 인자: 없음
+* 반환값: 없음
+*************************************************************************************/
+static void removeObject(void)
+{
+	remove(BENCH_OBJ_TEXT);
+	remove(BENCH_OBJ_BINARY);
+}
+
+static void collectOpcode(void* data, void* aux)
+{
+	Entry* entry = (Entry*)data;
+
+	/* opreload가 table을 바꾸더라도 쓸 수 있도록 복사해둔다 */
+	if (opcode_cnt < BENCH_KEY_CNT) {
+		strncpy(opcode_names[opcode_cnt], (char*)entry->key, BENCH_KEY_LEN - 1);
+		opcode_keys[opcode_cnt] = opcode_names[opcode_cnt];
+		opcode_cnt++;
+	}
+}
+
+static void releaseEntry(void* data, void* aux)
+{
+	Entry* entry = (Entry*)data;
+	if (entry->key != (void*)entry->value) {
+		free(entry->key);
+		free(entry->value);
+	}
+	free(entry);
+}
@@ -0,0 +1,199 @@
+﻿#include "device.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define open _open
+#define close _close
+#define read _read
+#define write _write
+#define lseek _lseek
+#else
+#include <unistd.h>
+#define O_BINARY 0
+#endif
+
+#ifdef _MSC_VER
+#define strdup _strdup
+#endif
+
+/*************************************************************************************
+* 설명: host의 파일을 그대로 메모리에 연결하는 장치. 장치의 offset은 파일의 offset과
+*       같고, 파일의 끝을 넘어서 읽으면 0을 읽는다.
+* device: 장치의 공통 부분
+* fd: 연결한 파일
+* path: 파일의 경로. 장치의 이름으로 쓴다.
+*************************************************************************************/
+typedef struct {
+	SicDevice device;
+	int fd;
+	char* path;
+} FileDevice;
+
+/*************************************************************************************
+* 설명: 쓴 byte를 shell의 출력으로 내보내는 장치. 읽으면 항상 0을 읽는다.
+* device: 장치의 공통 부분
+* out: 쓴 내용을 내보낼 출력 버퍼
+*************************************************************************************/
+typedef struct {
+	SicDevice device;
+	Output* out;
+} ConsoleDevice;
+
+static void readFile(SicDevice* device, unsigned int offset, unsigned char* dst, unsigned int len);
+static void writeFile(SicDevice* device, unsigned int offset, const unsigned char* src, unsigned int len);
+static void releaseFile(SicDevice* device);
+static void readConsole(SicDevice* device, unsigned int offset, unsigned char* dst, unsigned int len);
+static void writeConsole(SicDevice* device, unsigned int offset, const unsigned char* src, unsigned int len);
+static void releaseConsole(SicDevice* device);
+
+/*************************************************************************************
+* 설명: host의 파일을 읽고 쓰는 장치를 만든다. 파일이 없으면 만든다.
+* 인자:
+* - path: 연결할 파일의 경로
+* 반환값: 만든 장치. 파일을 열 수 없거나 메모리가 모자라면 NULL
+*************************************************************************************/
+SicDevice* createFileDevice(const char* path)
+{
+	FileDevice* file = (FileDevice*)calloc(1, sizeof(FileDevice));
+
+	if (file == NULL)
+		return NULL;
+
+	file->path = strdup(path);
+	file->fd = open(path, O_RDWR | O_CREAT | O_BINARY, 0644);
+	if (file->path == NULL || file->fd < 0) {
+		if (file->fd >= 0)
+			close(file->fd);
+		free(file->path);
+		free(file);
+		return NULL;
+	}
+
+	file->device.name = file->path;
+	file->device.read = readFile;
+	file->device.write = writeFile;
+	file->device.release = releaseFile;
+	return &file->device;
+}
+
+/*************************************************************************************
+* 설명: 쓴 내용을 out으로 내보내는 console 장치를 만든다.
+* 인자:
+* - out: 출력 버퍼. 장치를 해제할 때까지 유효해야 한다.
+* 반환값: 만든 장치. 메모리가 모자라면 NULL
+*************************************************************************************/
+SicDevice* createConsoleDevice(Output* out)
+{
+	ConsoleDevice* console = (ConsoleDevice*)calloc(1, sizeof(ConsoleDevice));
+
+	if (console == NULL)
+		return NULL;
+
+	console->out = out;
+	console->device.name = "console";
+	console->device.read = readConsole;
+	console->device.write = writeConsole;
+	console->device.release = releaseConsole;
+	return &console->device;
+}
+
+/*************************************************************************************
+* 설명: 파일의 offset부터 len byte를 읽는다. 파일의 끝을 넘는 부분은 0으로 채운다.
+* 인자:
+* - device: FileDevice
+* - offset, dst, len: SicDevice의 read와 같다.
+* 반환값: 없음
+*************************************************************************************/
+static void readFile(SicDevice* device, unsigned int offset, unsigned char* dst, unsigned int len)
+{
+	FileDevice* file = (FileDevice*)device;
+	unsigned int done = 0;
+
+	if (lseek(file->fd, (long)offset, SEEK_SET) >= 0) {
+		while (done < len) {
+			int cnt = (int)read(file->fd, dst + done, len - done);
+			if (cnt <= 0)
+				break;
+			done += cnt;
+		}
+	}
+	memset(dst + done, 0, len - done);
+}
+
+/*************************************************************************************
+* 설명: 파일의 offset부터 len byte를 쓴다. 쓰지 못한 부분은 버린다.
+* 인자:
+* - device: FileDevice
+* - offset, src, len: SicDevice의 write와 같다.
+* 반환값: 없음
+*************************************************************************************/
+static void writeFile(SicDevice* device, unsigned int offset, const unsigned char* src, unsigned int len)
+{
+	FileDevice* file = (FileDevice*)device;
+	unsigned int done = 0;
+
+	if (lseek(file->fd, (long)offset, SEEK_SET) < 0)
+		return;
+
+	while (done < len) {
+		int cnt = (int)write(file->fd, src + done, len - done);
+		if (cnt <= 0)
+			break;
+		done += cnt;
+	}
+}
+
+/*************************************************************************************
+* 설명: 파일을 닫고 장치를 해제한다.
+* 인자:
+* - device: FileDevice
+* 반환값: 없음
+*************************************************************************************/
+static void releaseFile(SicDevice* device)
+{
+	FileDevice* file = (FileDevice*)device;
+
+	close(file->fd);
+	free(file->path);
+	free(file);
+}
+
+/*************************************************************************************
+* 설명: console은 입력이 없으므로 항상 0을 읽는다.
+* 인자:
+* - device: ConsoleDevice
+* - offset, dst, len: SicDevice의 read와 같다.
+* 반환값: 없음
+*************************************************************************************/
+static void readConsole(SicDevice* device, unsigned int offset, unsigned char* dst, unsigned int len)
+{
+	memset(dst, 0, len);
+}
+
+/*************************************************************************************
+* 설명: 쓴 byte를 주소와 상관없이 그대로 출력 버퍼에 덧붙인다.
+* 인자:
+* - device: ConsoleDevice
+* - offset, src, len: SicDevice의 write와 같다.
+* 반환값: 없음
+*************************************************************************************/
+static void writeConsole(SicDevice* device, unsigned int offset, const unsigned char* src, unsigned int len)
+{
+	ConsoleDevice* console = (ConsoleDevice*)device;
+
+	appendOutput(console->out, (const char*)src, len);
+}
+
+/*************************************************************************************
+* 설명: console 장치를 해제한다. 출력 버퍼는 shell의 것이므로 그대로 둔다.
+* 인자:
+* - device: ConsoleDevice
+* 반환값: 없음
+*************************************************************************************/
+static void releaseConsole(SicDevice* device)
+{
+	free(device);
+}
@@ -0,0 +1,11 @@
+﻿#ifndef DEVICE_H_
+#define DEVICE_H_
+
+#include "sicsim.h"
+#include "output.h"
+
+/* 장치 관련 함수 */
+extern SicDevice* createFileDevice(const char* path);
+extern SicDevice* createConsoleDevice(Output* out);
+
+#endif
@@ -0,0 +1,265 @@
+﻿#include "disasm.h"
+#include <string.h>
+
+static const char* reg_names[16] = {
+	"A", "X", "L", "B", "S", "T", "F", "?", "PC", "SW", "?", "?", "?", "?", "?", "?"
+};
+static const char hex_digits[] = "0123456789ABCDEF";
+
+static void addDecodeEntry(void* data, void* aux);
+static char* putHex(char* dst, unsigned int value, int digits);
+static char* putString(char* dst, const char* str);
+static char* padField(char* dst, const char* field, int width);
+
+/*************************************************************************************
+* 설명: opcode table로부터 명령어의 첫 바이트를 index로 하는 decode table을 만든다.
+*       format 3/4 명령어는 첫 바이트의 하위 2 bit가 n, i flag이므로 4개의 칸에
+*       모두 같은 opcode를 넣는다. 해당하는 opcode가 없는 칸은 NULL이다.
+* 인자:
+* - op_table: mnemonic을 key로, Opcode를 value로 갖는 hash table
+* - decode: 결과를 저장할 DECODE_SIZE 크기의 배열
+* 반환값: 없음
+*************************************************************************************/
+void buildDecodeTable(HashTable* op_table, Opcode* decode[DECODE_SIZE])
+{
+	memset(decode, 0, sizeof(Opcode*) * DECODE_SIZE);
+	foreachHash(op_table, decode, addDecodeEntry);
+}
+
+/*************************************************************************************
+* 설명: mem의 addr번지에 있는 명령어 하나를 해석하여 dst에 한 줄로 쓴다.
+*       한 줄은 "주소  object code  mnemonic  operand" 형식이며 줄바꿈으로 끝난다.
+*       format 3/4의 operand 자리에는 flag로 계산한 target address를 보여주고,
+*       immediate는 '#', indirect는 '@', index는 ",X"를 붙인다. base relative는
+*       B register 값을 알 수 없으므로 "B+disp"로 보여준다. opcode를 찾을 수 없거나
+*       명령어가 메모리 끝을 넘으면 한 바이트를 BYTE로 보여준다.
+* 인자:
+* - dst: 한 줄을 쓸 버퍼. DISASM_LINE_MAX 이상의 공간이 있어야 한다.
+* - len: dst에 쓴 문자의 수를 저장할 변수에 대한 포인터
+* - target: operand가 가리키는 주소를 저장할 변수에 대한 포인터. 주소를 가리키지
+*           않거나(format 1/2, immediate 상수) 알 수 없으면(base relative)
+*           DISASM_NO_TARGET을 저장한다.
+* - mem: base번지부터의 메모리
+* - base: mem[0]의 주소
+* - addr: 해석할 명령어의 주소
+* - size: mem으로 읽을 수 있는 마지막 주소 + 1
+* - decode: buildDecodeTable로 만든 decode table
+* 반환값: 해석한 명령어의 길이 (byte)
+*************************************************************************************/
+int disassemble(char* dst, int* len, unsigned int* target_addr, const unsigned char* mem, unsigned int base,
+	unsigned int addr, unsigned int size, Opcode* const decode[DECODE_SIZE])
+{
+	const unsigned char* code = mem + (addr - base);
+	char field[DISASM_LINE_MAX];
+	char* ptr = dst;
+	char* opnd = field;
+	const Opcode* op = decode[code[0]];
+	int length = 1;
+	int extended = false;
+	int i;
+
+	*target_addr = DISASM_NO_TARGET;
+
+	/* 명령어의 길이 결정 */
+	if (op != NULL) {
+		if (op->format == OP_FORMAT_2)
+			length = 2;
+		else if (op->format == OP_FORMAT_34) {
+			length = 3;
+			if ((code[0] & 0x03) != 0 && addr + 1 < size && (code[1] & 0x10)) {
+				length = 4;
+				extended = true;
+			}
+		}
+	}
+	if (addr + length > size) {
+		op = NULL;
+		length = 1;
+		extended = false;
+	}
+
+	/* 주소와 object code */
+	ptr = putHex(ptr, addr, 5);
+	*ptr++ = ' ';
+	*ptr++ = ' ';
+	for (i = 0; i < length; i++)
+		ptr = putHex(ptr, code[i], 2);
+	for (; i < 5; i++) {
+		*ptr++ = ' ';
+		*ptr++ = ' ';
+	}
+
+	/* opcode가 없으면 데이터로 취급 */
+	if (op == NULL) {
+		ptr = putString(ptr, "BYTE    X'");
+		ptr = putHex(ptr, code[0], 2);
+		*ptr++ = '\'';
+		*ptr++ = '\n';
+		*len = (int)(ptr - dst);
+		return 1;
+	}
+
+	/* operand */
+	if (op->format == OP_FORMAT_2) {
+		unsigned int r1 = code[1] >> 4;
+		unsigned int r2 = code[1] & 0x0F;
+
+		if (!strcmp(op->mnemonic, "SVC")) {
+			opnd = putHex(opnd, r1, 1);
+		}
+		else if (!strcmp(op->mnemonic, "CLEAR") || !strcmp(op->mnemonic, "TIXR")) {
+			opnd = putString(opnd, reg_names[r1]);
+		}
+		else if (!strcmp(op->mnemonic, "SHIFTL") || !strcmp(op->mnemonic, "SHIFTR")) {
+			opnd = putString(opnd, reg_names[r1]);
+			*opnd++ = ',';
+			opnd = putHex(opnd, r2 + 1, 1);
+		}
+		else {
+			opnd = putString(opnd, reg_names[r1]);
+			*opnd++ = ',';
+			opnd = putString(opnd, reg_names[r2]);
+		}
+	}
+	else if (op->format == OP_FORMAT_34 && strcmp(op->mnemonic, "RSUB")) {
+		unsigned int ni = code[0] & 0x03;
+		unsigned int flags = code[1];
+		unsigned int target;
+		int indexed;
+		int base_relative = false;
+
+		if (ni == 0) {
+			/* SIC 표준 형식: x flag + 15 bit 주소 */
+			indexed = flags & 0x80;
+			target = ((flags & 0x7F) << 8) | code[2];
+		}
+		else {
+			indexed = flags & 0x80;
+			if (extended) {
+				target = ((flags & 0x0F) << 16) | (code[2] << 8) | code[3];
+			}
+			else {
+				target = ((flags & 0x0F) << 8) | code[2];
+				/* p: PC relative, disp는 12 bit 2의 보수 */
+				if (flags & 0x20) {
+					int disp = (target & 0x800) ? (int)target - 0x1000 : (int)target;
+					target = (unsigned int)(addr + 3 + disp) & 0xFFFFF;
+				}
+				/* b: base relative */
+				else if (flags & 0x40) {
+					base_relative = true;
+				}
+			}
+
+			if (ni == 0x01)
+				*opnd++ = '#';
+			else if (ni == 0x02)
+				*opnd++ = '@';
+		}
+
+		if (base_relative) {
+			opnd = putString(opnd, "B+");
+			opnd = putHex(opnd, target, 3);
+		}
+		else {
+			opnd = putHex(opnd, target, 5);
+			/* immediate는 PC relative일 때만 주소이다 */
+			if (ni != 0x01 || (!extended && (flags & 0x20)))
+				*target_addr = target;
+		}
+		if (indexed)
+			opnd = putString(opnd, ",X");
+	}
+	*opnd = 0;
+
+	/* mnemonic과 operand */
+	if (extended) {
+		*ptr++ = '+';
+		ptr = padField(ptr, op->mnemonic, 7);
+	}
+	else {
+		ptr = padField(ptr, op->mnemonic, 8);
+	}
+	ptr = putString(ptr, field);
+
+	/* operand가 없으면 mnemonic 뒤의 공백을 지운다 */
+	while (ptr > dst && ptr[-1] == ' ')
+		ptr--;
+	*ptr++ = '\n';
+
+	*len = (int)(ptr - dst);
+	return length;
+}
+
+/*************************************************************************************
+* 설명: hash table의 entry 하나를 decode table에 넣는다. foreachHash의 action 함수.
+* 인자:
+* - data: hash table의 entry
+* - aux: decode table
+* 반환값: 없음
+*************************************************************************************/
+static void addDecodeEntry(void* data, void* aux)
+{
+	Entry* entry = (Entry*)data;
+	Opcode** decode = (Opcode**)aux;
+	Opcode* op = (Opcode*)entry->value;
+	int i;
+
+	if (op->format == OP_FORMAT_34) {
+		for (i = 0; i < 4; i++)
+			decode[(op->code & 0xFC) | i] = op;
+	}
+	else {
+		decode[op->code & 0xFF] = op;
+	}
+}
+
+/*************************************************************************************
+* 설명: value를 digits 자리의 16진수로 dst에 쓴다. 문자열 끝의 0은 쓰지 않는다.
+* 인자:
+* - dst: 쓸 위치
+* - value: 값
+* - digits: 자리수
+* 반환값: 마지막으로 쓴 문자의 다음 위치
+*************************************************************************************/
+static char* putHex(char* dst, unsigned int value, int digits)
+{
+	int i;
+	for (i = digits - 1; i >= 0; i--) {
+		dst[i] = hex_digits[value & 0x0F];
+		value >>= 4;
+	}
+	return dst + digits;
+}
+
+/*************************************************************************************
+* 설명: 문자열을 dst에 복사한다. 문자열 끝의 0은 쓰지 않는다.
+* 인자:
+* - dst: 쓸 위치
+* - str: 문자열
+* 반환값: 마지막으로 쓴 문자의 다음 위치
+*************************************************************************************/
+static char* putString(char* dst, const char* str)
+{
+	while (*str)
+		*dst++ = *str++;
+	return dst;
+}
+
+/*************************************************************************************
+* 설명: 문자열을 dst에 복사하고 width 칸이 될 때까지 공백을 채운다.
+* 인자:
+* - dst: 쓸 위치
+* - field: 문자열
+* - width: 칸 수
+* 반환값: 마지막으로 쓴 문자의 다음 위치
+*************************************************************************************/
+static char* padField(char* dst, const char* field, int width)
+{
+	char* start = dst;
+
+	dst = putString(dst, field);
+	while (dst - start < width)
+		*dst++ = ' ';
+	return dst;
+}
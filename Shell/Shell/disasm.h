@@ -0,0 +1,14 @@
+﻿#ifndef DISASM_H_
+#define DISASM_H_
+
+#include "sicsim.h"
+
+#define DISASM_LINE_MAX    64
+#define DISASM_NO_TARGET   0xFFFFFFFFu
+
+/* Disassembler 관련 함수 */
+extern void buildDecodeTable(HashTable* op_table, Opcode* decode[DECODE_SIZE]);
+extern int disassemble(char* dst, int* len, unsigned int* target, const unsigned char* mem, unsigned int base,
+	unsigned int addr, unsigned int size, Opcode* const decode[DECODE_SIZE]);
+
+#endif
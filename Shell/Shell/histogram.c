@@ -0,0 +1,160 @@
+﻿#include "histogram.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static int getBucketIndex(unsigned long long value);
+static unsigned long long getBucketLimit(int index);
+
+/*************************************************************************************
+* 설명: histogram에 대한 초기화를 수행한다. 모든 bucket을 0으로 만든다.
+* 인자:
+* - hist: histogram에 대한 정보를 담고 있는 구조체에 대한 포인터
+* 반환값: 없음
+*************************************************************************************/
+void initializeHistogram(Histogram* hist)
+{
+	memset(hist, 0, sizeof(Histogram));
+}
+
+/*************************************************************************************
+* 설명: histogram에 값 하나를 기록한다.
+* 인자:
+* - hist: histogram에 대한 정보를 담고 있는 구조체에 대한 포인터
+* - value: 기록할 값
+* 반환값: 없음
+*************************************************************************************/
+void recordHistogram(Histogram* hist, unsigned long long value)
+{
+	hist->buckets[getBucketIndex(value)]++;
+	hist->count++;
+	hist->sum += value;
+	if (value > hist->max)
+		hist->max = value;
+}
+
+/*************************************************************************************
+* 설명: src histogram에 기록된 값들을 dst histogram에 더한다.
+* 인자:
+* - dst: 값을 더할 histogram에 대한 포인터
+* - src: 더할 값을 갖고 있는 histogram에 대한 포인터
+* 반환값: 없음
+*************************************************************************************/
+void mergeHistogram(Histogram* dst, const Histogram* src)
+{
+	int i;
+	for (i = 0; i < HIST_BUCKET_CNT; i++)
+		dst->buckets[i] += src->buckets[i];
+
+	dst->count += src->count;
+	dst->sum += src->sum;
+	if (src->max > dst->max)
+		dst->max = src->max;
+}
+
+/*************************************************************************************
+* 설명: 기록된 값들의 백분위 값을 구한다. 해당 값이 속한 bucket의 상한을 반환하므로
+*       실제 값보다 최대 1 / HIST_SUB_CNT 만큼 클 수 있다.
+* 인자:
+* - hist: histogram에 대한 정보를 담고 있는 구조체에 대한 포인터
+* - percent: 구하려는 백분위 (0 ~ 100)
+* 반환값: 백분위 값, 기록된 값이 없으면 0
+*************************************************************************************/
+unsigned long long getPercentile(const Histogram* hist, double percent)
+{
+	unsigned long long target;
+	unsigned long long seen = 0;
+	int i;
+
+	if (hist->count == 0)
+		return 0;
+
+	target = (unsigned long long)(hist->count * percent / 100.0 + 0.5);
+	if (target < 1)
+		target = 1;
+	if (target > hist->count)
+		target = hist->count;
+
+	for (i = 0; i < HIST_BUCKET_CNT; i++) {
+		seen += hist->buckets[i];
+		if (seen >= target) {
+			unsigned long long limit = getBucketLimit(i);
+			return limit < hist->max ? limit : hist->max;
+		}
+	}
+
+	return hist->max;
+}
+
+/*************************************************************************************
+* 설명: 단조 증가하는 시계(monotonic clock)의 현재 시각을 ns 단위로 구한다.
+*       시간 간격을 재는 용도로만 사용한다.
+* 인자: 없음
+* 반환값: 현재 시각 (ns)
+*************************************************************************************/
+unsigned long long getTimeNs(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+
+	return (unsigned long long)(now.QuadPart / freq.QuadPart) * 1000000000ULL
+		+ (unsigned long long)(now.QuadPart % freq.QuadPart) * 1000000000ULL / freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+#endif
+}
+
+/*************************************************************************************
+* 설명: 값이 속하는 bucket의 index를 구한다. HIST_SUB_CNT보다 작은 값은 그대로
+*       index가 되고, 그 이상은 최상위 bit의 위치로 구간을 정하고 그 아래
+*       HIST_SUB_BITS개의 bit로 구간 안의 bucket을 정한다.
+* 인자:
+* - value: bucket을 찾을 값
+* 반환값: bucket의 index
+*************************************************************************************/
+static int getBucketIndex(unsigned long long value)
+{
+	int msb;
+	int shift;
+
+	if (value < HIST_SUB_CNT)
+		return (int)value;
+
+#if defined(__GNUC__)
+	msb = 63 - __builtin_clzll(value);
+#else
+	for (msb = 0; (value >> msb) > 1; msb++);
+#endif
+
+	shift = msb - HIST_SUB_BITS;
+	return ((shift + 1) << HIST_SUB_BITS) + (int)((value >> shift) - HIST_SUB_CNT);
+}
+
+/*************************************************************************************
+* 설명: bucket에 속할 수 있는 가장 큰 값을 구한다. getBucketIndex의 역함수이다.
+* 인자:
+* - index: bucket의 index
+* 반환값: 해당 bucket의 상한
+*************************************************************************************/
+static unsigned long long getBucketLimit(int index)
+{
+	int group = index >> HIST_SUB_BITS;
+	int sub = index & (HIST_SUB_CNT - 1);
+
+	if (group == 0)
+		return (unsigned long long)sub;
+
+	return (((unsigned long long)(HIST_SUB_CNT + sub + 1)) << (group - 1)) - 1;
+}
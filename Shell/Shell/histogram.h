@@ -0,0 +1,31 @@
+﻿#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#define HIST_SUB_BITS   3
+#define HIST_SUB_CNT    (1 << HIST_SUB_BITS)
+#define HIST_BUCKET_CNT ((64 - HIST_SUB_BITS + 1) * HIST_SUB_CNT)
+
+/*************************************************************************************
+* 설명: 값의 분포를 log 단위로 나눈 bucket에 세어서 저장하는 HDR 방식의 histogram.
+*       2의 거듭제곱 구간마다 HIST_SUB_CNT개의 bucket을 두므로 상대 오차는
+*       1 / HIST_SUB_CNT 이내이고, 값 하나를 기록하는 비용은 bucket index 계산과
+*       덧셈 몇 번으로 일정하다. 주로 명령 처리 시간(ns)을 기록하는데 사용한다.
+* count: 기록된 값의 갯수
+* sum: 기록된 값의 합
+* max: 기록된 값 중 최대값
+* buckets: 각 bucket에 속하는 값의 갯수
+*************************************************************************************/
+typedef struct {
+	unsigned long long count;
+	unsigned long long sum;
+	unsigned long long max;
+	unsigned long long buckets[HIST_BUCKET_CNT];
+} Histogram;
+
+extern void initializeHistogram(Histogram* hist);
+extern void recordHistogram(Histogram* hist, unsigned long long value);
+extern void mergeHistogram(Histogram* dst, const Histogram* src);
+extern unsigned long long getPercentile(const Histogram* hist, double percent);
+extern unsigned long long getTimeNs(void);
+
+#endif
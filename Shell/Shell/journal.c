@@ -0,0 +1,371 @@
+﻿#include "journal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define JOURNAL_RUN_FLAG 0x80000000u
+
+static int encodeRange(Journal* journal, const unsigned char* mem, unsigned int len);
+static void writeHeader(unsigned char* dst, unsigned int header);
+static void decodeRange(const unsigned char* data, size_t size, unsigned char* mem);
+static void dropEntry(Journal* journal, int index);
+
+/*************************************************************************************
+* 설명: journal을 비어있는 상태로 초기화한다. 사용하기 전에 반드시 실행해야 한다.
+* 인자:
+* - journal: journal에 대한 포인터
+* - budget: 기록의 크기의 합의 상한(byte). 0이면 기록하지 않는다.
+* 반환값: 없음
+*************************************************************************************/
+void initializeJournal(Journal* journal, size_t budget)
+{
+	journal->head = 0;
+	journal->count = 0;
+	journal->cursor = 0;
+	journal->bytes = 0;
+	journal->budget = budget;
+	journal->serial = 0;
+	journal->pending = NULL;
+	journal->pending_size = 0;
+	journal->pending_cap = 0;
+	journal->addr = 0;
+	journal->len = 0;
+	journal->device = 0;
+}
+
+/*************************************************************************************
+* 설명: 모든 기록을 버린다. 메모리 전체가 다른 내용으로 바뀌어 기록이 의미가 없어지거나,
+*       작업을 기록하지 못해서 기록이 메모리와 맞지 않게 될 때 사용한다.
+* 인자:
+* - journal: journal에 대한 포인터
+* 반환값: 없음
+*************************************************************************************/
+void clearJournal(Journal* journal)
+{
+	int i;
+
+	for (i = 0; i < journal->count; i++)
+		free(journal->entries[(journal->head + i) % JOURNAL_ENTRY_MAX]);
+
+	journal->head = 0;
+	journal->count = 0;
+	journal->cursor = 0;
+	journal->bytes = 0;
+}
+
+/*************************************************************************************
+* 설명: journal이 사용한 메모리를 모두 해제한다.
+* 인자:
+* - journal: journal에 대한 포인터
+* 반환값: 없음
+*************************************************************************************/
+void releaseJournal(Journal* journal)
+{
+	clearJournal(journal);
+	free(journal->pending);
+	journal->pending = NULL;
+	journal->pending_cap = 0;
+}
+
+/*************************************************************************************
+* 설명: 메모리를 바꾸기 직전에 호출한다. 바뀔 범위의 현재 내용을 압축해둔다.
+*       같은 값이 JOURNAL_RUN_MIN개 이상 이어지면 run으로, 아니면 그대로 저장하므로
+*       드는 시간과 공간은 바뀌는 byte 수에 비례한다.
+* 인자:
+* - journal: journal에 대한 포인터
+* - mem: 메모리의 시작
+* - addr, len: 바뀔 범위
+* 반환값: 없음
+*************************************************************************************/
+void beginJournal(Journal* journal, const unsigned char* mem, unsigned int addr, unsigned int len)
+{
+	journal->addr = addr;
+	journal->len = len;
+	journal->device = 0;
+	journal->pending_size = 0;
+
+	if (journal->budget == 0)
+		return;
+
+	/* 기록하지 못한 작업이 생기면 이전 기록으로 되돌릴 수 없으므로 모두 버린다 */
+	if (!encodeRange(journal, mem + addr, len)) {
+		clearJournal(journal);
+		journal->len = 0;
+	}
+}
+
+/*************************************************************************************
+* 설명: 메모리를 바꾼 직후에 호출한다. 바뀐 후의 내용을 압축하여 바뀌기 전의 내용과
+*       함께 기록으로 추가한다. redo할 수 있던 기록은 버리고, 기록의 크기가 budget을
+*       넘거나 갯수가 JOURNAL_ENTRY_MAX를 넘으면 가장 오래된 것부터 버린다.
+*       기록 하나가 budget보다 크면 그 작업은 되돌릴 수 없으므로 모든 기록을 버린다.
+* 인자:
+* - journal: journal에 대한 포인터
+* - mem: 메모리의 시작
+* 반환값: 없음
+*************************************************************************************/
+void endJournal(Journal* journal, const unsigned char* mem)
+{
+	JournalEntry* entry;
+	size_t pre_size = journal->pending_size;
+	size_t entry_size;
+
+	if (journal->budget == 0 || journal->len == 0)
+		return;
+
+	if (!encodeRange(journal, mem + journal->addr, journal->len)) {
+		clearJournal(journal);
+		return;
+	}
+
+	entry_size = sizeof(JournalEntry) + journal->pending_size;
+	if (entry_size > journal->budget) {
+		clearJournal(journal);
+		return;
+	}
+
+	/* redo할 수 있던 기록은 버린다 */
+	while (journal->count > journal->cursor)
+		dropEntry(journal, --journal->count);
+
+	/* 오래된 기록부터 버린다 */
+	while (journal->count > 0 &&
+		(journal->count == JOURNAL_ENTRY_MAX || journal->bytes + entry_size > journal->budget)) {
+		dropEntry(journal, 0);
+		journal->head = (journal->head + 1) % JOURNAL_ENTRY_MAX;
+		journal->count--;
+	}
+
+	entry = (JournalEntry*)malloc(entry_size);
+	if (entry == NULL) {
+		clearJournal(journal);
+		return;
+	}
+	entry->id = ++journal->serial;
+	entry->addr = journal->addr;
+	entry->len = journal->len;
+	entry->device = journal->device;
+	entry->pre_size = pre_size;
+	entry->size = journal->pending_size;
+	memcpy(entry->data, journal->pending, journal->pending_size);
+
+	journal->entries[(journal->head + journal->count) % JOURNAL_ENTRY_MAX] = entry;
+	journal->count++;
+	journal->cursor = journal->count;
+	journal->bytes += entry_size;
+}
+
+/*************************************************************************************
+* 설명: 가장 최근에 기록된 작업을 되돌린다. 바뀌기 전의 내용을 메모리에 다시 쓴다.
+* 인자:
+* - journal: journal에 대한 포인터
+* - mem: 메모리의 시작
+* - addr, len: 되돌린 메모리의 범위를 저장할 곳
+* 반환값: 되돌렸으면 true(1), 되돌릴 기록이 없으면 false(0)
+*************************************************************************************/
+int undoJournal(Journal* journal, unsigned char* mem, unsigned int* addr, unsigned int* len)
+{
+	const JournalEntry* entry;
+
+	if (journal->cursor == 0)
+		return 0;
+
+	entry = journal->entries[(journal->head + journal->cursor - 1) % JOURNAL_ENTRY_MAX];
+	decodeRange(entry->data, entry->pre_size, mem + entry->addr);
+	journal->cursor--;
+
+	*addr = entry->addr;
+	*len = entry->len;
+	return 1;
+}
+
+/*************************************************************************************
+* 설명: undo로 되돌린 작업을 다시 실행한다. 바뀐 후의 내용을 메모리에 다시 쓴다.
+* 인자:
+* - journal: journal에 대한 포인터
+* - mem: 메모리의 시작
+* - addr, len: 다시 실행한 메모리의 범위를 저장할 곳
+* 반환값: 다시 실행했으면 true(1), 다시 실행할 기록이 없으면 false(0)
+*************************************************************************************/
+int redoJournal(Journal* journal, unsigned char* mem, unsigned int* addr, unsigned int* len)
+{
+	const JournalEntry* entry;
+
+	if (journal->cursor == journal->count)
+		return 0;
+
+	entry = journal->entries[(journal->head + journal->cursor) % JOURNAL_ENTRY_MAX];
+	decodeRange(entry->data + entry->pre_size, entry->size - entry->pre_size, mem + entry->addr);
+	journal->cursor++;
+
+	*addr = entry->addr;
+	*len = entry->len;
+	return 1;
+}
+
+/*************************************************************************************
+* 설명: 다음에 undo할 기록과 redo할 기록을 바꾸지 않고 얻는다. 되돌리기 전에 범위나
+*       장치에 썼는지를 확인할 때 사용한다.
+* 인자:
+* - journal: journal에 대한 포인터
+* 반환값: 기록에 대한 포인터, 없으면 NULL
+*************************************************************************************/
+const JournalEntry* getUndoEntry(const Journal* journal)
+{
+	if (journal->cursor == 0)
+		return NULL;
+	return journal->entries[(journal->head + journal->cursor - 1) % JOURNAL_ENTRY_MAX];
+}
+
+const JournalEntry* getRedoEntry(const Journal* journal)
+{
+	if (journal->cursor == journal->count)
+		return NULL;
+	return journal->entries[(journal->head + journal->cursor) % JOURNAL_ENTRY_MAX];
+}
+
+/*************************************************************************************
+* 설명: 남아있는 기록 중 가장 오래된 것을 얻는다. 이보다 오래된 기록은 버려졌으므로
+*       기록에 연결한 다른 상태도 버릴 수 있다.
+* 인자:
+* - journal: journal에 대한 포인터
+* 반환값: 기록에 대한 포인터, 없으면 NULL
+*************************************************************************************/
+const JournalEntry* getOldestEntry(const Journal* journal)
+{
+	if (journal->count == 0)
+		return NULL;
+	return journal->entries[journal->head];
+}
+
+/*************************************************************************************
+* 설명: 메모리의 내용을 압축하여 pending 버퍼의 뒤에 붙인다. 먼저 최악의 경우의 크기
+*       만큼 버퍼를 확보해둔다.
+* 인자:
+* - journal: journal에 대한 포인터
+* - mem, len: 압축할 메모리의 시작과 길이
+* 반환값: 성공하면 1, 버퍼를 할당하지 못하면 0
+*************************************************************************************/
+static int encodeRange(Journal* journal, const unsigned char* mem, unsigned int len)
+{
+	/* run은 JOURNAL_RUN_MIN byte 이상을 5 byte로, literal은 그 사이를 header 4 byte와
+	   함께 저장하므로 segment의 갯수는 run 갯수의 두 배를 넘지 않는다 */
+	size_t need = journal->pending_size + len + 9 * (len / JOURNAL_RUN_MIN + 1);
+	unsigned char* dst;
+	unsigned int literal = 0;
+	unsigned int i = 0;
+
+	if (need > journal->pending_cap) {
+		unsigned char* pending = (unsigned char*)realloc(journal->pending, need);
+		if (pending == NULL)
+			return 0;
+		journal->pending = pending;
+		journal->pending_cap = need;
+	}
+	dst = journal->pending + journal->pending_size;
+
+	while (i + 8 <= len) {
+		unsigned long long pattern = 0x0101010101010101ULL * mem[i];
+		unsigned long long word;
+		unsigned int start = i;
+		unsigned int j = i + 8;
+
+		/* literal은 8 byte씩 건너뛰며 한 값으로 채워진 8 byte를 찾는다. 15 byte 이상의
+		   run은 이 8 byte 중 하나를 반드시 포함하므로 놓치지 않는다 */
+		memcpy(&word, mem + i, 8);
+		if (word != pattern) {
+			i += 8;
+			continue;
+		}
+
+		/* 찾은 곳의 앞뒤로 run을 늘린다. fill로 만든 긴 run은 8 byte씩 비교한다 */
+		while (start > literal && mem[start - 1] == mem[i])
+			start--;
+		while (j + 8 <= len) {
+			memcpy(&word, mem + j, 8);
+			if (word != pattern)
+				break;
+			j += 8;
+		}
+		while (j < len && mem[j] == mem[i])
+			j++;
+
+		if (j - start >= JOURNAL_RUN_MIN) {
+			if (start > literal) {
+				writeHeader(dst, start - literal);
+				memcpy(dst + 4, mem + literal, start - literal);
+				dst += 4 + (start - literal);
+			}
+			writeHeader(dst, JOURNAL_RUN_FLAG | (j - start));
+			dst[4] = mem[i];
+			dst += 5;
+			literal = j;
+		}
+		i = j;
+	}
+	if (len > literal) {
+		writeHeader(dst, len - literal);
+		memcpy(dst + 4, mem + literal, len - literal);
+		dst += 4 + (len - literal);
+	}
+
+	journal->pending_size = dst - journal->pending;
+	return 1;
+}
+
+/*************************************************************************************
+* 설명: segment의 header 4 byte를 little endian으로 쓴다.
+* 인자:
+* - dst: 쓸 위치
+* - header: 최상위 bit가 run 여부이고 나머지가 길이인 값
+* 반환값: 없음
+*************************************************************************************/
+static void writeHeader(unsigned char* dst, unsigned int header)
+{
+	dst[0] = (unsigned char)header;
+	dst[1] = (unsigned char)(header >> 8);
+	dst[2] = (unsigned char)(header >> 16);
+	dst[3] = (unsigned char)(header >> 24);
+}
+
+/*************************************************************************************
+* 설명: encodeRange로 압축한 내용을 풀어서 메모리에 쓴다.
+* 인자:
+* - data, size: 압축한 내용과 크기
+* - mem: 쓸 메모리의 시작
+* 반환값: 없음
+*************************************************************************************/
+static void decodeRange(const unsigned char* data, size_t size, unsigned char* mem)
+{
+	const unsigned char* end = data + size;
+
+	while (data < end) {
+		unsigned int header = data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+		unsigned int len = header & ~JOURNAL_RUN_FLAG;
+
+		if (header & JOURNAL_RUN_FLAG) {
+			memset(mem, data[4], len);
+			data += 5;
+		}
+		else {
+			memcpy(mem, data + 4, len);
+			data += 4 + len;
+		}
+		mem += len;
+	}
+}
+
+/*************************************************************************************
+* 설명: head로부터 index번째 기록을 해제하고 크기의 합에서 뺀다. ring buffer의 위치는
+*       호출하는 쪽에서 조정한다.
+* 인자:
+* - journal: journal에 대한 포인터
+* - index: head로부터의 순서
+* 반환값: 없음
+*************************************************************************************/
+static void dropEntry(Journal* journal, int index)
+{
+	JournalEntry* entry = journal->entries[(journal->head + index) % JOURNAL_ENTRY_MAX];
+
+	journal->bytes -= sizeof(JournalEntry) + entry->size;
+	free(entry);
+}
@@ -0,0 +1,78 @@
+﻿#ifndef JOURNAL_H_
+#define JOURNAL_H_
+
+#include <stddef.h>
+
+#define JOURNAL_ENTRY_MAX 1024
+#define JOURNAL_BUDGET    (4 * 1024 * 1024)
+#define JOURNAL_RUN_MIN   8
+
+/*************************************************************************************
+* 설명: 메모리를 바꾼 작업 하나에 대한 기록. 바뀌기 전과 후의 내용을 압축하여
+*       data에 차례로 저장한다. 압축한 내용은 segment의 나열이고, segment는 4 byte
+*       header(최상위 bit가 1이면 run)와 run이면 값 1 byte, 아니면 길이만큼의 byte로
+*       이루어진다.
+* id: 기록마다 1부터 차례로 붙이는 번호. 기록을 버려도 다시 쓰지 않는다.
+* addr, len: 바뀐 메모리의 범위
+* device: 범위의 일부를 메모리 대신 장치에 썼는지 여부. 장치에 쓴 내용은 기록하지
+*         않으므로 되돌릴 수 없다.
+* pre_size: data에서 바뀌기 전 내용의 크기. 나머지는 바뀐 후의 내용
+* size: data의 크기
+*************************************************************************************/
+typedef struct {
+	unsigned long long id;
+	unsigned int addr;
+	unsigned int len;
+	int device;
+	size_t pre_size;
+	size_t size;
+	unsigned char data[1];
+} JournalEntry;
+
+/*************************************************************************************
+* 설명: undo/redo를 위한 작업 기록. entries는 ring buffer로 가장 오래된 기록부터
+*       head에서 시작하고, [0, cursor)는 undo할 수 있는 기록, [cursor, count)는
+*       redo할 수 있는 기록이다. 기록의 크기의 합이 budget을 넘으면 오래된 기록부터
+*       버린다.
+* entries: 기록에 대한 포인터의 ring buffer
+* head: 가장 오래된 기록의 위치
+* count: 기록의 갯수
+* cursor: 다음에 redo할 기록의 순서. 0이면 undo할 것이 없다.
+* bytes: 기록의 크기의 합
+* budget: 기록의 크기의 합의 상한
+* serial: 마지막으로 붙인 기록의 번호
+* pending: 바뀌기 전의 내용을 압축해둔 버퍼. 작업이 끝나면 기록으로 옮긴다.
+* pending_size, pending_cap: pending의 사용량과 크기
+* addr, len: 기록 중인 작업의 메모리 범위
+* device: 기록 중인 작업이 장치에 썼는지 여부. beginJournal이 지우고 쓰는 쪽이 표시한다.
+*************************************************************************************/
+typedef struct {
+	JournalEntry* entries[JOURNAL_ENTRY_MAX];
+	int head;
+	int count;
+	int cursor;
+	size_t bytes;
+	size_t budget;
+	unsigned long long serial;
+
+	unsigned char* pending;
+	size_t pending_size;
+	size_t pending_cap;
+	unsigned int addr;
+	unsigned int len;
+	int device;
+} Journal;
+
+/* Journal 관련 함수 */
+extern void initializeJournal(Journal* journal, size_t budget);
+extern void clearJournal(Journal* journal);
+extern void releaseJournal(Journal* journal);
+extern void beginJournal(Journal* journal, const unsigned char* mem, unsigned int addr, unsigned int len);
+extern void endJournal(Journal* journal, const unsigned char* mem);
+extern int undoJournal(Journal* journal, unsigned char* mem, unsigned int* addr, unsigned int* len);
+extern int redoJournal(Journal* journal, unsigned char* mem, unsigned int* addr, unsigned int* len);
+extern const JournalEntry* getUndoEntry(const Journal* journal);
+extern const JournalEntry* getRedoEntry(const Journal* journal);
+extern const JournalEntry* getOldestEntry(const Journal* journal);
+
+#endif
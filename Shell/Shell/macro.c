@@ -0,0 +1,1045 @@
+﻿#include "macro.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/*************************************************************************************
+* 설명: 한 줄을 label, opcode, operand field로 나눈 위치. 모두 줄의 처음부터의 offset
+* rest: operand부터 줄 끝까지. IF의 조건식처럼 공백이 들어가는 operand에 사용한다.
+*************************************************************************************/
+typedef struct {
+	int label, label_len;
+	int op, op_len;
+	int arg, arg_len;
+	int rest_len;
+} Fields;
+
+static int splitFields(const char* line, int len, Fields* f);
+static int isField(const char* line, int off, int len, const char* word);
+static void processLine(MacroProcessor* mp, const char* line, int len, FILE* out);
+static void beginDefine(MacroProcessor* mp, const char* line, const Fields* f);
+static void defineLine(MacroProcessor* mp, const char* line, int len);
+static void endDefine(MacroProcessor* mp);
+static int addLine(MacroProcessor* mp, int type, const char* line, int len, const Fields* f);
+static void addTokens(MacroProcessor* mp, const char* line, int base, int start, int end);
+static int addToken(MacroProcessor* mp, int type, int off, int len);
+static int addText(MacroProcessor* mp, const char* str, int len);
+static int findParam(const MacroProcessor* mp, const Macro* macro, const char* name, int len);
+static void expand(MacroProcessor* mp, const Macro* macro, const char* args, FILE* out);
+static void pushFrame(MacroProcessor* mp, const Macro* macro, const char* args);
+static void expandLine(MacroProcessor* mp, FILE* out);
+static void writeTokens(const MacroProcessor* mp, const MacroFrame* frame, int tok, int cnt, FILE* out);
+static int renderTokens(MacroProcessor* mp, const MacroFrame* frame, int tok, int cnt, char* buf, int size);
+static int evaluate(const char* expr, int* result);
+static char* unquote(char* str);
+static int macroHash(void* key);
+static int macroCmp(void* a, void* b);
+static void releaseNamtab(void* data, void* aux);
+
+/*************************************************************************************
+* 설명: macro processor를 초기화한다. 사용하기 전에 반드시 실행해야 한다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* 반환값: 없음
+*************************************************************************************/
+void initializeMacro(MacroProcessor* mp)
+{
+	initializeHash(&mp->namtab, macroHash, macroCmp);
+	mp->toks = NULL;
+	mp->tok_cnt = mp->tok_cap = 0;
+	mp->lines = NULL;
+	mp->line_cnt = mp->line_cap = 0;
+	mp->text = NULL;
+	mp->text_len = mp->text_cap = 0;
+	mp->defining = false;
+	mp->level = 0;
+	mp->nest_cnt = 0;
+	mp->depth = 0;
+	mp->expansions = 0;
+	mp->error = MACRO_ERR_NONE;
+	mp->line_no = 0;
+}
+
+/*************************************************************************************
+* 설명: macro processor가 사용한 NAMTAB과 DEFTAB의 메모리를 모두 해제한다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* 반환값: 없음
+*************************************************************************************/
+void releaseMacro(MacroProcessor* mp)
+{
+	foreachHash(&mp->namtab, NULL, releaseNamtab);
+	clearHash(&mp->namtab);
+	free(mp->toks);
+	free(mp->lines);
+	free(mp->text);
+	mp->toks = NULL;
+	mp->lines = NULL;
+	mp->text = NULL;
+}
+
+/*************************************************************************************
+* 설명: 입력 파일을 한 줄씩 읽으면서 macro 정의는 DEFTAB에 저장하고, macro 호출은
+*       그 자리에서 확장하여 out에 쓴다. 그 밖의 줄은 그대로 쓴다. 호출한 줄은
+*       '.'으로 시작하는 주석으로 남기고, 호출한 줄에 label이 있으면 확장한 내용
+*       앞에 "label EQU *"를 쓴다.
+*       - 인자는 &NAME으로 참조하고, &NAME->TEXT처럼 '->'로 뒤의 문자열과 붙인다.
+*       - 인자는 순서대로 주거나 NAME=value로 준다. &NAME=value로 정의하면 기본값.
+*       - '$'로 시작하는 label은 호출마다 $AA, $AB, ...를 붙여 서로 다르게 만든다.
+*       - IF (lhs op rhs) / ELSE / ENDIF로 조건부 확장을 한다. op는 EQ, NE, LT,
+*         LE, GT, GE이고 양쪽이 모두 10진수이면 숫자로, 아니면 문자열로 비교한다.
+*       - 본문 안에서 다른 macro를 호출하거나 정의할 수 있다.
+* 인자:
+* - mp: 초기화된 macro processor에 대한 포인터
+* - in: 입력 파일
+* - out: 확장한 결과를 쓸 파일
+* 반환값: 성공하면 true(1), 실패하면 false(0). 실패하면 mp->error와 mp->line_no에
+*         원인과 위치가 남는다.
+*************************************************************************************/
+int processMacroFile(MacroProcessor* mp, FILE* in, FILE* out)
+{
+	char line[MACRO_LINE_MAX];
+
+	while (mp->error == MACRO_ERR_NONE && fgets(line, MACRO_LINE_MAX, in) != NULL) {
+		int len = (int)strlen(line);
+
+		mp->line_no++;
+		if (len > 0 && line[len - 1] == '\n')
+			line[--len] = 0;
+		else if (!feof(in)) {
+			mp->error = MACRO_ERR_LINE;
+			break;
+		}
+		if (len > 0 && line[len - 1] == '\r')
+			line[--len] = 0;
+
+		if (mp->defining)
+			defineLine(mp, line, len);
+		else
+			processLine(mp, line, len, out);
+	}
+
+	if (mp->error == MACRO_ERR_NONE && mp->defining)
+		mp->error = MACRO_ERR_NO_MEND;
+
+	return mp->error == MACRO_ERR_NONE;
+}
+
+/*************************************************************************************
+* 설명: 한 줄을 label, opcode, operand field로 나눈다. 첫 글자가 공백이 아니면 label이
+*       있는 것이다. operand 안의 '...'는 공백이 있어도 하나로 본다.
+* 인자:
+* - line: 한 줄
+* - len: 줄의 길이
+* - f: 나눈 결과를 저장할 구조체에 대한 포인터
+* 반환값: 주석이나 빈 줄이면 false(0), 아니면 true(1)
+*************************************************************************************/
+static int splitFields(const char* line, int len, Fields* f)
+{
+	int i = 0;
+
+	memset(f, 0, sizeof(Fields));
+	if (len > 0 && line[0] == '.')
+		return false;
+
+	while (i < len && !isspace((unsigned char)line[i]))
+		i++;
+	f->label_len = i;
+
+	while (i < len && isspace((unsigned char)line[i]))
+		i++;
+	if (i == len || line[i] == '.')
+		return f->label_len > 0;
+
+	f->op = i;
+	while (i < len && !isspace((unsigned char)line[i]))
+		i++;
+	f->op_len = i - f->op;
+
+	while (i < len && isspace((unsigned char)line[i]))
+		i++;
+	f->arg = i;
+	while (i < len && !isspace((unsigned char)line[i])) {
+		if (line[i] == '\'') {
+			for (i++; i < len && line[i] != '\''; i++);
+		}
+		if (i < len)
+			i++;
+	}
+	f->arg_len = i - f->arg;
+
+	for (i = len; i > f->arg && isspace((unsigned char)line[i - 1]); i--);
+	f->rest_len = i - f->arg;
+
+	return true;
+}
+
+/*************************************************************************************
+* 설명: 줄의 일부분이 주어진 단어와 같은지 확인한다.
+* 인자:
+* - line: 한 줄
+* - off, len: 비교할 부분의 위치와 길이
+* - word: 비교할 단어
+* 반환값: 같으면 true(1), 다르면 false(0)
+*************************************************************************************/
+static int isField(const char* line, int off, int len, const char* word)
+{
+	return (int)strlen(word) == len && !strncmp(line + off, word, len);
+}
+
+/*************************************************************************************
+* 설명: macro 정의 밖의 한 줄을 처리한다. MACRO면 정의를 시작하고, NAMTAB에 있는
+*       이름이면 확장하고, 나머지는 그대로 쓴다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - line, len: 처리할 줄과 길이
+* - out: 결과를 쓸 파일
+* 반환값: 없음
+*************************************************************************************/
+static void processLine(MacroProcessor* mp, const char* line, int len, FILE* out)
+{
+	char name[MACRO_LINE_MAX];
+	char args[MACRO_LINE_MAX];
+	const Macro* macro;
+	Fields f;
+
+	if (!splitFields(line, len, &f) || f.op_len == 0) {
+		fwrite(line, sizeof(char), len, out);
+		fputc('\n', out);
+		return;
+	}
+
+	if (isField(line, f.op, f.op_len, "MACRO")) {
+		beginDefine(mp, line, &f);
+		return;
+	}
+	if (isField(line, f.op, f.op_len, "MEND")) {
+		mp->error = MACRO_ERR_MEND;
+		return;
+	}
+
+	memcpy(name, line + f.op, f.op_len);
+	name[f.op_len] = 0;
+	macro = (const Macro*)getValue(&mp->namtab, name);
+	if (macro == NULL) {
+		fwrite(line, sizeof(char), len, out);
+		fputc('\n', out);
+		return;
+	}
+
+	/* 호출한 줄은 주석으로 남긴다 */
+	fputc('.', out);
+	fwrite(line, sizeof(char), len, out);
+	fputc('\n', out);
+	if (f.label_len > 0)
+		fprintf(out, "%.*s\tEQU\t*\n", f.label_len, line);
+
+	memcpy(args, line + f.arg, f.arg_len);
+	args[f.arg_len] = 0;
+	expand(mp, macro, args, out);
+}
+
+/*************************************************************************************
+* 설명: MACRO 줄을 만나면 정의할 macro의 이름과 인자를 저장하고 정의를 시작한다.
+*       인자는 &NAME 또는 &NAME=기본값을 ','로 구분하여 나열한다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - line: MACRO 줄
+* - f: MACRO 줄의 field 위치
+* 반환값: 없음
+*************************************************************************************/
+static void beginDefine(MacroProcessor* mp, const char* line, const Fields* f)
+{
+	Macro* def = &mp->def;
+	int i = f->arg;
+	int end = f->arg + f->arg_len;
+
+	if (f->label_len == 0) {
+		mp->error = MACRO_ERR_NAME;
+		return;
+	}
+	memcpy(mp->def_name, line, f->label_len);
+	mp->def_name[f->label_len] = 0;
+
+	def->name = NULL;
+	def->param_cnt = 0;
+	while (i < end) {
+		int start, value;
+
+		if (def->param_cnt == MACRO_PARAM_MAX || line[i] != '&' || i + 1 == end ||
+			!isalpha((unsigned char)line[i + 1])) {
+			mp->error = MACRO_ERR_PARAM;
+			return;
+		}
+
+		/* 이름 */
+		start = ++i;
+		while (i < end && (isalnum((unsigned char)line[i]) || line[i] == '_'))
+			i++;
+		def->param[def->param_cnt] = addText(mp, line + start, i - start);
+
+		/* 기본값 */
+		value = -1;
+		if (i < end && line[i] == '=') {
+			start = ++i;
+			while (i < end && line[i] != ',') {
+				if (line[i] == '\'') {
+					for (i++; i < end && line[i] != '\''; i++);
+				}
+				if (i < end)
+					i++;
+			}
+			value = addText(mp, line + start, i - start);
+		}
+		def->value[def->param_cnt++] = value;
+
+		if (i < end && line[i] != ',') {
+			mp->error = MACRO_ERR_PARAM;
+			return;
+		}
+		if (i < end)
+			i++;
+	}
+	if (mp->error != MACRO_ERR_NONE)
+		return;
+
+	def->line = mp->line_cnt;
+	def->line_cnt = 0;
+	mp->defining = true;
+	mp->level = 0;
+	mp->nest_cnt = 0;
+}
+
+/*************************************************************************************
+* 설명: 정의 중인 macro의 본문 한 줄을 DEFTAB에 추가한다. 중첩된 MACRO/MEND와
+*       IF/ELSE/ENDIF의 짝을 맞추어 jump를 채워두고, 짝이 맞는 MEND를 만나면
+*       정의를 끝낸다. 주석 줄은 저장하지 않는다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - line, len: 본문의 한 줄과 길이
+* 반환값: 없음
+*************************************************************************************/
+static void defineLine(MacroProcessor* mp, const char* line, int len)
+{
+	int type = MACRO_LINE_TEXT;
+	int index = mp->line_cnt;
+	Fields f;
+
+	if (!splitFields(line, len, &f))
+		return;
+
+	if (isField(line, f.op, f.op_len, "MEND")) {
+		if (mp->level == 0) {
+			endDefine(mp);
+			return;
+		}
+		if (mp->nest_cnt == 0 || mp->lines[mp->nest[mp->nest_cnt - 1]].type != MACRO_LINE_MACRO) {
+			mp->error = MACRO_ERR_COND;
+			return;
+		}
+		mp->lines[mp->nest[--mp->nest_cnt]].jump = index;
+		mp->level--;
+		type = MACRO_LINE_MEND;
+	}
+	else if (isField(line, f.op, f.op_len, "MACRO")) {
+		if (mp->nest_cnt == MACRO_DEPTH_MAX) {
+			mp->error = MACRO_ERR_DEPTH;
+			return;
+		}
+		mp->nest[mp->nest_cnt++] = index;
+		mp->level++;
+		type = MACRO_LINE_MACRO;
+	}
+	/* 중첩된 정의 안의 IF는 그 macro를 정의할 때 처리한다 */
+	else if (mp->level == 0 && isField(line, f.op, f.op_len, "IF")) {
+		if (mp->nest_cnt == MACRO_DEPTH_MAX) {
+			mp->error = MACRO_ERR_DEPTH;
+			return;
+		}
+		mp->nest[mp->nest_cnt++] = index;
+		f.arg_len = f.rest_len;
+		type = MACRO_LINE_IF;
+	}
+	else if (mp->level == 0 && (isField(line, f.op, f.op_len, "ELSE") || isField(line, f.op, f.op_len, "ENDIF"))) {
+		int top;
+
+		if (mp->nest_cnt == 0) {
+			mp->error = MACRO_ERR_COND;
+			return;
+		}
+		top = mp->nest[mp->nest_cnt - 1];
+		if (mp->lines[top].type != MACRO_LINE_IF && mp->lines[top].type != MACRO_LINE_ELSE) {
+			mp->error = MACRO_ERR_COND;
+			return;
+		}
+		if (isField(line, f.op, f.op_len, "ELSE")) {
+			if (mp->lines[top].type == MACRO_LINE_ELSE) {
+				mp->error = MACRO_ERR_COND;
+				return;
+			}
+			mp->nest[mp->nest_cnt - 1] = index;
+			type = MACRO_LINE_ELSE;
+		}
+		else {
+			mp->nest_cnt--;
+			type = MACRO_LINE_ENDIF;
+		}
+		mp->lines[top].jump = index;
+	}
+
+	addLine(mp, type, line, len, &f);
+}
+
+/*************************************************************************************
+* 설명: 짝이 맞는 MEND를 만나면 정의 중인 macro를 NAMTAB에 등록한다. 같은 이름의
+*       macro가 이미 있으면 새 정의로 바꾼다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* 반환값: 없음
+*************************************************************************************/
+static void endDefine(MacroProcessor* mp)
+{
+	Macro* macro;
+
+	if (mp->nest_cnt != 0) {
+		mp->error = MACRO_ERR_COND;
+		return;
+	}
+
+	mp->def.line_cnt = mp->line_cnt - mp->def.line;
+	mp->defining = false;
+
+	macro = (Macro*)getValue(&mp->namtab, mp->def_name);
+	if (macro == NULL) {
+		macro = (Macro*)malloc(sizeof(Macro));
+		if (macro == NULL) {
+			mp->error = MACRO_ERR_MEMORY;
+			return;
+		}
+		mp->def.name = (char*)malloc(strlen(mp->def_name) + 1);
+		if (mp->def.name == NULL) {
+			free(macro);
+			mp->error = MACRO_ERR_MEMORY;
+			return;
+		}
+		strcpy(mp->def.name, mp->def_name);
+		*macro = mp->def;
+		insertHash(&mp->namtab, macro->name, macro);
+	}
+	else {
+		mp->def.name = macro->name;
+		*macro = mp->def;
+	}
+}
+
+/*************************************************************************************
+* 설명: 본문의 한 줄을 token으로 나누어 DEFTAB에 추가한다. 줄 전체를 text arena에
+*       복사해두고, token은 그 안의 위치를 가리킨다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - type: MACRO_LINE_* 중 하나
+* - line, len: 추가할 줄과 길이
+* - f: 줄의 field 위치
+* 반환값: 추가한 줄의 번호, 실패하면 -1
+*************************************************************************************/
+static int addLine(MacroProcessor* mp, int type, const char* line, int len, const Fields* f)
+{
+	MacroLine* dst;
+	int base;
+	int op_end = f->op + f->op_len;
+	int arg_end = f->arg + f->arg_len;
+
+	if (mp->line_cnt == mp->line_cap) {
+		int cap = mp->line_cap ? mp->line_cap * 2 : 64;
+		MacroLine* lines = (MacroLine*)realloc(mp->lines, sizeof(MacroLine) * cap);
+		if (lines == NULL) {
+			mp->error = MACRO_ERR_MEMORY;
+			return -1;
+		}
+		mp->lines = lines;
+		mp->line_cap = cap;
+	}
+
+	base = addText(mp, line, len);
+	if (base < 0)
+		return -1;
+
+	dst = &mp->lines[mp->line_cnt];
+	dst->type = type;
+	dst->jump = -1;
+	dst->tok = mp->tok_cnt;
+
+	addTokens(mp, line, base, 0, f->op);
+	dst->op = mp->tok_cnt;
+	addTokens(mp, line, base, f->op, op_end);
+	dst->op_cnt = mp->tok_cnt - dst->op;
+	addTokens(mp, line, base, op_end, f->arg);
+	dst->arg = mp->tok_cnt;
+	addTokens(mp, line, base, f->arg, arg_end);
+	dst->arg_cnt = mp->tok_cnt - dst->arg;
+	addTokens(mp, line, base, arg_end, len);
+	dst->tok_cnt = mp->tok_cnt - dst->tok;
+
+	if (mp->error != MACRO_ERR_NONE)
+		return -1;
+	return mp->line_cnt++;
+}
+
+/*************************************************************************************
+* 설명: 줄의 [start, end) 부분을 token으로 나누어 추가한다. &NAME은 정의 중인 macro의
+*       인자 번호로 바꾸고, 바로 뒤의 '->'는 없앤다. 본문의 바로 아래 단계에서 '$'로
+*       시작하는 이름은 '$' 뒤에 호출마다 다른 문자열이 들어갈 token을 넣는다.
+*       중첩된 정의 안에서 찾지 못한 &NAME과 '$'는 안쪽 macro의 것이므로 그대로 둔다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - line: 한 줄
+* - base: line이 복사된 text arena의 위치
+* - start, end: token으로 나눌 부분
+* 반환값: 없음
+*************************************************************************************/
+static void addTokens(MacroProcessor* mp, const char* line, int base, int start, int end)
+{
+	int text = start;
+	int i = start;
+
+	while (i < end) {
+		if (line[i] == '&' && i + 1 < end && isalpha((unsigned char)line[i + 1])) {
+			int j = i + 1;
+			int index;
+
+			while (j < end && (isalnum((unsigned char)line[j]) || line[j] == '_'))
+				j++;
+
+			index = findParam(mp, &mp->def, line + i + 1, j - i - 1);
+			if (index < 0 && mp->level == 0) {
+				mp->error = MACRO_ERR_PARAM;
+				return;
+			}
+			if (index >= 0) {
+				if (i > text)
+					addToken(mp, MACRO_TOK_TEXT, base + text, i - text);
+				addToken(mp, MACRO_TOK_PARAM, index, 0);
+				if (j + 1 < end && line[j] == '-' && line[j + 1] == '>')
+					j += 2;
+				text = j;
+			}
+			i = j;
+		}
+		else if (line[i] == '$' && mp->level == 0 && i + 1 < end && isalpha((unsigned char)line[i + 1]) &&
+			(i == 0 || !isalnum((unsigned char)line[i - 1]))) {
+			addToken(mp, MACRO_TOK_TEXT, base + text, i + 1 - text);
+			addToken(mp, MACRO_TOK_UNIQUE, 0, 0);
+			text = ++i;
+		}
+		else {
+			i++;
+		}
+	}
+
+	if (i > text)
+		addToken(mp, MACRO_TOK_TEXT, base + text, i - text);
+}
+
+/*************************************************************************************
+* 설명: DEFTAB의 token arena에 token 하나를 추가한다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - type, off, len: 추가할 token
+* 반환값: 성공하면 true(1), 실패하면 false(0)
+*************************************************************************************/
+static int addToken(MacroProcessor* mp, int type, int off, int len)
+{
+	MacroToken* tok;
+
+	if (mp->tok_cnt == mp->tok_cap) {
+		int cap = mp->tok_cap ? mp->tok_cap * 2 : 256;
+		MacroToken* toks = (MacroToken*)realloc(mp->toks, sizeof(MacroToken) * cap);
+		if (toks == NULL) {
+			mp->error = MACRO_ERR_MEMORY;
+			return false;
+		}
+		mp->toks = toks;
+		mp->tok_cap = cap;
+	}
+
+	tok = &mp->toks[mp->tok_cnt++];
+	tok->type = type;
+	tok->off = off;
+	tok->len = len;
+	return true;
+}
+
+/*************************************************************************************
+* 설명: 문자열을 '\0'을 붙여 text arena에 복사한다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - str, len: 복사할 문자열과 길이
+* 반환값: text arena에서의 위치, 실패하면 -1
+*************************************************************************************/
+static int addText(MacroProcessor* mp, const char* str, int len)
+{
+	int off = mp->text_len;
+
+	if (mp->text_len + len + 1 > mp->text_cap) {
+		int cap = mp->text_cap ? mp->text_cap : 4096;
+		char* text;
+
+		while (mp->text_len + len + 1 > cap)
+			cap *= 2;
+		text = (char*)realloc(mp->text, cap);
+		if (text == NULL) {
+			mp->error = MACRO_ERR_MEMORY;
+			return -1;
+		}
+		mp->text = text;
+		mp->text_cap = cap;
+	}
+
+	memcpy(mp->text + off, str, len);
+	mp->text[off + len] = 0;
+	mp->text_len += len + 1;
+	return off;
+}
+
+/*************************************************************************************
+* 설명: macro의 인자 중에서 이름이 같은 것을 찾는다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - macro: 인자를 찾을 macro
+* - name, len: 찾을 이름('&' 제외)과 길이
+* 반환값: 인자의 번호, 없으면 -1
+*************************************************************************************/
+static int findParam(const MacroProcessor* mp, const Macro* macro, const char* name, int len)
+{
+	int i;
+
+	for (i = 0; i < macro->param_cnt; i++) {
+		const char* param = mp->text + macro->param[i];
+		if ((int)strlen(param) == len && !strncmp(param, name, len))
+			return i;
+	}
+	return -1;
+}
+
+/*************************************************************************************
+* 설명: macro 하나를 확장한다. 본문 안에서 다른 macro를 호출하면 frame stack에 쌓아서
+*       확장하므로, 처음 호출한 macro의 확장이 끝날 때까지 반복한다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - macro: 확장할 macro
+* - args: 호출한 줄의 operand
+* - out: 결과를 쓸 파일
+* 반환값: 없음
+*************************************************************************************/
+static void expand(MacroProcessor* mp, const Macro* macro, const char* args, FILE* out)
+{
+	pushFrame(mp, macro, args);
+	while (mp->error == MACRO_ERR_NONE && mp->depth > 0) {
+		if (mp->frames[mp->depth - 1].line >= mp->frames[mp->depth - 1].end)
+			mp->depth--;
+		else
+			expandLine(mp, out);
+	}
+	mp->depth = 0;
+}
+
+/*************************************************************************************
+* 설명: macro 호출의 인자를 ARGTAB(frame)에 저장하고 frame stack에 쌓는다.
+*       NAME=value 형식이면 이름으로, 아니면 순서대로 인자에 대응시키고, 주지 않은
+*       인자는 기본값이나 빈 문자열이 된다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - macro: 호출한 macro
+* - args: 호출한 줄의 operand
+* 반환값: 없음
+*************************************************************************************/
+static void pushFrame(MacroProcessor* mp, const Macro* macro, const char* args)
+{
+	MacroFrame* frame;
+	const char* value[MACRO_PARAM_MAX];
+	int value_len[MACRO_PARAM_MAX];
+	const char* ptr = args;
+	unsigned int n;
+	int pos = 0;
+	int len = 0;
+	int i;
+
+	if (mp->depth == MACRO_DEPTH_MAX) {
+		mp->error = MACRO_ERR_DEPTH;
+		return;
+	}
+	frame = &mp->frames[mp->depth];
+
+	for (i = 0; i < macro->param_cnt; i++) {
+		value[i] = macro->value[i] < 0 ? "" : mp->text + macro->value[i];
+		value_len[i] = (int)strlen(value[i]);
+	}
+
+	/* 인자를 ','로 나누어 대응시킨다 */
+	while (*ptr != 0) {
+		const char* start = ptr;
+		const char* eq = NULL;
+		int index;
+
+		while (*ptr != 0 && *ptr != ',') {
+			if (*ptr == '=' && eq == NULL)
+				eq = ptr;
+			if (*ptr == '\'') {
+				for (ptr++; *ptr != 0 && *ptr != '\''; ptr++);
+			}
+			if (*ptr != 0)
+				ptr++;
+		}
+
+		/* =C'EOF' 같은 literal은 이름이 없으므로 순서대로 대응시킨다 */
+		if (eq != NULL && eq > start && isalpha((unsigned char)*start)) {
+			index = findParam(mp, macro, start, (int)(eq - start));
+			if (index < 0) {
+				mp->error = MACRO_ERR_ARG;
+				return;
+			}
+			start = eq + 1;
+		}
+		else {
+			index = pos++;
+			if (index >= macro->param_cnt) {
+				mp->error = MACRO_ERR_ARG;
+				return;
+			}
+		}
+		value[index] = start;
+		value_len[index] = (int)(ptr - start);
+
+		if (*ptr == ',')
+			ptr++;
+	}
+
+	for (i = 0; i < macro->param_cnt; i++) {
+		if (len + value_len[i] > (int)sizeof(frame->args)) {
+			mp->error = MACRO_ERR_LINE;
+			return;
+		}
+		memcpy(frame->args + len, value[i], value_len[i]);
+		frame->arg_off[i] = len;
+		frame->arg_len[i] = value_len[i];
+		len += value_len[i];
+	}
+
+	/* 호출마다 다른 label 문자열: AA, AB, ..., ZZ, BAA, ... */
+	n = mp->expansions++;
+	frame->uniq_len = 0;
+	do {
+		frame->uniq[frame->uniq_len++] = (char)('A' + n % 26);
+		n /= 26;
+	} while (n > 0 || frame->uniq_len < 2);
+	for (i = 0; i < frame->uniq_len / 2; i++) {
+		char tmp = frame->uniq[i];
+		frame->uniq[i] = frame->uniq[frame->uniq_len - 1 - i];
+		frame->uniq[frame->uniq_len - 1 - i] = tmp;
+	}
+
+	frame->line = macro->line;
+	frame->end = macro->line + macro->line_cnt;
+	mp->depth++;
+}
+
+/*************************************************************************************
+* 설명: 가장 안쪽 frame의 다음 줄 하나를 확장한다. 일반적인 줄은 token을 바로 out에
+*       쓰고, IF/ELSE는 미리 저장해둔 jump로 건너뛴다. macro 호출과 중첩된 정의는
+*       인자를 치환한 문자열을 만들어서 처리한다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - out: 결과를 쓸 파일
+* 반환값: 없음
+*************************************************************************************/
+static void expandLine(MacroProcessor* mp, FILE* out)
+{
+	MacroFrame* frame = &mp->frames[mp->depth - 1];
+	const MacroLine* line = &mp->lines[frame->line++];
+	char buffer[MACRO_LINE_MAX];
+	const Macro* macro;
+	int result;
+	int end, i;
+
+	switch (line->type) {
+	case MACRO_LINE_IF:
+		if (!renderTokens(mp, frame, line->arg, line->arg_cnt, buffer, MACRO_LINE_MAX))
+			return;
+		if (!evaluate(buffer, &result)) {
+			mp->error = MACRO_ERR_EXPR;
+			return;
+		}
+		if (!result)
+			frame->line = line->jump + 1;
+		return;
+
+	case MACRO_LINE_ELSE:
+		frame->line = line->jump + 1;
+		return;
+
+	case MACRO_LINE_ENDIF:
+	case MACRO_LINE_MEND:
+		return;
+
+	case MACRO_LINE_MACRO:
+		/* 중첩된 정의: 인자를 치환한 줄로 새 macro를 정의한다. 정의하면서 DEFTAB이
+		   늘어나므로 line 포인터 대신 번호를 사용한다 */
+		end = line->jump;
+		for (i = frame->line - 1; i <= end && mp->error == MACRO_ERR_NONE; i++) {
+			const MacroLine* src = &mp->lines[i];
+			Fields f;
+			int len;
+
+			if (!renderTokens(mp, frame, src->tok, src->tok_cnt, buffer, MACRO_LINE_MAX))
+				return;
+			len = (int)strlen(buffer);
+			if (mp->defining)
+				defineLine(mp, buffer, len);
+			else if (splitFields(buffer, len, &f))
+				beginDefine(mp, buffer, &f);
+		}
+		frame->line = end + 1;
+		return;
+	}
+
+	/* opcode가 macro 이름이면 호출 */
+	if (line->op_cnt > 0) {
+		if (!renderTokens(mp, frame, line->op, line->op_cnt, buffer, MACRO_LINE_MAX))
+			return;
+		macro = (const Macro*)getValue(&mp->namtab, buffer);
+		if (macro != NULL) {
+			char args[MACRO_LINE_MAX];
+
+			if (!renderTokens(mp, frame, line->arg, line->arg_cnt, args, MACRO_LINE_MAX) ||
+				!renderTokens(mp, frame, line->tok, line->tok_cnt, buffer, MACRO_LINE_MAX))
+				return;
+			fprintf(out, ".%s\n", buffer);
+			if (!isspace((unsigned char)buffer[0]) && buffer[0] != 0) {
+				for (i = 0; buffer[i] != 0 && !isspace((unsigned char)buffer[i]); i++);
+				fprintf(out, "%.*s\tEQU\t*\n", i, buffer);
+			}
+			pushFrame(mp, macro, args);
+			return;
+		}
+	}
+
+	writeTokens(mp, frame, line->tok, line->tok_cnt, out);
+	fputc('\n', out);
+}
+
+/*************************************************************************************
+* 설명: token들을 인자를 치환하여 out에 바로 쓴다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - frame: 인자를 갖고 있는 frame
+* - tok, cnt: 쓸 token의 범위
+* - out: 결과를 쓸 파일
+* 반환값: 없음
+*************************************************************************************/
+static void writeTokens(const MacroProcessor* mp, const MacroFrame* frame, int tok, int cnt, FILE* out)
+{
+	int i;
+
+	for (i = tok; i < tok + cnt; i++) {
+		const MacroToken* t = &mp->toks[i];
+
+		if (t->type == MACRO_TOK_TEXT)
+			fwrite(mp->text + t->off, sizeof(char), t->len, out);
+		else if (t->type == MACRO_TOK_PARAM)
+			fwrite(frame->args + frame->arg_off[t->off], sizeof(char), frame->arg_len[t->off], out);
+		else
+			fwrite(frame->uniq, sizeof(char), frame->uniq_len, out);
+	}
+}
+
+/*************************************************************************************
+* 설명: token들을 인자를 치환하여 buf에 '\0'으로 끝나는 문자열로 만든다.
+* 인자:
+* - mp: macro processor에 대한 포인터
+* - frame: 인자를 갖고 있는 frame
+* - tok, cnt: 만들 token의 범위
+* - buf, size: 결과를 저장할 버퍼와 크기
+* 반환값: 성공하면 true(1), 버퍼가 모자라면 false(0)
+*************************************************************************************/
+static int renderTokens(MacroProcessor* mp, const MacroFrame* frame, int tok, int cnt, char* buf, int size)
+{
+	int len = 0;
+	int i;
+
+	for (i = tok; i < tok + cnt; i++) {
+		const MacroToken* t = &mp->toks[i];
+		const char* src;
+		int src_len;
+
+		if (t->type == MACRO_TOK_TEXT) {
+			src = mp->text + t->off;
+			src_len = t->len;
+		}
+		else if (t->type == MACRO_TOK_PARAM) {
+			src = frame->args + frame->arg_off[t->off];
+			src_len = frame->arg_len[t->off];
+		}
+		else {
+			src = frame->uniq;
+			src_len = frame->uniq_len;
+		}
+
+		if (len + src_len >= size) {
+			mp->error = MACRO_ERR_LINE;
+			return false;
+		}
+		memcpy(buf + len, src, src_len);
+		len += src_len;
+	}
+
+	buf[len] = 0;
+	return true;
+}
+
+/*************************************************************************************
+* 설명: IF의 조건식 "(lhs op rhs)"를 계산한다. 괄호는 없어도 된다. lhs와 rhs는
+*       비어있을 수 있고 '...'로 감싸도 된다.
+* 인자:
+* - expr: 인자를 치환한 조건식
+* - result: 결과(참이면 1, 거짓이면 0)를 저장할 곳
+* 반환값: 조건식이 올바르면 true(1), 아니면 false(0)
+*************************************************************************************/
+static int evaluate(const char* expr, int* result)
+{
+	static const char* ops[] = { "EQ", "NE", "LT", "LE", "GT", "GE" };
+	char buffer[MACRO_LINE_MAX];
+	char* start = buffer;
+	char* end;
+	char* lhs;
+	char* rhs = NULL;
+	char* ptr;
+	int op = -1;
+	int cmp;
+	int i;
+
+	strcpy(buffer, expr);
+	end = buffer + strlen(buffer);
+	while (isspace((unsigned char)*start))
+		start++;
+	while (end > start && isspace((unsigned char)end[-1]))
+		*--end = 0;
+	if (*start == '(') {
+		if (end == start || end[-1] != ')')
+			return false;
+		start++;
+		*--end = 0;
+	}
+
+	/* 공백으로 둘러싸인 연산자를 찾는다. lhs가 비어있으면 맨 앞에 올 수도 있다 */
+	for (ptr = start; *ptr != 0 && op < 0; ptr++) {
+		if (ptr != start && !isspace((unsigned char)ptr[-1]))
+			continue;
+		for (i = 0; i < 6; i++) {
+			if (!strncmp(ptr, ops[i], 2) && (ptr[2] == 0 || isspace((unsigned char)ptr[2]))) {
+				op = i;
+				break;
+			}
+		}
+		if (op >= 0) {
+			ptr[0] = 0;
+			rhs = ptr + 2;
+		}
+	}
+	if (op < 0)
+		return false;
+
+	lhs = unquote(start);
+	rhs = unquote(rhs);
+
+	/* 양쪽이 모두 10진수면 숫자로 비교 */
+	{
+		char* lend;
+		char* rend;
+		long l = strtol(lhs, &lend, 10);
+		long r = strtol(rhs, &rend, 10);
+
+		if (*lhs != 0 && *rhs != 0 && *lend == 0 && *rend == 0)
+			cmp = (l > r) - (l < r);
+		else
+			cmp = strcmp(lhs, rhs);
+	}
+
+	switch (op) {
+	case 0: *result = cmp == 0; break;
+	case 1: *result = cmp != 0; break;
+	case 2: *result = cmp < 0; break;
+	case 3: *result = cmp <= 0; break;
+	case 4: *result = cmp > 0; break;
+	default: *result = cmp >= 0; break;
+	}
+	return true;
+}
+
+/*************************************************************************************
+* 설명: 문자열 앞뒤의 공백과, 전체를 감싼 '...'를 제거한다.
+* 인자:
+* - str: 수정할 문자열
+* 반환값: 제거한 결과의 시작 위치
+*************************************************************************************/
+static char* unquote(char* str)
+{
+	char* end;
+
+	while (isspace((unsigned char)*str))
+		str++;
+	end = str + strlen(str);
+	while (end > str && isspace((unsigned char)end[-1]))
+		*--end = 0;
+
+	if (end - str >= 2 && *str == '\'' && end[-1] == '\'') {
+		end[-1] = 0;
+		str++;
+	}
+	return str;
+}
+
+/*************************************************************************************
+* 설명: macro 이름으로 NAMTAB의 bucket을 정한다. (FNV-1a)
+* 인자:
+* - key: macro 이름
+* 반환값: hash 값
+*************************************************************************************/
+static int macroHash(void* key)
+{
+	const unsigned char* str = (const unsigned char*)key;
+	unsigned int hash = 2166136261u;
+
+	while (*str != 0) {
+		hash ^= *str++;
+		hash *= 16777619u;
+	}
+	return (int)(hash % BUCKET_SIZE);
+}
+
+/*************************************************************************************
+* 설명: NAMTAB에서 같은 이름의 macro를 찾기 위한 비교 함수
+* 인자:
+* - a, b: 비교할 macro 이름
+* 반환값: 같으면 0, 다르면 그 이외의 값
+*************************************************************************************/
+static int macroCmp(void* a, void* b)
+{
+	return strcmp((char*)a, (char*)b);
+}
+
+/*************************************************************************************
+* 설명: NAMTAB의 entry 하나를 해제한다. key는 Macro의 name과 같으므로 한 번만 해제한다.
+* 인자:
+* - data: entry
+* - aux: 사용하지 않음
+* 반환값: 없음
+*************************************************************************************/
+static void releaseNamtab(void* data, void* aux)
+{
+	if (data != NULL) {
+		Entry* entry = (Entry*)data;
+		free(entry->key);
+		free(entry->value);
+		free(data);
+	}
+}
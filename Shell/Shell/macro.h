@@ -0,0 +1,157 @@
+﻿#ifndef MACRO_H_
+#define MACRO_H_
+
+#include <stdio.h>
+#include "hash.h"
+
+#ifndef true
+#define true 1
+#endif
+#ifndef false
+#define false 0
+#endif
+
+#define MACRO_LINE_MAX  256
+#define MACRO_PARAM_MAX 16
+#define MACRO_DEPTH_MAX 16
+
+#define MACRO_ERR_NONE    0
+#define MACRO_ERR_MEMORY  1
+#define MACRO_ERR_LINE    2
+#define MACRO_ERR_NAME    3
+#define MACRO_ERR_PARAM   4
+#define MACRO_ERR_NO_MEND 5
+#define MACRO_ERR_MEND    6
+#define MACRO_ERR_COND    7
+#define MACRO_ERR_ARG     8
+#define MACRO_ERR_DEPTH   9
+#define MACRO_ERR_EXPR    10
+
+#define MACRO_TOK_TEXT   0
+#define MACRO_TOK_PARAM  1
+#define MACRO_TOK_UNIQUE 2
+
+#define MACRO_LINE_TEXT  0
+#define MACRO_LINE_IF    1
+#define MACRO_LINE_ELSE  2
+#define MACRO_LINE_ENDIF 3
+#define MACRO_LINE_MACRO 4
+#define MACRO_LINE_MEND  5
+
+/*************************************************************************************
+* 설명: DEFTAB에 저장되는 macro 본문의 token 하나
+* type: MACRO_TOK_TEXT, MACRO_TOK_PARAM, MACRO_TOK_UNIQUE 중 하나
+* off: TEXT이면 text arena에서의 위치, PARAM이면 인자의 번호
+* len: TEXT이면 문자열의 길이
+*************************************************************************************/
+typedef struct {
+	int type;
+	int off;
+	int len;
+} MacroToken;
+
+/*************************************************************************************
+* 설명: DEFTAB에 저장되는 macro 본문의 한 줄. token은 줄의 처음부터 끝까지 공백을
+*       포함하여 나누어져 있으므로 순서대로 출력하면 인자가 치환된 한 줄이 된다.
+* type: MACRO_LINE_* 중 하나
+* tok, tok_cnt: 줄 전체에 해당하는 token의 범위
+* op, op_cnt: opcode field에 해당하는 token의 범위
+* arg, arg_cnt: operand field에 해당하는 token의 범위. IF는 조건식 전체
+* jump: IF는 짝이 되는 ELSE나 ENDIF, ELSE는 ENDIF, MACRO는 MEND의 줄 번호
+*************************************************************************************/
+typedef struct {
+	int type;
+	int tok;
+	int tok_cnt;
+	int op;
+	int op_cnt;
+	int arg;
+	int arg_cnt;
+	int jump;
+} MacroLine;
+
+/*************************************************************************************
+* 설명: NAMTAB에 저장되는 macro 하나에 대한 정보. 인자의 이름과 기본값은 text arena에
+*       '\0'으로 끝나는 문자열로 저장한다.
+* name: macro 이름. NAMTAB entry의 key와 같은 문자열을 가리킨다.
+* param_cnt: 인자의 갯수
+* param: 각 인자의 이름('&' 제외)의 text arena에서의 위치
+* value: 각 인자의 기본값의 위치. 기본값이 없으면 -1
+* line, line_cnt: DEFTAB에서 본문에 해당하는 줄의 범위
+*************************************************************************************/
+typedef struct {
+	char* name;
+	int param_cnt;
+	int param[MACRO_PARAM_MAX];
+	int value[MACRO_PARAM_MAX];
+	int line;
+	int line_cnt;
+} Macro;
+
+/*************************************************************************************
+* 설명: 확장 중인 macro 호출 하나에 대한 정보 (ARGTAB)
+* line, end: 다음에 확장할 줄과 본문의 끝
+* args: 실제 인자들을 모아둔 버퍼
+* arg_off, arg_len: 각 인자의 args에서의 위치와 길이
+* uniq: '$'로 시작하는 label에 붙일, 호출마다 다른 문자열
+*************************************************************************************/
+typedef struct {
+	int line;
+	int end;
+	char args[MACRO_LINE_MAX * 2];
+	int arg_off[MACRO_PARAM_MAX];
+	int arg_len[MACRO_PARAM_MAX];
+	char uniq[8];
+	int uniq_len;
+} MacroFrame;
+
+/*************************************************************************************
+* 설명: 한 번의 입력 처리로 macro 정의와 확장을 모두 수행하는 macro processor.
+*       NAMTAB은 hash table이고, DEFTAB은 줄과 token과 문자열을 각각 연속된 배열
+*       (arena)에 모아둔 것이다. 본문의 인자 참조는 정의할 때 번호로 바꿔두므로
+*       확장할 때는 이름을 찾지 않고 token을 그대로 출력 stream에 쓴다.
+* namtab: macro 이름에서 Macro를 찾는 hash table
+* toks, lines, text: DEFTAB arena와 각각의 사용량, 크기
+* def, def_name: 정의 중인 macro. MEND를 만나면 NAMTAB에 등록한다.
+* defining: macro를 정의하는 중인지 여부
+* level: 정의 중인 본문 안에서 중첩된 MACRO의 깊이
+* nest: 본문 안에서 짝이 맞지 않은 IF/ELSE, 또는 중첩된 MACRO의 줄 번호 stack
+* frames, depth: 확장 중인 macro 호출의 stack
+* expansions: 지금까지 확장한 횟수. '$' label을 만드는데 사용한다.
+* error: MACRO_ERR_* 중 하나
+* line_no: 입력 파일에서 처리 중인 줄 번호
+*************************************************************************************/
+typedef struct {
+	HashTable namtab;
+
+	MacroToken* toks;
+	int tok_cnt;
+	int tok_cap;
+	MacroLine* lines;
+	int line_cnt;
+	int line_cap;
+	char* text;
+	int text_len;
+	int text_cap;
+
+	Macro def;
+	char def_name[MACRO_LINE_MAX];
+	int defining;
+	int level;
+	int nest[MACRO_DEPTH_MAX];
+	int nest_cnt;
+
+	MacroFrame frames[MACRO_DEPTH_MAX];
+	int depth;
+	unsigned int expansions;
+
+	int error;
+	int line_no;
+} MacroProcessor;
+
+/* Macro 관련 함수 */
+extern void initializeMacro(MacroProcessor* mp);
+extern void releaseMacro(MacroProcessor* mp);
+extern int processMacroFile(MacroProcessor* mp, FILE* in, FILE* out);
+
+#endif
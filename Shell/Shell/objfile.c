@@ -0,0 +1,840 @@
+﻿#include "objfile.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define open _open
+#define close _close
+#define read _read
+#define lseek _lseek
+#else
+#include <unistd.h>
+#define O_BINARY 0
+#endif
+
+static int parseText(ObjectFile* obj, FILE* fp);
+static int parseRecord(ObjectFile* obj, const char* line, int len);
+static int parseBinary(ObjectFile* obj);
+static int readAt(int fd, unsigned int offset, void* dst, unsigned int len);
+static int isInFile(long size, unsigned int offset, unsigned int len);
+static int parseHex(const char* str, int digits, unsigned int* value);
+static void copyName(char* dst, const char* src, int len);
+static int addSegment(ObjectFile* obj, unsigned int addr, unsigned int size);
+static int addReloc(ObjectFile* obj, unsigned int reloc);
+static int addSymbol(ObjectFile* obj, const char* name, unsigned int addr);
+static int compareReloc(const void* a, const void* b);
+static unsigned int getWord(const unsigned char* src);
+static void putWord(unsigned char* dst, unsigned int value);
+static unsigned int alignPage(unsigned int offset);
+
+/*************************************************************************************
+* 설명: object를 비어있는 상태로 초기화한다.
+* 인자:
+* - obj: 초기화할 object
+* 반환값: 없음
+*************************************************************************************/
+void initializeObject(ObjectFile* obj)
+{
+	memset(obj, 0, sizeof(ObjectFile));
+	obj->fd = -1;
+}
+
+/*************************************************************************************
+* 설명: object가 사용한 메모리를 해제하고 열려있는 file을 닫는다.
+* 인자:
+* - obj: 해제할 object
+* 반환값: 없음
+*************************************************************************************/
+void releaseObject(ObjectFile* obj)
+{
+	free(obj->segs);
+	free(obj->relocs);
+	free(obj->syms);
+	free(obj->image);
+	if (obj->fd >= 0)
+		close(obj->fd);
+	initializeObject(obj);
+}
+
+/*************************************************************************************
+* 설명: object file을 열어 형식을 확인하고 읽는다. 처음 OBJ_MAGIC_LEN byte가 magic과
+*       같으면 binary 형식으로, 아니면 text 형식으로 읽는다. binary 형식은 file을
+*       열어둔 채로 header와 table만 읽는다.
+* 인자:
+* - obj: initializeObject로 초기화한 object
+* - path: 읽을 file의 경로
+* 반환값: 성공하면 true, 실패하면 false이고 obj->error에 원인이 있다.
+*************************************************************************************/
+int openObjectFile(ObjectFile* obj, const char* path)
+{
+	char magic[OBJ_MAGIC_LEN];
+	FILE* fp;
+	int success;
+
+	obj->fd = open(path, O_RDONLY | O_BINARY);
+	if (obj->fd < 0) {
+		obj->error = OBJ_ERR_IO;
+		return false;
+	}
+
+	if (readAt(obj->fd, 0, magic, OBJ_MAGIC_LEN) && !memcmp(magic, OBJ_MAGIC, OBJ_MAGIC_LEN)) {
+		obj->binary = true;
+		return parseBinary(obj);
+	}
+	close(obj->fd);
+	obj->fd = -1;
+
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		obj->error = OBJ_ERR_IO;
+		return false;
+	}
+	success = parseText(obj, fp);
+	fclose(fp);
+
+	return success;
+}
+
+/*************************************************************************************
+* 설명: binary 형식의 segment 내용을 image로 읽는다. 다른 형식으로 쓸 때에만
+*       필요하며, text 형식이거나 이미 읽었으면 아무 것도 하지 않는다. 읽은 뒤에는
+*       원래의 file을 덮어써도 된다.
+* 인자:
+* - obj: 대상 object
+* 반환값: 성공하면 true, 실패하면 false
+*************************************************************************************/
+int readObjectImage(ObjectFile* obj)
+{
+	int i;
+
+	if (obj->image != NULL)
+		return true;
+
+	obj->image = (char*)calloc(obj->length + 1, sizeof(char));
+	if (obj->image == NULL) {
+		obj->error = OBJ_ERR_MEMORY;
+		return false;
+	}
+
+	for (i = 0; i < obj->seg_cnt; i++) {
+		const ObjectSegment* seg = &obj->segs[i];
+
+		if (!readAt(obj->fd, seg->offset, obj->image + (seg->addr - obj->start), seg->size)) {
+			obj->error = OBJ_ERR_IO;
+			return false;
+		}
+	}
+	return true;
+}
+
+/*************************************************************************************
+* 설명: object program을 progaddr번지부터 메모리에 올리고 relocation한다.
+*       segment마다 memcpy 한 번(text 형식) 또는 read 한 번(binary 형식)으로 메모리에
+*       바로 쓴 뒤, 정렬된 relocation table을 한 번 훑으면서 값을 고친다.
+*       프로그램 전체를 하나의 변경으로 기록하므로 undo할 수 있다.
+* 인자:
+* - obj: openObjectFile로 읽은 object
+* - machine: 대상 machine
+* - progaddr: 프로그램을 올릴 주소
+* 반환값: 성공하면 true, 실패하면 false이고 obj->error에 원인이 있다.
+*************************************************************************************/
+int loadObject(ObjectFile* obj, SicMachine* machine, unsigned int progaddr)
+{
+	unsigned int delta = progaddr - obj->start;
+	unsigned char* dst;
+	int success = true;
+	int i;
+
+	obj->line_no = 0;
+	if (progaddr > MEM_SIZE || obj->length > MEM_SIZE - progaddr) {
+		obj->error = OBJ_ERR_LOAD;
+		return false;
+	}
+
+	dst = (unsigned char*)beginSicWrite(machine, progaddr, obj->length);
+	if (dst == NULL) {
+		obj->error = OBJ_ERR_LOAD;
+		return false;
+	}
+
+	for (i = 0; i < obj->seg_cnt && success; i++) {
+		const ObjectSegment* seg = &obj->segs[i];
+		unsigned int offset = seg->addr - obj->start;
+
+		if (obj->image != NULL)
+			memcpy(dst + offset, obj->image + offset, seg->size);
+		else if (!readAt(obj->fd, seg->offset, dst + offset, seg->size))
+			success = false;
+	}
+
+	/* 5 half-byte이면 첫 byte의 상위 4 bit(format 4의 opcode와 n, i)는 그대로 둔다 */
+	for (i = 0; i < obj->reloc_cnt && success; i++) {
+		unsigned int reloc = obj->relocs[i];
+		unsigned char* p = dst + OBJ_RELOC_OFFSET(reloc);
+		unsigned int mask = OBJ_RELOC_HALF(reloc) == 5 ? 0xFFFFF : 0xFFFFFF;
+		unsigned int value = ((unsigned int)p[0] << 16) | ((unsigned int)p[1] << 8) | p[2];
+
+		value = (value & ~mask) | ((value + delta) & mask);
+		p[0] = (unsigned char)(value >> 16);
+		p[1] = (unsigned char)(value >> 8);
+		p[2] = (unsigned char)value;
+	}
+	endSicWrite(machine);
+
+	if (!success)
+		obj->error = OBJ_ERR_IO;
+	return success;
+}
+
+/*************************************************************************************
+* 설명: object를 text 형식(H/D/T/M/E record)으로 쓴다. T record는 segment마다
+*       OBJ_RECORD_MAX byte씩 나누고, M record는 "+프로그램 이름"을 붙인다.
+* 인자:
+* - obj: openObjectFile로 읽은 object
+* - out: 출력할 file
+* 반환값: 성공하면 true, 실패하면 false이고 obj->error에 원인이 있다.
+*************************************************************************************/
+int writeObjectText(ObjectFile* obj, FILE* out)
+{
+	int i;
+
+	if (!readObjectImage(obj))
+		return false;
+
+	fprintf(out, "H%-6s%06X%06X\n", obj->name, obj->start, obj->length);
+
+	for (i = 0; i < obj->sym_cnt; i++) {
+		fprintf(out, "%s%-6s%06X", i % 6 == 0 ? "D" : "", obj->syms[i].name, obj->syms[i].addr);
+		if (i % 6 == 5 || i == obj->sym_cnt - 1)
+			fputc('\n', out);
+	}
+
+	for (i = 0; i < obj->seg_cnt; i++) {
+		const ObjectSegment* seg = &obj->segs[i];
+		unsigned int done;
+
+		for (done = 0; done < seg->size; done += OBJ_RECORD_MAX) {
+			const unsigned char* data = (unsigned char*)obj->image + (seg->addr - obj->start) + done;
+			unsigned int len = seg->size - done < OBJ_RECORD_MAX ? seg->size - done : OBJ_RECORD_MAX;
+			unsigned int j;
+
+			fprintf(out, "T%06X%02X", seg->addr + done, len);
+			for (j = 0; j < len; j++)
+				fprintf(out, "%02X", data[j]);
+			fputc('\n', out);
+		}
+	}
+
+	for (i = 0; i < obj->reloc_cnt; i++) {
+		unsigned int reloc = obj->relocs[i];
+		fprintf(out, "M%06X%02X+%s\n", obj->start + OBJ_RELOC_OFFSET(reloc), OBJ_RELOC_HALF(reloc), obj->name);
+	}
+
+	fprintf(out, "E%06X\n", obj->entry);
+
+	if (ferror(out)) {
+		obj->error = OBJ_ERR_IO;
+		return false;
+	}
+	return true;
+}
+
+/*************************************************************************************
+* 설명: object를 binary 형식으로 쓴다. header와 table을 먼저 쓰고, segment의 내용은
+*       각각 OBJ_PAGE_SIZE 경계에 맞추어 0으로 채운 뒤에 쓴다. (objfile.h 참고)
+* 인자:
+* - obj: openObjectFile로 읽은 object
+* - out: 출력할 file. "wb"로 열어야 한다.
+* 반환값: 성공하면 true, 실패하면 false이고 obj->error에 원인이 있다.
+*************************************************************************************/
+int writeObjectBinary(ObjectFile* obj, FILE* out)
+{
+	static const char zero[OBJ_PAGE_SIZE];
+	unsigned int reloc_offset = OBJ_HEADER_SIZE + obj->seg_cnt * OBJ_SEGMENT_SIZE;
+	unsigned int sym_offset = reloc_offset + obj->reloc_cnt * OBJ_RELOC_SIZE;
+	unsigned int data_offset = alignPage(sym_offset + obj->sym_cnt * OBJ_SYMBOL_SIZE);
+	unsigned int offset = data_offset;
+	unsigned char* table;
+	unsigned char* p;
+	int i;
+
+	if (!readObjectImage(obj))
+		return false;
+
+	/* header와 table은 첫 segment의 위치까지 0으로 채워서 한 번에 쓴다 */
+	table = (unsigned char*)calloc(data_offset, sizeof(char));
+	if (table == NULL) {
+		obj->error = OBJ_ERR_MEMORY;
+		return false;
+	}
+
+	memcpy(table, OBJ_MAGIC, OBJ_MAGIC_LEN);
+	memcpy(table + 8, obj->name, strlen(obj->name));
+	putWord(table + 16, obj->start);
+	putWord(table + 20, obj->length);
+	putWord(table + 24, obj->entry);
+	putWord(table + 28, obj->seg_cnt);
+	putWord(table + 32, obj->reloc_cnt);
+	putWord(table + 36, obj->sym_cnt);
+	putWord(table + 40, obj->reloc_cnt > 0 ? reloc_offset : 0);
+	putWord(table + 44, obj->sym_cnt > 0 ? sym_offset : 0);
+
+	p = table + OBJ_HEADER_SIZE;
+	for (i = 0; i < obj->seg_cnt; i++, p += OBJ_SEGMENT_SIZE) {
+		obj->segs[i].offset = offset;
+		putWord(p, obj->segs[i].addr);
+		putWord(p + 4, obj->segs[i].size);
+		putWord(p + 8, offset);
+		offset = alignPage(offset + obj->segs[i].size);
+	}
+	for (i = 0; i < obj->reloc_cnt; i++, p += OBJ_RELOC_SIZE)
+		putWord(p, obj->relocs[i]);
+	for (i = 0; i < obj->sym_cnt; i++, p += OBJ_SYMBOL_SIZE) {
+		memcpy(p, obj->syms[i].name, strlen(obj->syms[i].name));
+		putWord(p + 8, obj->syms[i].addr);
+	}
+
+	fwrite(table, sizeof(char), data_offset, out);
+	free(table);
+
+	offset = data_offset;
+	for (i = 0; i < obj->seg_cnt; i++) {
+		const ObjectSegment* seg = &obj->segs[i];
+
+		fwrite(zero, sizeof(char), seg->offset - offset, out);
+		fwrite(obj->image + (seg->addr - obj->start), sizeof(char), seg->size, out);
+		offset = seg->offset + seg->size;
+	}
+
+	if (ferror(out)) {
+		obj->error = OBJ_ERR_IO;
+		return false;
+	}
+	return true;
+}
+
+/*************************************************************************************
+* 설명: text 형식의 object file을 한 줄씩 읽는다. E record를 만나면 그 뒤는 읽지
+*       않는다. 읽은 뒤에 relocation을 주소 순으로 정렬한다.
+* 인자:
+* - obj: 대상 object
+* - fp: 읽을 file
+* 반환값: 성공하면 true, 실패하면 false
+*************************************************************************************/
+static int parseText(ObjectFile* obj, FILE* fp)
+{
+	char line[OBJ_LINE_MAX];
+	int ended = false;
+
+	while (!ended && fgets(line, OBJ_LINE_MAX, fp) != NULL) {
+		int len = (int)strlen(line);
+
+		obj->line_no++;
+		if (len == OBJ_LINE_MAX - 1 && line[len - 1] != '\n' && !feof(fp)) {
+			obj->error = OBJ_ERR_LINE;
+			return false;
+		}
+		while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+			len--;
+		line[len] = 0;
+
+		if (len == 0)
+			continue;
+		if (!parseRecord(obj, line, len))
+			return false;
+		ended = line[0] == 'E';
+	}
+
+	if (obj->image == NULL) {
+		obj->error = OBJ_ERR_HEADER;
+		return false;
+	}
+
+	if (obj->reloc_cnt > 1)
+		qsort(obj->relocs, obj->reloc_cnt, sizeof(unsigned int), compareReloc);
+	return true;
+}
+
+/*************************************************************************************
+* 설명: text 형식의 record 하나를 읽는다. H record는 처음에 한 번만 나와야 하고,
+*       T record의 내용은 image에 쓰고 주소가 이어지면 앞의 segment에 합친다.
+*       M record는 symbol이 없거나 자기 자신의 이름을 더하는 것만 지원한다.
+* 인자:
+* - obj: 대상 object
+* - line, len: 줄바꿈 문자를 뺀 한 줄과 길이
+* 반환값: 성공하면 true, 실패하면 false
+*************************************************************************************/
+static int parseRecord(ObjectFile* obj, const char* line, int len)
+{
+	unsigned int addr;
+	unsigned int size;
+	unsigned int i;
+
+	if (line[0] != 'H' && obj->image == NULL) {
+		obj->error = OBJ_ERR_HEADER;
+		return false;
+	}
+
+	switch (line[0]) {
+	case 'H':
+		if (obj->image != NULL || len < 19 ||
+			!parseHex(line + 7, 6, &obj->start) || !parseHex(line + 13, 6, &obj->length)) {
+			obj->error = OBJ_ERR_HEADER;
+			return false;
+		}
+		if (obj->start > MEM_SIZE || obj->length > MEM_SIZE - obj->start) {
+			obj->error = OBJ_ERR_RANGE;
+			return false;
+		}
+		copyName(obj->name, line + 1, OBJ_NAME_LEN);
+		obj->entry = obj->start;
+		obj->image = (char*)calloc(obj->length + 1, sizeof(char));
+		if (obj->image == NULL) {
+			obj->error = OBJ_ERR_MEMORY;
+			return false;
+		}
+		return true;
+
+	case 'D':
+		if ((len - 1) % 12 != 0) {
+			obj->error = OBJ_ERR_RECORD;
+			return false;
+		}
+		for (i = 1; i < (unsigned int)len; i += 12) {
+			char name[OBJ_NAME_LEN + 1];
+
+			if (!parseHex(line + i + 6, 6, &addr)) {
+				obj->error = OBJ_ERR_RECORD;
+				return false;
+			}
+			if (addr < obj->start || addr - obj->start > obj->length) {
+				obj->error = OBJ_ERR_RANGE;
+				return false;
+			}
+			copyName(name, line + i, OBJ_NAME_LEN);
+			if (!addSymbol(obj, name, addr))
+				return false;
+		}
+		return true;
+
+	case 'R':
+		/* 참조하는 symbol은 M record에서 확인한다 */
+		return true;
+
+	case 'T':
+		if (len < 9 || !parseHex(line + 1, 6, &addr) || !parseHex(line + 7, 2, &size) ||
+			(unsigned int)len < 9 + size * 2) {
+			obj->error = OBJ_ERR_RECORD;
+			return false;
+		}
+		if (addr < obj->start || addr + size > obj->start + obj->length) {
+			obj->error = OBJ_ERR_RANGE;
+			return false;
+		}
+		for (i = 0; i < size; i++) {
+			unsigned int value;
+
+			if (!parseHex(line + 9 + i * 2, 2, &value)) {
+				obj->error = OBJ_ERR_RECORD;
+				return false;
+			}
+			obj->image[addr - obj->start + i] = (char)value;
+		}
+		return size == 0 || addSegment(obj, addr, size);
+
+	case 'M':
+		if (len < 9 || !parseHex(line + 1, 6, &addr) || !parseHex(line + 7, 2, &size) ||
+			(size != 5 && size != 6)) {
+			obj->error = OBJ_ERR_RECORD;
+			return false;
+		}
+		if (len > 9) {
+			char name[OBJ_NAME_LEN + 1];
+
+			copyName(name, line + 10, len - 10 < OBJ_NAME_LEN ? len - 10 : OBJ_NAME_LEN);
+			if (line[9] != '+' || strcmp(name, obj->name)) {
+				obj->error = OBJ_ERR_RELOC;
+				return false;
+			}
+		}
+		if (addr < obj->start || obj->start + obj->length < 3 || addr > obj->start + obj->length - 3) {
+			obj->error = OBJ_ERR_RANGE;
+			return false;
+		}
+		return addReloc(obj, OBJ_RELOC(addr - obj->start, size));
+
+	case 'E':
+		if (len > 1 && (len < 7 || !parseHex(line + 1, 6, &obj->entry))) {
+			obj->error = OBJ_ERR_RECORD;
+			return false;
+		}
+		return true;
+
+	default:
+		obj->error = OBJ_ERR_RECORD;
+		return false;
+	}
+}
+
+/*************************************************************************************
+* 설명: binary 형식의 header와 segment, relocation, symbol table을 읽고 검사한다.
+*       segment의 내용은 읽지 않지만, table과 segment의 내용이 모두 file 안에 있는지
+*       먼저 확인하여 잘린 file은 load하기 전에 거절한다.
+* 인자:
+* - obj: fd가 열려있는 object
+* 반환값: 성공하면 true, 실패하면 false
+*************************************************************************************/
+static int parseBinary(ObjectFile* obj)
+{
+	unsigned char header[OBJ_HEADER_SIZE];
+	unsigned char* table = NULL;
+	unsigned int seg_cnt, reloc_cnt, sym_cnt;
+	unsigned int reloc_offset, sym_offset;
+	unsigned int end = 0;
+	unsigned int i;
+	long size;
+
+	size = (long)lseek(obj->fd, 0, SEEK_END);
+	if (size < 0 || !readAt(obj->fd, 0, header, OBJ_HEADER_SIZE)) {
+		obj->error = OBJ_ERR_HEADER;
+		return false;
+	}
+
+	copyName(obj->name, (char*)header + 8, OBJ_NAME_LEN);
+	obj->start = getWord(header + 16);
+	obj->length = getWord(header + 20);
+	obj->entry = getWord(header + 24);
+	seg_cnt = getWord(header + 28);
+	reloc_cnt = getWord(header + 32);
+	sym_cnt = getWord(header + 36);
+	reloc_offset = getWord(header + 40);
+	sym_offset = getWord(header + 44);
+
+	/* 하나의 프로그램은 메모리보다 클 수 없으므로 수가 이보다 크면 잘못된 file이다 */
+	if (obj->start > MEM_SIZE || obj->length > MEM_SIZE - obj->start ||
+		seg_cnt > MEM_SIZE || reloc_cnt > MEM_SIZE || sym_cnt > MEM_SIZE) {
+		obj->error = OBJ_ERR_HEADER;
+		return false;
+	}
+
+	/* table이 file 밖에 있으면 할당하기 전에 거절한다 */
+	if (!isInFile(size, OBJ_HEADER_SIZE, seg_cnt * OBJ_SEGMENT_SIZE) ||
+		(reloc_cnt > 0 && !isInFile(size, reloc_offset, reloc_cnt * OBJ_RELOC_SIZE)) ||
+		(sym_cnt > 0 && !isInFile(size, sym_offset, sym_cnt * OBJ_SYMBOL_SIZE))) {
+		obj->error = OBJ_ERR_HEADER;
+		return false;
+	}
+
+	obj->segs = (ObjectSegment*)malloc((seg_cnt + 1) * sizeof(ObjectSegment));
+	obj->relocs = (unsigned int*)malloc((reloc_cnt + 1) * sizeof(unsigned int));
+	obj->syms = (ObjectSymbol*)malloc((sym_cnt + 1) * sizeof(ObjectSymbol));
+	table = (unsigned char*)malloc(seg_cnt * OBJ_SEGMENT_SIZE + reloc_cnt * OBJ_RELOC_SIZE +
+		sym_cnt * OBJ_SYMBOL_SIZE + 1);
+	if (obj->segs == NULL || obj->relocs == NULL || obj->syms == NULL || table == NULL) {
+		obj->error = OBJ_ERR_MEMORY;
+		free(table);
+		return false;
+	}
+	obj->seg_cap = seg_cnt + 1;
+	obj->reloc_cap = reloc_cnt + 1;
+	obj->sym_cap = sym_cnt + 1;
+
+	/* segment table */
+	if (!readAt(obj->fd, OBJ_HEADER_SIZE, table, seg_cnt * OBJ_SEGMENT_SIZE)) {
+		obj->error = OBJ_ERR_HEADER;
+		free(table);
+		return false;
+	}
+	for (i = 0; i < seg_cnt; i++) {
+		ObjectSegment* seg = &obj->segs[i];
+		const unsigned char* p = table + i * OBJ_SEGMENT_SIZE;
+
+		seg->addr = getWord(p);
+		seg->size = getWord(p + 4);
+		seg->offset = getWord(p + 8);
+		if (seg->addr < obj->start || seg->addr - obj->start > obj->length ||
+			seg->size > obj->length - (seg->addr - obj->start)) {
+			obj->error = OBJ_ERR_RANGE;
+			free(table);
+			return false;
+		}
+		if (!isInFile(size, seg->offset, seg->size)) {
+			obj->error = OBJ_ERR_HEADER;
+			free(table);
+			return false;
+		}
+	}
+	obj->seg_cnt = seg_cnt;
+
+	/* relocation table, 정렬되어 있어야 한다 */
+	if (reloc_cnt > 0 && !readAt(obj->fd, reloc_offset, table, reloc_cnt * OBJ_RELOC_SIZE)) {
+		obj->error = OBJ_ERR_HEADER;
+		free(table);
+		return false;
+	}
+	for (i = 0; i < reloc_cnt; i++) {
+		unsigned int reloc = getWord(table + i * OBJ_RELOC_SIZE);
+		unsigned int half = OBJ_RELOC_HALF(reloc);
+
+		if ((half != 5 && half != 6) || OBJ_RELOC_OFFSET(reloc) < end) {
+			obj->error = OBJ_ERR_RELOC;
+			free(table);
+			return false;
+		}
+		if (obj->length < 3 || OBJ_RELOC_OFFSET(reloc) > obj->length - 3) {
+			obj->error = OBJ_ERR_RANGE;
+			free(table);
+			return false;
+		}
+		obj->relocs[i] = reloc;
+		end = OBJ_RELOC_OFFSET(reloc);
+	}
+	obj->reloc_cnt = reloc_cnt;
+
+	/* symbol table */
+	if (sym_cnt > 0 && !readAt(obj->fd, sym_offset, table, sym_cnt * OBJ_SYMBOL_SIZE)) {
+		obj->error = OBJ_ERR_HEADER;
+		free(table);
+		return false;
+	}
+	for (i = 0; i < sym_cnt; i++) {
+		const unsigned char* p = table + i * OBJ_SYMBOL_SIZE;
+
+		copyName(obj->syms[i].name, (const char*)p, OBJ_NAME_LEN);
+		obj->syms[i].addr = getWord(p + 8);
+		if (obj->syms[i].addr < obj->start || obj->syms[i].addr - obj->start > obj->length) {
+			obj->error = OBJ_ERR_RANGE;
+			free(table);
+			return false;
+		}
+	}
+	obj->sym_cnt = sym_cnt;
+
+	free(table);
+	return true;
+}
+
+/*************************************************************************************
+* 설명: file의 offset 위치에서 len byte를 dst로 읽는다. 한 번에 다 읽히지 않으면
+*       나머지를 이어서 읽는다.
+* 인자:
+* - fd: 읽을 file
+* - offset: 읽기 시작할 위치
+* - dst, len: 읽은 내용을 쓸 곳과 byte 수
+* 반환값: len byte를 모두 읽으면 true, 아니면 false
+*************************************************************************************/
+static int readAt(int fd, unsigned int offset, void* dst, unsigned int len)
+{
+	char* p = (char*)dst;
+
+	if (lseek(fd, (long)offset, SEEK_SET) < 0)
+		return false;
+
+	while (len > 0) {
+		int done = (int)read(fd, p, len);
+		if (done <= 0)
+			return false;
+		p += done;
+		len -= done;
+	}
+	return true;
+}
+
+/*************************************************************************************
+* 설명: file의 [offset, offset + len) 범위가 크기가 size인 file 안에 있는지 확인한다.
+* 인자:
+* - size: file의 크기
+* - offset, len: 확인할 범위
+* 반환값: 범위가 file 안에 있으면 true, 아니면 false
+*************************************************************************************/
+static int isInFile(long size, unsigned int offset, unsigned int len)
+{
+	return (unsigned long long)offset + len <= (unsigned long long)size;
+}
+
+/*************************************************************************************
+* 설명: 고정된 자리수의 16진수 문자열을 읽는다.
+* 인자:
+* - str: 읽을 문자열
+* - digits: 자리수
+* - value: 읽은 값을 저장할 곳
+* 반환값: digits개가 모두 16진수 문자이면 true, 아니면 false
+*************************************************************************************/
+static int parseHex(const char* str, int digits, unsigned int* value)
+{
+	unsigned int result = 0;
+	int i;
+
+	for (i = 0; i < digits; i++) {
+		char c = str[i];
+
+		if (c >= '0' && c <= '9')
+			result = result * 16 + (c - '0');
+		else if (c >= 'A' && c <= 'F')
+			result = result * 16 + (c - 'A' + 10);
+		else if (c >= 'a' && c <= 'f')
+			result = result * 16 + (c - 'a' + 10);
+		else
+			return false;
+	}
+
+	*value = result;
+	return true;
+}
+
+/*************************************************************************************
+* 설명: 최대 len 글자의 이름을 복사하고 뒤의 공백을 지운다. NUL에서 멈춘다.
+* 인자:
+* - dst: OBJ_NAME_LEN + 1 이상의 공간
+* - src, len: 이름이 있는 곳과 최대 길이
+* 반환값: 없음
+*************************************************************************************/
+static void copyName(char* dst, const char* src, int len)
+{
+	int i;
+
+	for (i = 0; i < len && src[i] != 0; i++)
+		dst[i] = src[i];
+	while (i > 0 && isspace((unsigned char)dst[i - 1]))
+		i--;
+	dst[i] = 0;
+}
+
+/*************************************************************************************
+* 설명: 내용이 있는 구간을 추가한다. 앞의 segment와 주소가 이어지면 합친다.
+* 인자:
+* - obj: 대상 object
+* - addr, size: 구간의 시작 주소와 크기
+* 반환값: 성공하면 true, 메모리가 모자라면 false
+*************************************************************************************/
+static int addSegment(ObjectFile* obj, unsigned int addr, unsigned int size)
+{
+	ObjectSegment* last = obj->seg_cnt > 0 ? &obj->segs[obj->seg_cnt - 1] : NULL;
+
+	if (last != NULL && last->addr + last->size == addr) {
+		last->size += size;
+		return true;
+	}
+
+	if (obj->seg_cnt == obj->seg_cap) {
+		int cap = obj->seg_cap > 0 ? obj->seg_cap * 2 : 16;
+		ObjectSegment* segs = (ObjectSegment*)realloc(obj->segs, cap * sizeof(ObjectSegment));
+		if (segs == NULL) {
+			obj->error = OBJ_ERR_MEMORY;
+			return false;
+		}
+		obj->segs = segs;
+		obj->seg_cap = cap;
+	}
+
+	obj->segs[obj->seg_cnt].addr = addr;
+	obj->segs[obj->seg_cnt].size = size;
+	obj->segs[obj->seg_cnt].offset = 0;
+	obj->seg_cnt++;
+	return true;
+}
+
+/*************************************************************************************
+* 설명: relocation entry를 추가한다.
+* 인자:
+* - obj: 대상 object
+* - reloc: OBJ_RELOC로 만든 entry
+* 반환값: 성공하면 true, 메모리가 모자라면 false
+*************************************************************************************/
+static int addReloc(ObjectFile* obj, unsigned int reloc)
+{
+	if (obj->reloc_cnt == obj->reloc_cap) {
+		int cap = obj->reloc_cap > 0 ? obj->reloc_cap * 2 : 64;
+		unsigned int* relocs = (unsigned int*)realloc(obj->relocs, cap * sizeof(unsigned int));
+		if (relocs == NULL) {
+			obj->error = OBJ_ERR_MEMORY;
+			return false;
+		}
+		obj->relocs = relocs;
+		obj->reloc_cap = cap;
+	}
+
+	obj->relocs[obj->reloc_cnt++] = reloc;
+	return true;
+}
+
+/*************************************************************************************
+* 설명: D record의 symbol을 추가한다.
+* 인자:
+* - obj: 대상 object
+* - name, addr: symbol의 이름과 주소
+* 반환값: 성공하면 true, 메모리가 모자라면 false
+*************************************************************************************/
+static int addSymbol(ObjectFile* obj, const char* name, unsigned int addr)
+{
+	if (obj->sym_cnt == obj->sym_cap) {
+		int cap = obj->sym_cap > 0 ? obj->sym_cap * 2 : 16;
+		ObjectSymbol* syms = (ObjectSymbol*)realloc(obj->syms, cap * sizeof(ObjectSymbol));
+		if (syms == NULL) {
+			obj->error = OBJ_ERR_MEMORY;
+			return false;
+		}
+		obj->syms = syms;
+		obj->sym_cap = cap;
+	}
+
+	strcpy(obj->syms[obj->sym_cnt].name, name);
+	obj->syms[obj->sym_cnt].addr = addr;
+	obj->sym_cnt++;
+	return true;
+}
+
+/*************************************************************************************
+* 설명: relocation entry를 offset 순으로 정렬하기 위한 qsort 비교 함수
+* 인자:
+* - a, b: 비교할 entry
+* 반환값: a가 앞이면 음수, 같으면 0, 뒤면 양수
+*************************************************************************************/
+static int compareReloc(const void* a, const void* b)
+{
+	unsigned int x = OBJ_RELOC_OFFSET(*(const unsigned int*)a);
+	unsigned int y = OBJ_RELOC_OFFSET(*(const unsigned int*)b);
+
+	return x < y ? -1 : x > y;
+}
+
+/*************************************************************************************
+* 설명: little endian 4 byte를 읽는다.
+* 인자:
+* - src: 읽을 곳
+* 반환값: 읽은 값
+*************************************************************************************/
+static unsigned int getWord(const unsigned char* src)
+{
+	return (unsigned int)src[0] | ((unsigned int)src[1] << 8) |
+		((unsigned int)src[2] << 16) | ((unsigned int)src[3] << 24);
+}
+
+/*************************************************************************************
+* 설명: 4 byte를 little endian으로 쓴다.
+* 인자:
+* - dst: 쓸 곳
+* - value: 쓸 값
+* 반환값: 없음
+*************************************************************************************/
+static void putWord(unsigned char* dst, unsigned int value)
+{
+	dst[0] = (unsigned char)value;
+	dst[1] = (unsigned char)(value >> 8);
+	dst[2] = (unsigned char)(value >> 16);
+	dst[3] = (unsigned char)(value >> 24);
+}
+
+/*************************************************************************************
+* 설명: offset을 OBJ_PAGE_SIZE의 배수로 올린다.
+* 인자:
+* - offset: file 안의 위치
+* 반환값: offset 이상인 가장 작은 OBJ_PAGE_SIZE의 배수
+*************************************************************************************/
+static unsigned int alignPage(unsigned int offset)
+{
+	return (offset + OBJ_PAGE_SIZE - 1) & ~(unsigned int)(OBJ_PAGE_SIZE - 1);
+}
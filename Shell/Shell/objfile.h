@@ -0,0 +1,113 @@
+﻿#ifndef OBJFILE_H_
+#define OBJFILE_H_
+
+#include <stdio.h>
+#include "sicsim.h"
+
+#define OBJ_NAME_LEN     6
+#define OBJ_LINE_MAX     256
+#define OBJ_RECORD_MAX   30
+#define OBJ_PAGE_SIZE    0x1000
+
+/* binary 형식의 header, table entry의 크기와 magic */
+#define OBJ_MAGIC        "SICOBJ\0\1"
+#define OBJ_MAGIC_LEN    8
+#define OBJ_HEADER_SIZE  64
+#define OBJ_SEGMENT_SIZE 16
+#define OBJ_RELOC_SIZE   4
+#define OBJ_SYMBOL_SIZE  12
+
+/* relocation entry: 하위 24 bit는 프로그램 시작부터의 offset, 상위 8 bit는 half-byte 수 */
+#define OBJ_RELOC(offset, half) ((unsigned int)(offset) | ((unsigned int)(half) << 24))
+#define OBJ_RELOC_OFFSET(reloc) ((reloc) & 0xFFFFFF)
+#define OBJ_RELOC_HALF(reloc)   ((reloc) >> 24)
+
+#define OBJ_ERR_NONE   0
+#define OBJ_ERR_IO     1
+#define OBJ_ERR_MEMORY 2
+#define OBJ_ERR_LINE   3
+#define OBJ_ERR_RECORD 4
+#define OBJ_ERR_HEADER 5
+#define OBJ_ERR_RANGE  6
+#define OBJ_ERR_RELOC  7
+#define OBJ_ERR_LOAD   8
+
+/*************************************************************************************
+* 설명: object program에서 내용이 연속된 한 구간. text 형식에서는 주소가 이어지는
+*       T record를 하나로 합친 것이다.
+* addr: 구간의 시작 주소 (H record의 시작 주소 기준)
+* size: 구간의 byte 수
+* offset: binary 형식에서 내용이 있는 file 안의 위치. OBJ_PAGE_SIZE의 배수이다.
+*************************************************************************************/
+typedef struct {
+	unsigned int addr;
+	unsigned int size;
+	unsigned int offset;
+} ObjectSegment;
+
+/*************************************************************************************
+* 설명: D record로 정의된 외부 symbol 하나
+* name: symbol 이름
+* addr: symbol의 주소 (H record의 시작 주소 기준). [start, start + length] 안에 있다.
+*************************************************************************************/
+typedef struct {
+	char name[OBJ_NAME_LEN + 1];
+	unsigned int addr;
+} ObjectSymbol;
+
+/*************************************************************************************
+* 설명: control section 하나로 된 object program. 같은 구조체로 두 형식을 모두 다룬다.
+*       text 형식은 H/D/R/T/M/E record를 읽어서 프로그램 전체의 image를 만들어 두고,
+*       binary 형식은 header와 table만 읽고 segment의 내용은 load할 때 file에서
+*       메모리로 바로 읽는다.
+*       binary 형식은 모두 little endian이며 다음과 같이 구성된다.
+*       - header (OBJ_HEADER_SIZE): magic, 이름, 시작 주소, 길이, entry, segment 수,
+*         relocation 수, symbol 수, relocation table 위치, symbol table 위치
+*       - segment table: header 바로 뒤. {addr, size, offset, 0}
+*       - relocation table: 오름차순으로 정렬된 OBJ_RELOC 배열
+*       - symbol table: {이름 8 byte, addr}. 없으면 수와 위치가 0이다.
+*       - segment의 내용: 각각 OBJ_PAGE_SIZE 경계에서 시작한다.
+* name, start, length, entry: H, E record의 내용
+* segs: 내용이 있는 구간들
+* relocs: M record. 오름차순으로 정렬되어 있다.
+* syms: D record
+* image: text 형식에서 읽은 length byte의 프로그램. binary 형식이면 필요할 때 읽는다.
+* fd: binary 형식의 file. text 형식이면 -1
+* binary: binary 형식인지 여부
+* error: OBJ_ERR_* 중 하나
+* line_no: text 형식에서 error가 난 줄 번호. binary 형식이면 0
+*************************************************************************************/
+typedef struct {
+	char name[OBJ_NAME_LEN + 1];
+	unsigned int start;
+	unsigned int length;
+	unsigned int entry;
+
+	ObjectSegment* segs;
+	int seg_cnt;
+	int seg_cap;
+	unsigned int* relocs;
+	int reloc_cnt;
+	int reloc_cap;
+	ObjectSymbol* syms;
+	int sym_cnt;
+	int sym_cap;
+
+	char* image;
+	int fd;
+	int binary;
+
+	int error;
+	int line_no;
+} ObjectFile;
+
+/* ObjectFile 관련 함수 */
+extern void initializeObject(ObjectFile* obj);
+extern void releaseObject(ObjectFile* obj);
+extern int openObjectFile(ObjectFile* obj, const char* path);
+extern int readObjectImage(ObjectFile* obj);
+extern int loadObject(ObjectFile* obj, SicMachine* machine, unsigned int progaddr);
+extern int writeObjectText(ObjectFile* obj, FILE* out);
+extern int writeObjectBinary(ObjectFile* obj, FILE* out);
+
+#endif
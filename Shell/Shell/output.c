@@ -0,0 +1,331 @@
+﻿#include "output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#define write _write
+typedef int Converter;
+#define CONVERTER_NONE 0
+#else
+#include <unistd.h>
+#include <iconv.h>
+typedef iconv_t Converter;
+#define CONVERTER_NONE ((iconv_t)-1)
+#endif
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static size_t convertCp949(Converter* conv, const unsigned char* src, size_t len, char* dst, size_t* used);
+
+/*************************************************************************************
+* 설명: output을 비어있는 상태로 초기화하고 버퍼를 할당한다. 메모리에만 모으는
+*       output이거나 할당에 실패하면 처음 출력할 때 할당한다.
+* 인자:
+* - out: 초기화할 output
+* - fd: 출력할 file descriptor. 음수이면 메모리에만 모은다.
+* 반환값: 없음
+*************************************************************************************/
+void initializeOutput(Output* out, int fd)
+{
+	out->fd = fd;
+	out->len = 0;
+	out->failed = 0;
+	out->buffer = fd >= 0 ? (char*)malloc(OUTPUT_BUFFER_SIZE) : NULL;
+	out->cap = out->buffer != NULL ? OUTPUT_BUFFER_SIZE : 0;
+}
+
+/*************************************************************************************
+* 설명: 남은 내용을 내보내고 버퍼를 해제한다. fd는 닫지 않는다.
+* 인자:
+* - out: 해제할 output
+* 반환값: 없음
+*************************************************************************************/
+void releaseOutput(Output* out)
+{
+	flushOutput(out);
+	free(out->buffer);
+	out->buffer = NULL;
+	out->len = 0;
+	out->cap = 0;
+}
+
+/*************************************************************************************
+* 설명: 버퍼에 모인 내용을 모두 write(2)로 내보낸다. 일부만 쓰이면 나머지를 다시
+*       쓰고, 실패하면 failed를 표시하고 내용을 버린다. 메모리에만 모으는 output은
+*       아무 것도 하지 않는다.
+* 인자:
+* - out: 대상 output
+* 반환값: 성공하면 1, 이전이나 지금 write가 실패했으면 0
+*************************************************************************************/
+int flushOutput(Output* out)
+{
+	size_t done = 0;
+
+	if (out->fd < 0)
+		return 1;
+
+	while (done < out->len && !out->failed) {
+		int len = (int)write(out->fd, out->buffer + done, (unsigned int)(out->len - done));
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len <= 0)
+			out->failed = 1;
+		else
+			done += len;
+	}
+	out->len = 0;
+
+	return !out->failed;
+}
+
+/*************************************************************************************
+* 설명: 버퍼에 모인 내용을 내보내지 않고 버린다.
+* 인자:
+* - out: 대상 output
+* 반환값: 없음
+*************************************************************************************/
+void clearOutput(Output* out)
+{
+	out->len = 0;
+}
+
+/*************************************************************************************
+* 설명: 버퍼에 모인 내용을 버리고, 큰 출력 때문에 OUTPUT_BUFFER_SIZE보다 커진 버퍼는
+*       해제한다. 해제한 버퍼는 다음에 출력할 때 다시 할당한다.
+* 인자:
+* - out: 대상 output
+* 반환값: 없음
+*************************************************************************************/
+void shrinkOutput(Output* out)
+{
+	out->len = 0;
+	if (out->cap > OUTPUT_BUFFER_SIZE) {
+		free(out->buffer);
+		out->buffer = NULL;
+		out->cap = 0;
+	}
+}
+
+/*************************************************************************************
+* 설명: 버퍼의 끝에 len byte 이상의 빈 공간을 확보한다. 공간이 모자라면 먼저
+*       내보내고, 그래도 모자라면 버퍼를 늘린다. 호출한 쪽은 반환된 위치에 직접 쓰고
+*       쓴 만큼 out->len을 늘린다.
+* 인자:
+* - out: 대상 output
+* - len: 필요한 공간의 크기
+* 반환값: 쓸 위치. 버퍼를 늘리지 못하면 NULL
+*************************************************************************************/
+char* reserveOutput(Output* out, size_t len)
+{
+	if (out->cap - out->len < len && out->fd >= 0)
+		flushOutput(out);
+
+	if (out->cap - out->len < len) {
+		size_t cap = out->cap * 2;
+		char* buffer;
+
+		if (cap < out->len + len)
+			cap = out->len + len;
+		if (cap < OUTPUT_BUFFER_SIZE)
+			cap = OUTPUT_BUFFER_SIZE;
+		buffer = (char*)realloc(out->buffer, cap);
+		if (buffer == NULL)
+			return NULL;
+		out->buffer = buffer;
+		out->cap = cap;
+	}
+
+	return out->buffer + out->len;
+}
+
+/*************************************************************************************
+* 설명: data를 버퍼에 덧붙인다. 버퍼보다 큰 내용은 모인 것을 내보낸 뒤 바로 쓴다.
+* 인자:
+* - out: 대상 output
+* - data, len: 덧붙일 내용과 길이
+* 반환값: 없음
+*************************************************************************************/
+void appendOutput(Output* out, const char* data, size_t len)
+{
+	char* dst;
+
+	if (len > out->cap && out->fd >= 0 && flushOutput(out)) {
+		Output direct = { out->fd, (char*)data, len, len, 0 };
+		out->failed = !flushOutput(&direct);
+		return;
+	}
+
+	dst = reserveOutput(out, len);
+	if (dst == NULL)
+		return;
+	memcpy(dst, data, len);
+	out->len += len;
+}
+
+/*************************************************************************************
+* 설명: printf와 같은 형식으로 버퍼에 바로 출력한다.
+* 인자:
+* - out: 대상 output
+* - format, ap: vprintf와 같은 형식 문자열과 인자
+* 반환값: 출력한 byte 수. 실패하면 0
+*************************************************************************************/
+int formatOutput(Output* out, const char* format, va_list ap)
+{
+	va_list copy;
+	char* dst = reserveOutput(out, 256);
+	int len;
+
+	if (dst == NULL)
+		return 0;
+
+	va_copy(copy, ap);
+	len = vsnprintf(dst, out->cap - out->len, format, copy);
+	va_end(copy);
+	if (len < 0)
+		return 0;
+
+	/* 공간이 모자랐으면 충분히 확보한 뒤 다시 출력한다 */
+	if ((size_t)len >= out->cap - out->len) {
+		dst = reserveOutput(out, (size_t)len + 1);
+		if (dst == NULL)
+			return 0;
+		vsnprintf(dst, (size_t)len + 1, format, ap);
+	}
+
+	out->len += len;
+	return len;
+}
+
+/*************************************************************************************
+* 설명: formatOutput을 가변 인자로 호출한다.
+* 인자:
+* - out: 대상 output
+* - format: printf와 같은 형식 문자열
+* 반환값: 출력한 byte 수
+*************************************************************************************/
+int printRawOutput(Output* out, const char* format, ...)
+{
+	va_list ap;
+	int len;
+
+	va_start(ap, format);
+	len = formatOutput(out, format, ap);
+	va_end(ap);
+
+	return len;
+}
+
+/*************************************************************************************
+* 설명: data를 따옴표로 감싼 JSON 문자열로 덧붙인다. 따옴표, backslash, 제어 문자는
+*       escape하고, 출력 문구는 CP949이므로 0x80 이상의 byte로 시작하는 문자는
+*       UTF-8로 바꾸어 쓴다. CP949가 아닌 byte는 U+FFFD로 바꾼다.
+* 인자:
+* - out: 대상 output
+* - data, len: 덧붙일 내용과 길이
+* 반환값: 없음
+*************************************************************************************/
+void appendJsonString(Output* out, const char* data, size_t len)
+{
+	const unsigned char* src = (const unsigned char*)data;
+	Converter conv = CONVERTER_NONE;
+	size_t i = 0;
+
+	appendOutput(out, "\"", 1);
+	while (i < len) {
+		/* byte 하나는 최대 6 byte가 되므로 조금씩 나누어 공간을 확보한다. 마지막
+		   문자가 chunk를 1 byte 넘을 수 있으므로 한 문자만큼 더 확보한다 */
+		size_t end = len - i < 1024 ? len : i + 1024;
+		char* dst = reserveOutput(out, (end - i) * 6 + 6);
+		char* start = dst;
+
+		if (dst == NULL)
+			break;
+
+		while (i < end) {
+			unsigned char c = src[i];
+			size_t used;
+
+			if (c >= 0x80) {
+				dst += convertCp949(&conv, src + i, len - i, dst, &used);
+				i += used;
+				continue;
+			}
+			i++;
+
+			if (c == '"' || c == '\\') {
+				*dst++ = '\\';
+				*dst++ = c;
+			}
+			else if (c == '\n') {
+				*dst++ = '\\';
+				*dst++ = 'n';
+			}
+			else if (c < 0x20 || c == 0x7F) {
+				memcpy(dst, "\\u00", 4);
+				dst[4] = hex_digits[c >> 4];
+				dst[5] = hex_digits[c & 0xF];
+				dst += 6;
+			}
+			else {
+				*dst++ = c;
+			}
+		}
+		out->len += dst - start;
+	}
+	appendOutput(out, "\"", 1);
+
+#ifndef _WIN32
+	if (conv != CONVERTER_NONE)
+		iconv_close(conv);
+#endif
+}
+
+/*************************************************************************************
+* 설명: src의 CP949 문자 하나(2 byte)를 UTF-8로 바꾸어 dst에 쓴다. 뒤의 byte가 없거나
+*       CP949 문자가 아니면 첫 byte만 U+FFFD로 바꾼다. conv는 처음 필요할 때 연다.
+* 인자:
+* - conv: 변환기. 처음에는 CONVERTER_NONE이고 다 쓰면 호출한 쪽에서 닫는다.
+* - src, len: 바꿀 문자의 시작과 남은 byte 수
+* - dst: 4 byte 이상의 공간
+* - used: 바꾼 byte 수(1 또는 2)를 저장할 곳
+* 반환값: dst에 쓴 byte 수
+*************************************************************************************/
+static size_t convertCp949(Converter* conv, const unsigned char* src, size_t len, char* dst, size_t* used)
+{
+#ifdef _WIN32
+	wchar_t wide;
+	int done;
+
+	(void)conv;
+	if (len >= 2 && MultiByteToWideChar(949, MB_ERR_INVALID_CHARS, (const char*)src, 2, &wide, 1) == 1) {
+		done = WideCharToMultiByte(CP_UTF8, 0, &wide, 1, dst, 4, NULL, NULL);
+		if (done > 0) {
+			*used = 2;
+			return (size_t)done;
+		}
+	}
+#else
+	if (*conv == CONVERTER_NONE)
+		*conv = iconv_open("UTF-8", "CP949");
+	if (len >= 2 && *conv != CONVERTER_NONE) {
+		char* in = (char*)src;
+		char* o = dst;
+		size_t in_left = 2;
+		size_t out_left = 4;
+
+		iconv(*conv, NULL, NULL, NULL, NULL);
+		if (iconv(*conv, &in, &in_left, &o, &out_left) != (size_t)-1 && in_left == 0) {
+			*used = 2;
+			return 4 - out_left;
+		}
+	}
+#endif
+
+	*used = 1;
+	memcpy(dst, "\xEF\xBF\xBD", 3);
+	return 3;
+}
@@ -0,0 +1,42 @@
+﻿#ifndef OUTPUT_H_
+#define OUTPUT_H_
+
+#include <stddef.h>
+#include <stdarg.h>
+
+#define OUTPUT_BUFFER_SIZE 0x10000
+
+#define OUTPUT_TEXT 0
+#define OUTPUT_JSON 1
+
+/*************************************************************************************
+* 설명: 명령의 출력을 모아두었다가 write(2)로 한 번에 내보내는 버퍼. stdio를 거치지
+*       않으므로 stream lock이 없고, 버퍼가 차거나 flushOutput을 호출할 때만 쓴다.
+*       fd가 음수이면 내보내지 않고 버퍼를 늘려가며 모으기만 한다.
+* fd: 출력할 file descriptor. 음수이면 메모리에만 모은다.
+* buffer: 출력할 내용을 모아두는 버퍼
+* len: buffer에 모인 byte 수
+* cap: buffer의 크기
+* failed: write가 실패했는지 여부. 실패한 뒤의 출력은 버린다.
+*************************************************************************************/
+typedef struct {
+	int fd;
+	char* buffer;
+	size_t len;
+	size_t cap;
+	int failed;
+} Output;
+
+/* Output 관련 함수 */
+extern void initializeOutput(Output* out, int fd);
+extern void releaseOutput(Output* out);
+extern int flushOutput(Output* out);
+extern void clearOutput(Output* out);
+extern void shrinkOutput(Output* out);
+extern char* reserveOutput(Output* out, size_t len);
+extern void appendOutput(Output* out, const char* data, size_t len);
+extern int formatOutput(Output* out, const char* format, va_list ap);
+extern int printRawOutput(Output* out, const char* format, ...);
+extern void appendJsonString(Output* out, const char* data, size_t len);
+
+#endif
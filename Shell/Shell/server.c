@@ -0,0 +1,696 @@
+﻿#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include "server.h"
+#include "shell.h"
+#include "histogram.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+/*************************************************************************************
+* 설명: server에 접속한 client 하나에 대한 정보를 담는 구조체. 각 session은 자신만의
+*       shell과 가상 메모리를 갖고, opcode table은 server의 base shell과 공유한다.
+*       EPOLLONESHOT으로 등록하므로 한 session은 동시에 하나의 thread만 처리한다.
+*       socket은 non-blocking이고, 명령의 출력은 shell->out에 모아두었다가 보낼 수
+*       있는 만큼만 보낸다. 남은 출력이 있는 동안은 EPOLLOUT을 기다리고 새 명령을
+*       실행하지 않는다.
+* fd: client와 연결된 non-blocking socket
+* shell: client가 사용하는 shell. shell->out은 메모리에만 모은다.
+* vm: pool에서 받아온 가상 메모리. session이 끝나면 pool에 반납한다.
+* buffer: client로부터 받았지만 아직 실행하지 않은 입력
+* length: buffer에 들어있는 입력의 길이
+* sent: shell->out에서 이미 보낸 byte 수
+* prev, next: 접속 중인 session들의 list
+*************************************************************************************/
+typedef struct Session_ {
+	int fd;
+	Shell shell;
+	char* vm;
+	char buffer[LINE_MAX];
+	int length;
+	size_t sent;
+	struct Session_* prev;
+	struct Session_* next;
+} Session;
+
+/*************************************************************************************
+* 설명: worker thread 하나에 대한 정보를 담는 구조체. 명령 처리 시간은 worker마다
+*       따로 기록하고 통계를 출력할 때만 합치므로, 명령마다 server.lock을 잡지 않는다.
+* thread: worker thread
+* lock: latency를 보호하는 mutex. 통계를 출력할 때만 다른 thread가 잡는다.
+* latency: 이 worker가 처리한 명령 하나의 처리 시간(ns)의 histogram
+*************************************************************************************/
+typedef struct {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	Histogram latency;
+} Worker;
+
+/*************************************************************************************
+* 설명: server 전체가 공유하는 정보를 담는 구조체.
+* listen_fd: client의 접속을 받는 unix domain socket
+* epoll_fd: 모든 socket과 eventfd를 감시하는 epoll instance
+* stop_fd: server 종료를 알리는 eventfd
+* report_fd: 통계 출력을 알리는 eventfd
+* base: opcode table을 읽어둔 shell. 모든 session이 opcode table을 공유한다.
+* lock: 아래의 pool, session list, session 수를 보호하는 mutex
+* pool: 0으로 초기화된 채로 재사용을 기다리는 가상 메모리들
+* pool_cnt: pool에 들어있는 가상 메모리의 갯수
+* sessions: 접속 중인 session들의 list
+* active: 접속 중인 session의 수
+* total: 지금까지 접속한 session의 수
+* workers: worker thread들
+* worker_cnt: 실행 중인 worker thread의 수
+*************************************************************************************/
+typedef struct {
+	int listen_fd;
+	int epoll_fd;
+	int stop_fd;
+	int report_fd;
+	Shell base;
+	pthread_mutex_t lock;
+	char* pool[SERVER_POOL_MAX];
+	int pool_cnt;
+	Session* sessions;
+	int active;
+	unsigned long long total;
+	Worker workers[SERVER_THREAD_MAX];
+	int worker_cnt;
+} Server;
+
+static Server server;
+
+static int openListener(const char* path);
+static void* runWorker(void* aux);
+static void acceptSessions(void);
+static void openSession(int fd);
+static void serveSession(Worker* worker, Session* session);
+static int runLines(Worker* worker, Session* session);
+static int sendOutput(Session* session);
+static void closeSession(Session* session);
+static void watchFd(int fd, void* ptr, unsigned int events, int op);
+static void releaseServer(const char* path);
+static char* acquireVm(void);
+static void releaseVm(char* vm);
+static void reportServer(void);
+static void handleSignal(int signo);
+
+/*************************************************************************************
+* 설명: path에 unix domain socket을 열고 여러 client의 접속을 받아 각각 독립된 shell
+*       session으로 처리한다. 소수의 worker thread가 하나의 epoll instance를 함께
+*       기다리면서 입력이 들어온 session의 명령을 줄 단위로 실행한다.
+*       client와 주고받는 내용은 interactive mode와 같다. 명령은 한 줄씩 보내고,
+*       실행 결과 뒤에는 다음 명령을 기다리는 "sicsim>" prompt가 온다.
+*       SIGUSR1을 받으면 session 수와 명령 처리 시간의 p50/p99를 stderr에 출력하고,
+*       SIGINT나 SIGTERM을 받으면 모든 session을 닫고 종료한다.
+*       시작하다가 실패하면 그때까지 만든 자원을 releaseServer로 모두 해제한다.
+* 인자:
+* - path: socket 파일의 경로
+* 반환값: 프로세스의 종료 코드. 정상 종료면 0
+*************************************************************************************/
+int startServer(const char* path)
+{
+	struct sigaction action;
+	int thread_cnt;
+	long cpu_cnt;
+	int i;
+
+	pthread_mutex_init(&server.lock, NULL);
+	server.listen_fd = -1;
+	server.epoll_fd = -1;
+	server.stop_fd = -1;
+	server.report_fd = -1;
+	server.pool_cnt = 0;
+	server.sessions = NULL;
+	server.active = 0;
+	server.total = 0;
+	server.worker_cnt = 0;
+
+	/* opcode table은 한 번만 읽어서 모든 session이 공유 */
+	initializeShell(&server.base);
+	if (!server.base.init) {
+		releaseServer(NULL);
+		return 1;
+	}
+
+	server.listen_fd = openListener(path);
+	server.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	server.stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	server.report_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (server.listen_fd < 0 || server.epoll_fd < 0 || server.stop_fd < 0 || server.report_fd < 0) {
+		fprintf(stderr, "sicsim: server를 시작할 수 없습니다: %s\n", strerror(errno));
+		releaseServer(server.listen_fd >= 0 ? path : NULL);
+		return 1;
+	}
+
+	/* stop_fd는 읽지 않고 남겨두어 모든 worker가 종료를 알 수 있게 한다 */
+	{
+		struct epoll_event event;
+		event.events = EPOLLIN;
+		event.data.ptr = &server.stop_fd;
+		epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.stop_fd, &event);
+	}
+	watchFd(server.listen_fd, &server.listen_fd, EPOLLIN, EPOLL_CTL_ADD);
+	watchFd(server.report_fd, &server.report_fd, EPOLLIN, EPOLL_CTL_ADD);
+
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = handleSignal;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+	sigaction(SIGUSR1, &action, NULL);
+	action.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &action, NULL);
+
+	/* worker thread의 수는 CPU 수만큼, 최대 SERVER_THREAD_MAX개 */
+	cpu_cnt = sysconf(_SC_NPROCESSORS_ONLN);
+	thread_cnt = cpu_cnt < 1 ? 1 : cpu_cnt > SERVER_THREAD_MAX ? SERVER_THREAD_MAX : (int)cpu_cnt;
+
+	/* 처음 접속하는 client들이 기다리지 않도록 가상 메모리를 미리 만들어 둔다 */
+	for (i = 0; i < thread_cnt; i++) {
+		char* vm = (char*)calloc(MEM_SIZE, sizeof(char));
+		if (vm != NULL)
+			releaseVm(vm);
+	}
+
+	for (i = 0; i < thread_cnt; i++) {
+		Worker* worker = &server.workers[server.worker_cnt];
+
+		pthread_mutex_init(&worker->lock, NULL);
+		initializeHistogram(&worker->latency);
+		if (pthread_create(&worker->thread, NULL, runWorker, worker) != 0) {
+			pthread_mutex_destroy(&worker->lock);
+			break;
+		}
+		server.worker_cnt++;
+	}
+	if (server.worker_cnt == 0) {
+		fprintf(stderr, "sicsim: worker thread를 만들 수 없습니다.\n");
+		releaseServer(path);
+		return 1;
+	}
+
+	fprintf(stderr, "sicsim: %s 에서 접속을 기다립니다. (worker %d개)\n", path, server.worker_cnt);
+
+	for (i = 0; i < server.worker_cnt; i++)
+		pthread_join(server.workers[i].thread, NULL);
+
+	/* 남아있는 session을 모두 닫고 자원을 해제 */
+	while (server.sessions != NULL)
+		closeSession(server.sessions);
+	reportServer();
+	releaseServer(path);
+
+	return 0;
+}
+
+/*************************************************************************************
+* 설명: startServer에서 만든 자원을 모두 해제한다. 열지 못한 fd는 -1이므로 건너뛰고,
+*       worker thread는 이미 끝났다고 가정한다. 시작하다 실패했을 때와 정상 종료할
+*       때 모두 이 함수를 거친다.
+* 인자:
+* - path: 지울 socket 파일의 경로. 만들지 않았으면 NULL
+* 반환값: 없음
+*************************************************************************************/
+static void releaseServer(const char* path)
+{
+	int i;
+
+	if (server.listen_fd >= 0)
+		close(server.listen_fd);
+	if (server.epoll_fd >= 0)
+		close(server.epoll_fd);
+	if (server.stop_fd >= 0)
+		close(server.stop_fd);
+	if (server.report_fd >= 0)
+		close(server.report_fd);
+	if (path != NULL)
+		unlink(path);
+
+	for (i = 0; i < server.worker_cnt; i++)
+		pthread_mutex_destroy(&server.workers[i].lock);
+	for (i = 0; i < server.pool_cnt; i++)
+		free(server.pool[i]);
+	server.worker_cnt = 0;
+	server.pool_cnt = 0;
+	pthread_mutex_destroy(&server.lock);
+	releaseShell(&server.base);
+}
+
+/*************************************************************************************
+* 설명: path에 non-blocking unix domain socket을 만들고 접속을 기다리게 한다.
+*       이전에 비정상 종료하여 남아있는 socket 파일은 지우고 새로 만든다.
+* 인자:
+* - path: socket 파일의 경로
+* 반환값: 접속을 기다리는 socket, 실패하면 -1
+*************************************************************************************/
+static int openListener(const char* path)
+{
+	struct sockaddr_un addr;
+	int fd;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -1;
+
+	unlink(path);
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, SERVER_BACKLOG) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+/*************************************************************************************
+* 설명: worker thread의 main 함수. epoll instance에서 event를 받아서 종류에 따라
+*       접속 처리, 통계 출력, session의 명령 처리를 수행한다. stop_fd에 event가
+*       오면 종료한다.
+* 인자:
+* - aux: 이 thread의 Worker
+* 반환값: 없음 (NULL)
+*************************************************************************************/
+static void* runWorker(void* aux)
+{
+	struct epoll_event events[SERVER_EVENT_MAX];
+	Worker* worker = (Worker*)aux;
+	int cnt;
+	int i;
+
+	for (;;) {
+		cnt = epoll_wait(server.epoll_fd, events, SERVER_EVENT_MAX, -1);
+		if (cnt < 0) {
+			if (errno == EINTR)
+				continue;
+			return NULL;
+		}
+
+		for (i = 0; i < cnt; i++) {
+			void* ptr = events[i].data.ptr;
+
+			if (ptr == &server.stop_fd) {
+				return NULL;
+			}
+			else if (ptr == &server.listen_fd) {
+				acceptSessions();
+			}
+			else if (ptr == &server.report_fd) {
+				unsigned long long value;
+				if (read(server.report_fd, &value, sizeof(value)) == sizeof(value))
+					reportServer();
+				watchFd(server.report_fd, &server.report_fd, EPOLLIN, EPOLL_CTL_MOD);
+			}
+			else {
+				serveSession(worker, (Session*)ptr);
+			}
+		}
+	}
+}
+
+/*************************************************************************************
+* 설명: 대기 중인 접속을 모두 받아서 session을 만든다.
+* 인자: 없음
+* 반환값: 없음
+*************************************************************************************/
+static void acceptSessions(void)
+{
+	int fd;
+
+	for (;;) {
+		fd = accept4(server.listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		openSession(fd);
+	}
+
+	watchFd(server.listen_fd, &server.listen_fd, EPOLLIN, EPOLL_CTL_MOD);
+}
+
+/*************************************************************************************
+* 설명: 접속한 client에 대한 session을 만든다. pool에서 가상 메모리를 받아 shell을
+*       초기화하고, 첫 prompt를 보낸 뒤 입력을 기다리도록 epoll에 등록한다.
+*       prompt를 다 보내지 못했으면 입력 대신 EPOLLOUT을 기다린다.
+* 인자:
+* - fd: client와 연결된 non-blocking socket
+* 반환값: 없음
+*************************************************************************************/
+static void openSession(int fd)
+{
+	Session* session = (Session*)malloc(sizeof(Session));
+	char* vm = acquireVm();
+
+	if (session == NULL || vm == NULL) {
+		if (vm != NULL)
+			releaseVm(vm);
+		free(session);
+		close(fd);
+		return;
+	}
+
+	/* 출력은 메모리에 모았다가 sendOutput으로 보낸다 */
+	initializeSession(&session->shell, &server.base, vm);
+	session->shell.out.fd = -1;
+	session->fd = fd;
+	session->vm = vm;
+	session->length = 0;
+	session->sent = 0;
+
+	pthread_mutex_lock(&server.lock);
+	session->prev = NULL;
+	session->next = server.sessions;
+	if (server.sessions != NULL)
+		server.sessions->prev = session;
+	server.sessions = session;
+	server.active++;
+	server.total++;
+	pthread_mutex_unlock(&server.lock);
+
+	appendOutput(&session->shell.out, SHELL_PROMPT, strlen(SHELL_PROMPT));
+	if (!sendOutput(session)) {
+		closeSession(session);
+		return;
+	}
+
+	watchFd(fd, session, session->shell.out.len > 0 ? EPOLLOUT : EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD);
+}
+
+/*************************************************************************************
+* 설명: session의 event를 처리한다. 보내지 못한 출력이 있으면 먼저 보내고, 다 보낼
+*       때까지는 새 입력을 읽지도 명령을 실행하지도 않는다. 출력을 다 보냈으면 입력을
+*       읽어서 완성된 줄을 실행하고 그 출력을 보낸다. 그래도 남은 출력이 있으면
+*       EPOLLOUT을, 없으면 다음 입력을 기다리도록 다시 등록한다. 명령을 읽지 않는
+*       client가 있어도 worker는 기다리지 않는다.
+*       client가 연결을 끊거나 quit을 실행하면 session을 닫는다.
+* 인자:
+* - worker: 이 session을 처리하는 worker
+* - session: event가 온 session
+* 반환값: 없음
+*************************************************************************************/
+static void serveSession(Worker* worker, Session* session)
+{
+	Shell* shell = &session->shell;
+	ssize_t len;
+	int more;
+
+	if (!sendOutput(session)) {
+		closeSession(session);
+		return;
+	}
+
+	if (shell->out.len == 0) {
+		/* 실행할 줄이 남아있지 않을 때만 새 입력을 읽는다 */
+		if (!shell->quit && session->length < LINE_MAX - 1
+			&& memchr(session->buffer, '\n', session->length) == NULL) {
+			len = recv(session->fd, session->buffer + session->length, LINE_MAX - 1 - session->length, 0);
+			if (len == 0 || (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+				closeSession(session);
+				return;
+			}
+			if (len > 0)
+				session->length += (int)len;
+		}
+
+		/* 출력이 너무 쌓이면 나머지 줄은 그것을 다 보낸 뒤에 실행한다 */
+		do {
+			more = runLines(worker, session);
+			if (!sendOutput(session)) {
+				closeSession(session);
+				return;
+			}
+		} while (more && shell->out.len == 0);
+	}
+
+	if (shell->out.len > 0) {
+		watchFd(session->fd, session, EPOLLOUT, EPOLL_CTL_MOD);
+		return;
+	}
+	if (shell->quit) {
+		closeSession(session);
+		return;
+	}
+
+	watchFd(session->fd, session, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_MOD);
+}
+
+/*************************************************************************************
+* 설명: session의 buffer에 있는 완성된 줄마다 명령을 실행하고, 줄바꿈을 받지 못한
+*       나머지는 다음 입력을 위해 남겨둔다. 입력이 LINE_MAX를 넘도록 줄바꿈이
+*       없으면 interactive mode의 fgets처럼 잘라서 실행한다. 모아둔 출력이
+*       SERVER_OUTPUT_MAX를 넘으면 남은 줄을 실행하지 않고 멈춘다.
+*       명령의 처리 시간은 worker의 histogram에 기록한다.
+* 인자:
+* - worker: 이 session을 처리하는 worker
+* - session: 명령을 실행할 session
+* 반환값: 출력이 쌓여서 멈추었으면 1, 실행할 줄이 더 없으면 0
+*************************************************************************************/
+static int runLines(Worker* worker, Session* session)
+{
+	Shell* shell = &session->shell;
+	char* start = session->buffer;
+	char* limit = session->buffer + session->length;
+	char* end;
+	char* next;
+	int more = 0;
+
+	session->buffer[session->length] = 0;
+	while (!shell->quit && start < limit) {
+		unsigned long long begin;
+		unsigned long long elapsed;
+
+		if (shell->out.len >= SERVER_OUTPUT_MAX) {
+			more = 1;
+			break;
+		}
+
+		end = (char*)memchr(start, '\n', limit - start);
+		if (end != NULL) {
+			*end = 0;
+			next = end + 1;
+		}
+		else if (start == session->buffer && session->length == LINE_MAX - 1) {
+			next = limit;
+		}
+		else {
+			break;
+		}
+
+		begin = getTimeNs();
+		runCommandLine(shell, start);
+		elapsed = getTimeNs() - begin;
+
+		pthread_mutex_lock(&worker->lock);
+		recordHistogram(&worker->latency, elapsed);
+		pthread_mutex_unlock(&worker->lock);
+
+		if (!shell->quit)
+			appendOutput(&shell->out, SHELL_PROMPT, strlen(SHELL_PROMPT));
+		start = next;
+	}
+
+	/* 아직 실행하지 않은 입력은 버퍼의 앞으로 옮겨둔다 */
+	session->length = (int)(limit - start);
+	memmove(session->buffer, start, session->length);
+
+	return more;
+}
+
+/*************************************************************************************
+* 설명: session에 모아둔 출력을 socket이 받을 수 있는 만큼 보낸다. 다 보내면 출력을
+*       비우고, 큰 출력으로 늘어난 버퍼는 해제한다.
+* 인자:
+* - session: 대상 session
+* 반환값: 연결이 살아있으면 1, 보내다가 실패하면 0
+*************************************************************************************/
+static int sendOutput(Session* session)
+{
+	Output* out = &session->shell.out;
+	ssize_t len;
+
+	while (session->sent < out->len) {
+		len = send(session->fd, out->buffer + session->sent, out->len - session->sent, MSG_NOSIGNAL);
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return 1;
+		if (len <= 0)
+			return 0;
+		session->sent += len;
+	}
+
+	session->sent = 0;
+	shrinkOutput(out);
+	return 1;
+}
+
+/*************************************************************************************
+* 설명: session을 닫는다. socket을 닫고, 가상 메모리를 pool에 반납하고, 메모리를
+*       해제한다.
+* 인자:
+* - session: 닫을 session
+* 반환값: 없음
+*************************************************************************************/
+static void closeSession(Session* session)
+{
+	epoll_ctl(server.epoll_fd, EPOLL_CTL_DEL, session->fd, NULL);
+
+	pthread_mutex_lock(&server.lock);
+	if (session->prev != NULL)
+		session->prev->next = session->next;
+	else
+		server.sessions = session->next;
+	if (session->next != NULL)
+		session->next->prev = session->prev;
+	server.active--;
+	pthread_mutex_unlock(&server.lock);
+
+	releaseShell(&session->shell);
+	close(session->fd);
+	releaseVm(session->vm);
+	free(session);
+}
+
+/*************************************************************************************
+* 설명: fd를 한 번의 event만 알려주도록(EPOLLONESHOT) epoll에 등록하거나 다시 등록한다.
+* 인자:
+* - fd: 감시할 file descriptor
+* - ptr: event가 왔을 때 함께 받을 포인터
+* - events: 기다릴 event. EPOLLIN, EPOLLOUT 등
+* - op: EPOLL_CTL_ADD 혹은 EPOLL_CTL_MOD
+* 반환값: 없음
+*************************************************************************************/
+static void watchFd(int fd, void* ptr, unsigned int events, int op)
+{
+	struct epoll_event event;
+
+	event.events = events | EPOLLONESHOT;
+	event.data.ptr = ptr;
+	epoll_ctl(server.epoll_fd, op, fd, &event);
+}
+
+/*************************************************************************************
+* 설명: pool에서 0으로 초기화된 가상 메모리를 하나 꺼낸다. pool이 비어있으면 새로
+*       할당한다.
+* 인자: 없음
+* 반환값: 0으로 초기화된 MEM_SIZE 크기의 가상 메모리, 할당에 실패하면 NULL
+*************************************************************************************/
+static char* acquireVm(void)
+{
+	char* vm = NULL;
+
+	pthread_mutex_lock(&server.lock);
+	if (server.pool_cnt > 0)
+		vm = server.pool[--server.pool_cnt];
+	pthread_mutex_unlock(&server.lock);
+
+	if (vm == NULL)
+		vm = (char*)calloc(MEM_SIZE, sizeof(char));
+
+	return vm;
+}
+
+/*************************************************************************************
+* 설명: 다 쓴 가상 메모리를 0으로 초기화하여 pool에 반납한다. 초기화는 session을
+*       닫을 때 하므로 새 session은 기다리지 않고 바로 가상 메모리를 받는다.
+*       pool이 가득 차 있으면 해제한다.
+* 인자:
+* - vm: 반납할 가상 메모리
+* 반환값: 없음
+*************************************************************************************/
+static void releaseVm(char* vm)
+{
+	memset(vm, 0, sizeof(char) * MEM_SIZE);
+
+	pthread_mutex_lock(&server.lock);
+	if (server.pool_cnt < SERVER_POOL_MAX) {
+		server.pool[server.pool_cnt++] = vm;
+		vm = NULL;
+	}
+	pthread_mutex_unlock(&server.lock);
+
+	free(vm);
+}
+
+/*************************************************************************************
+* 설명: 현재 session 수와 지금까지 처리한 명령의 처리 시간 p50/p99를 stderr에 출력한다.
+*       처리 시간은 worker마다 나누어 기록한 histogram을 여기서 합친다.
+* 인자: 없음
+* 반환값: 없음
+*************************************************************************************/
+static void reportServer(void)
+{
+	Histogram latency;
+	int active;
+	unsigned long long total;
+	int i;
+
+	initializeHistogram(&latency);
+	for (i = 0; i < server.worker_cnt; i++) {
+		pthread_mutex_lock(&server.workers[i].lock);
+		mergeHistogram(&latency, &server.workers[i].latency);
+		pthread_mutex_unlock(&server.workers[i].lock);
+	}
+
+	pthread_mutex_lock(&server.lock);
+	active = server.active;
+	total = server.total;
+	pthread_mutex_unlock(&server.lock);
+
+	fprintf(stderr, "sicsim: session %d개 접속 중 (누적 %llu개), 명령 %llu개, p50 %.1fus, p99 %.1fus\n",
+		active, total, latency.count,
+		getPercentile(&latency, 50.0) / 1000.0,
+		getPercentile(&latency, 99.0) / 1000.0);
+}
+
+/*************************************************************************************
+* 설명: signal handler. 직접 처리하지 않고 eventfd에 써서 worker thread에 알린다.
+* 인자:
+* - signo: 받은 signal
+* 반환값: 없음
+*************************************************************************************/
+static void handleSignal(int signo)
+{
+	unsigned long long one = 1;
+	int fd = signo == SIGUSR1 ? server.report_fd : server.stop_fd;
+
+	if (write(fd, &one, sizeof(one)) < 0)
+		return;
+}
+
+#else
+
+/*************************************************************************************
+* 설명: server mode는 epoll을 사용하므로 Linux에서만 지원한다.
+* 인자:
+* - path: socket 파일의 경로
+* 반환값: 프로세스의 종료 코드
+*************************************************************************************/
+int startServer(const char* path)
+{
+	fprintf(stderr, "sicsim: server mode는 Linux에서만 지원합니다. (%s)\n", path);
+	return 1;
+}
+
+#endif
@@ -0,0 +1,13 @@
+﻿#ifndef SERVER_H_
+#define SERVER_H_
+
+#define SERVER_BACKLOG    128
+#define SERVER_THREAD_MAX 8
+#define SERVER_EVENT_MAX  16
+#define SERVER_POOL_MAX   64
+#define SERVER_OUTPUT_MAX 0x10000
+
+/* Server 관련 함수 */
+extern int startServer(const char* path);
+
+#endif
@@ -1,35 +1,53 @@
 #include "shell.h"
+#include "disasm.h"
+#include "stats.h"
+#include "alloccount.h"
+#include "macro.h"
+#include "objfile.h"
+#include "device.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <ctype.h>
 #include <dirent.h>
 #include <sys/stat.h>
 
-#define strdup _strdup
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 
-/* Command  Լ */
-void runCmdHelp(Shell* shell);
-void runCmdDir(Shell* shell);
-void runCmdQuit(Shell* shell);
-void runCmdHistory(Shell* shell);
-void runCmdDump(Shell* shell);
-void runCmdEdit(Shell* shell);
-void runCmdFill(Shell* shell);
-void runCmdReset(Shell* shell);
-void runCmdOpcode(Shell* shell);
-void runCmdOplist(Shell* shell);
-void runCommand(Shell* shell);
-
-static void printError(int err_code);
-static void parseOpcode(Shell* shell);
-static void parseCommandLine(Shell* shell);
+#ifdef _MSC_VER
+#define strdup _strdup
+#endif
+
+#define DUMP_LINE_LEN (6 + MEM_LINE * 3 + 2 + MEM_LINE + 1)
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+static void initializeState(Shell* shell);
+static void printOutput(Shell* shell, const char* format, ...);
+static void printField(Shell* shell, const char* format, ...);
+static Output* getOutput(Shell* shell);
+static void printError(Shell* shell, int err_code);
+static const char* getErrorName(int err_code);
+static const char* getMacroErrorMessage(int error);
+static const char* getObjectErrorMessage(int error);
+static void beginRecord(Shell* shell);
+static void endRecord(Shell* shell);
+static int formatDumpLine(char* dst, const char* data, int base, int start_addr, int end_addr);
+static const char* getMemory(Shell* shell, int addr, int len, char** copy);
+static int parsePageRange(Shell* shell, unsigned int* addr, unsigned int* len);
+static int parseBlockRange(Shell* shell, int* addr0, int* addr1, int* len);
+static int parsePattern(const char* arg, unsigned char* pattern);
+static int findDifference(const char* data0, const char* data1, int pos, int len);
 static char* trim(char* start, char* end);
-static int getCommandCode(char* cmd);
-static int hashFunc(void* key);
-static int hashCmp(void* a, void* b);
 static void releaseHistory(void* data, void* aux);
-static void releaseOplist(void* data, void* aux);
+static void releaseMapping(Shell* shell);
+static void printObjectError(Shell* shell, const char* path, const ObjectFile* obj);
+static char* readTextFile(const char* path, size_t* len);
 
 /*************************************************************************************
 * : Shell ü  ʱȭ Ѵ.  ,   
@@ -41,43 +59,18 @@ static void releaseOplist(void* data, void* aux);
 *************************************************************************************/
 void initializeShell(Shell* shell)
 {
-	int i;
-
-	/* init variables */
-	shell->cmd_code = CMD_INVALID;
-	shell->argc = 0;
-	shell->quit = false;
-	shell->mem_addr = 0;
-	shell->error = ERR_NONE;
+	initializeState(shell);
+#ifdef SHELL_STATS
+	shell->stats = createStats();
+#endif
 
-	/* init virtual memory */
-	for (i = 0; i < ARG_CNT_MAX; i++) {
-		memset(shell->args[i], 0, sizeof(char) * ARG_LEN_MAX);
-	}
-	shell->vm = (char*)malloc(sizeof(char) * MEM_SIZE);
-	if (shell->vm == NULL) {
+	/* init virtual memory, opcode table */
+	if (initializeSicMachine(&shell->machine) != SIC_OK) {
 		shell->error = ERR_INIT;
+		shell->init = false;
+		printError(shell, shell->error);
 		return;
 	}
-	memset(shell->vm, 0, sizeof(char) * MEM_SIZE);
-
-
-	/* init list & hash table*/
-	initializeList(&shell->history);
-	initializeHash(&shell->op_table, hashFunc, hashCmp);
-
-
-	/* command function mapping */
-	shell->cmds[CMD_HELP] = runCmdHelp;
-	shell->cmds[CMD_DIR] = runCmdDir;
-	shell->cmds[CMD_QUIT] = runCmdQuit;
-	shell->cmds[CMD_HISTORY] = runCmdHistory;
-	shell->cmds[CMD_DUMP] = runCmdDump;
-	shell->cmds[CMD_EDIT] = runCmdEdit;
-	shell->cmds[CMD_FILL] = runCmdFill;
-	shell->cmds[CMD_RESET] = runCmdReset;
-	shell->cmds[CMD_OPCODE] = runCmdOpcode;
-	shell->cmds[CMD_OPLIST] = runCmdOplist;
 
 	/* opcode    */
 	parseOpcode(shell);
@@ -85,40 +78,90 @@ void initializeShell(Shell* shell)
 	/* ʱȭ      ʱȭ  */
 	if (shell->error != ERR_NONE) {
 		shell->init = false;
-		printError(shell->error);
+		printError(shell, shell->error);
 	}
 	else {
 		shell->init = true;
 	}
 }
 
+/*************************************************************************************
+* : ̹ ʱȭ base shell opcode table ϴ ο session ʱȭѴ.
+*       opcode.txt ٽ  ʰ,  ޸𸮴 ȣڰ 0 ä Ѱش.
+*       vm op_table ȣ ̹Ƿ releaseShell  ʴ´.
+*       server  ó ð  Ƿ session ɺ 踦  ʴ´.
+* :
+* - shell: ʱȭ session  ü  
+* - base: initializeShell ʱȭ  shell  
+* - vm: session , 0 ʱȭ MEM_SIZE ũ  ޸
+* ȯ: 
+*************************************************************************************/
+void initializeSession(Shell* shell, const Shell* base, char* vm)
+{
+	initializeState(shell);
+	initializeSicSession(&shell->machine, &base->machine, vm);
+	shell->init = base->init;
+}
+
 /*************************************************************************************
 * :  鼭 ڷκ  Է¹ް Ľϰ ϴ  ݺѴ.
-ڰ quit     ݺѴ.
+ڰ quit  ų Է    ݺѴ.
 * :
 * - shell: shell    ִ ü  
 * ȯ: 
 *************************************************************************************/
 void startShell(Shell* shell)
 {
-	while (!shell->quit) {
-		printf("sicsim>");
+	char buffer[LINE_MAX];
 
-		/* ڷκ Է ޾Ƽ ɰ  ڵ Ľ */
-		parseCommandLine(shell);
+	while (!shell->quit) {
+		if (shell->format == OUTPUT_TEXT)
+			printOutput(shell, SHELL_PROMPT);
 
-		/* error  command  */
-		if (shell->error == ERR_NONE)
-			runCommand(shell);
+		/* Է ٸ  Ƶ   */
+		flushOutput(&shell->out);
 
-		/*   error   */
-		if (shell->error != ERR_NONE)
-			printError(shell->error);
+		/*  Է, Է   */
+		if (fgets(buffer, LINE_MAX, stdin) == NULL)
+			break;
 
-		shell->error = ERR_NONE;
+		runCommandLine(shell, buffer);
 	}
 }
 
+/*************************************************************************************
+* :   command-line Ľϰ  ,   Ѵ.
+*       Է  ޴  ϳ  óϴ ̸,
+*       startShell server mode session   Լ ̿Ѵ.
+*       OUTPUT_JSON ̸  ϳ  JSON ü  ٷ Ѵ.
+*         ƹ ͵  ʴ´.
+* :
+* - shell: shell    ִ ü  
+* - line: ڰ Է  .  ٹٲ ڴ ־ ǰ  ȴ.
+* ȯ: 
+*************************************************************************************/
+void runCommandLine(Shell* shell, const char* line)
+{
+	/* ɰ  ڵ Ľ */
+	parseCommandLine(shell, line);
+
+	if (shell->format == OUTPUT_JSON && shell->error != ERR_EMPTY)
+		beginRecord(shell);
+
+	/* error  command  */
+	if (shell->error == ERR_NONE)
+		runCommand(shell);
+
+	/*   error   */
+	if (shell->error != ERR_NONE)
+		printError(shell, shell->error);
+
+	if (shell->format == OUTPUT_JSON && shell->error != ERR_EMPTY)
+		endRecord(shell);
+
+	shell->error = ERR_NONE;
+}
+
 /*************************************************************************************
 * : shell Ҵ ޸𸮸  Ѵ. α׷   ݵ Ѵ.
  ޸, Ʈ, ؽ̺  ޸𸮸 Ѵ.
@@ -128,14 +171,15 @@ void startShell(Shell* shell)
 *************************************************************************************/
 void releaseShell(Shell* shell)
 {
-	if (shell->vm != NULL)
-		free(shell->vm);
-
 	foreachList(&shell->history, NULL, releaseHistory);
 	clearList(&shell->history);
-
-	foreachHash(&shell->op_table, NULL, releaseOplist);
-	clearHash(&shell->op_table);
+	free(shell->stats);
+	shell->stats = NULL;
+	releaseMapping(shell);
+	releaseSymbols(&shell->symbols);
+	releaseSicMachine(&shell->machine);
+	releaseOutput(&shell->capture);
+	releaseOutput(&shell->out);
 }
 
 /*************************************************************************************
@@ -151,16 +195,35 @@ void runCmdHelp(Shell* shell)
 		return;
 	}
 
-	printf("        h[elp]\n");
-	printf("        d[ir]\n");
-	printf("        q[uit]\n");
-	printf("        hi[story]\n");
-	printf("        du[mp] [start, end]\n");
-	printf("        e[dit] address, value\n");
-	printf("        f[ill] start, end, value\n");
-	printf("        reset\n");
-	printf("        opcode mnemonic\n");
-	printf("        opcodelist\n");
+	printOutput(shell, "        h[elp]\n");
+	printOutput(shell, "        d[ir]\n");
+	printOutput(shell, "        q[uit]\n");
+	printOutput(shell, "        hi[story]\n");
+	printOutput(shell, "        du[mp] [start, end]\n");
+	printOutput(shell, "        e[dit] address, value\n");
+	printOutput(shell, "        f[ill] start, end, value|pattern bytes\n");
+	printOutput(shell, "        reset\n");
+	printOutput(shell, "        opcode mnemonic\n");
+	printOutput(shell, "        opcodelist\n");
+	printOutput(shell, "        disasm start, end\n");
+	printOutput(shell, "        stats [reset]\n");
+	printOutput(shell, "        save filename [, start, end]\n");
+	printOutput(shell, "        load filename [, address]\n");
+	printOutput(shell, "        mmap filename [, private|shared]\n");
+	printOutput(shell, "        munmap\n");
+	printOutput(shell, "        macro source, output\n");
+	printOutput(shell, "        undo\n");
+	printOutput(shell, "        redo\n");
+	printOutput(shell, "        objconv source, output\n");
+	printOutput(shell, "        loadobj filename [, address]\n");
+	printOutput(shell, "        mmio start, end, console|filename\n");
+	printOutput(shell, "        rom start, end\n");
+	printOutput(shell, "        ram start, end\n");
+	printOutput(shell, "        memmap\n");
+	printOutput(shell, "        opreload [filename]\n");
+	printOutput(shell, "        move source, destination, length\n");
+	printOutput(shell, "        compare address1, address2, length\n");
+	printOutput(shell, "        symbol [prefix | @address | @start, end]\n");
 }
 
 /*************************************************************************************
@@ -242,9 +305,21 @@ void runCmdHistory(Shell* shell)
 		return;
 	}
 
+	if (shell->format == OUTPUT_JSON) {
+		printField(shell, ",\"history\":[");
+		for (ptr = shell->history.head; ptr != NULL; ptr = ptr->next) {
+			char* cmd_line = (char*)ptr->data;
+			if (ptr != shell->history.head)
+				printField(shell, ",");
+			appendJsonString(&shell->out, cmd_line, strlen(cmd_line));
+		}
+		printField(shell, "]");
+		return;
+	}
+
 	for (ptr = shell->history.head; ptr != NULL; ptr = ptr->next) {
 		char* cmd_line = (char*)ptr->data;
-		printf("        %-5d%s\n", ++num, cmd_line);
+		printOutput(shell, "        %-5d%s\n", ++num, cmd_line);
 	}
 }
 
@@ -264,6 +339,8 @@ void runCmdHistory(Shell* shell)
 *************************************************************************************/
 void runCmdDump(Shell* shell)
 {
+	const char* data;
+	char* copy;
 	int start_addr;
 	int end_addr;
 	int start_base;
@@ -283,14 +360,14 @@ void runCmdDump(Shell* shell)
 		char* ptr;
 		start_addr = (int)strtol(shell->args[0], &ptr, 16);
 		if (*ptr != 0) {
-			printf("%s: ߸ \n", shell->args[0]);
+			printOutput(shell, "%s: ߸ \n", shell->args[0]);
 			shell->error = ERR_RUN_FAIL;
 			return;
 		}
 
 		end_addr = (int)strtoul(shell->args[1], &ptr, 16);
 		if (*ptr != 0) {
-			printf("%s: ߸ \n", shell->args[1]);
+			printOutput(shell, "%s: ߸ \n", shell->args[1]);
 			shell->error = ERR_RUN_FAIL;
 			return;
 		}
@@ -303,17 +380,17 @@ void runCmdDump(Shell* shell)
 
 	/* check range */
 	if (start_addr < 0 || start_addr >= MEM_SIZE) {
-		printf("%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", start_addr);
+		printOutput(shell, "%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", start_addr);
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
 	if (end_addr < 0 || end_addr >= MEM_SIZE) {
-		printf("%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", end_addr);
+		printOutput(shell, "%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", end_addr);
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
 	if (start_addr > end_addr) {
-		printf("߸ :  ּҰ  ּҰ ʰϿϴ.\n");
+		printOutput(shell, "߸ :  ּҰ  ּҰ ʰϿϴ.\n");
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
@@ -321,32 +398,43 @@ void runCmdDump(Shell* shell)
 	start_base = (start_addr / MEM_LINE) * MEM_LINE;
 	end_base = (end_addr / MEM_LINE) * MEM_LINE;
 
-	/* dump memory */
-	for (cur_base = start_base; cur_base <= end_base; cur_base += MEM_LINE) {
-		/* memory address */
-		printf("%05X ", cur_base);
+	data = getMemory(shell, start_addr, end_addr - start_addr + 1, &copy);
+	if (data == NULL)
+		return;
 
-		/* 16 ǥ */
-		for (cur_addr = cur_base; cur_addr < cur_base + MEM_LINE; cur_addr++) {
-			if (cur_addr >= start_addr && cur_addr <= end_addr)
-				printf("%02X ", (unsigned char)shell->vm[cur_addr]);
-			else
-				printf("   ");
+	/* JSON̸  16 ڿ ϳ  */
+	if (shell->format == OUTPUT_JSON) {
+		printField(shell, ",\"start\":%d,\"end\":%d,\"data\":\"", start_addr, end_addr);
+		for (cur_base = start_addr; cur_base <= end_addr; cur_base += MEM_LINE * 64) {
+			int cnt = end_addr - cur_base + 1 < MEM_LINE * 64 ? end_addr - cur_base + 1 : MEM_LINE * 64;
+			char* dst = reserveOutput(&shell->out, cnt * 2);
+			if (dst == NULL)
+				break;
+			for (cur_addr = cur_base; cur_addr < cur_base + cnt; cur_addr++) {
+				unsigned char value = (unsigned char)data[cur_addr - start_addr];
+				*dst++ = hex_digits[value >> 4];
+				*dst++ = hex_digits[value & 0xF];
+			}
+			shell->out.len += cnt * 2;
+			STATS_ADD_OUTPUT(shell, cnt * 2);
 		}
-
-		/* ASCII ǥ */
-		printf("; ");
-		for (cur_addr = cur_base; cur_addr < cur_base + MEM_LINE; cur_addr++) {
-			char value = shell->vm[cur_addr];
-			if (cur_addr >= start_addr && cur_addr <= end_addr && value >= 0x20 && value <= 0x7E)
-				printf("%c", value);
-			else
-				printf(".");
+		printField(shell, "\"");
+	}
+	/* dump memory,  پ  ۿ ٷ  */
+	else {
+		Output* out = getOutput(shell);
+		for (cur_base = start_base; cur_base <= end_base; cur_base += MEM_LINE) {
+			char* dst = reserveOutput(out, DUMP_LINE_LEN);
+			if (dst == NULL)
+				break;
+			out->len += formatDumpLine(dst, data, cur_base, start_addr, end_addr);
+			STATS_ADD_OUTPUT(shell, DUMP_LINE_LEN);
 		}
-
-		printf("\n");
 	}
 
+	free(copy);
+	STATS_ADD_VM(shell, end_addr - start_addr + 1);
+
 	/*   */
 	shell->mem_addr = (end_addr + 1) % MEM_SIZE;
 }
@@ -362,6 +450,7 @@ void runCmdEdit(Shell* shell)
 	char* ptr = NULL;
 	int addr = 0;
 	int value = 0;
+	unsigned char byte;
 
 	/* ڰ 2 ƴϸ  */
 	if (shell->argc != 2) {
@@ -372,35 +461,46 @@ void runCmdEdit(Shell* shell)
 	/* arguments ˻  16 ȯ */
 	addr = (int)strtoul(shell->args[0], &ptr, 16);
 	if (*ptr != 0) {
-		printf("%s: ߸ \n", shell->args[0]);
+		printOutput(shell, "%s: ߸ \n", shell->args[0]);
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
 	value = (int)strtoul(shell->args[1], &ptr, 16);
 	if (*ptr != 0) {
-		printf("%s: ߸ \n", shell->args[1]);
+		printOutput(shell, "%s: ߸ \n", shell->args[1]);
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
 
 	/* check range */
 	if (addr < 0 || addr >= MEM_SIZE) {
-		printf("%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", addr);
+		printOutput(shell, "%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", addr);
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
 	if (value < 0 || value > 255) {
-		printf("%X:  ȿ : [0, FF]  ϴ.\n", value);
+		printOutput(shell, "%X:  ȿ : [0, FF]  ϴ.\n", value);
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
 
 	/* edit */
-	shell->vm[addr] = value;
+	byte = (unsigned char)value;
+	if (writeSicMemory(&shell->machine, addr, &byte, 1) == SIC_ERR_ROM) {
+		printOutput(shell, "%X: ROM   ϴ.\n", addr);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	STATS_ADD_VM(shell, 1);
 }
 
 /*************************************************************************************
 * : ޸ start end  value   Ѵ.
+*       value byte ϳ  ó   ä. (: 0041, 0FF)
+*       byte ϳ  ʰų "pattern bytes"   ڸ byte 
+*       pattern ݺؼ ä.
+*       (: fill 0, FF, 0102  fill 0, FF, pattern 0102  01 02 01 02 ... ,
+*       fill 0, FF, pattern 0041  00 41 00 41 ...  ä.)
 * :
 * - shell: shell    ִ ü  
 * ȯ: 
@@ -410,7 +510,10 @@ void runCmdFill(Shell* shell)
 	char* ptr;
 	int start_addr = 0;
 	int end_addr = 0;
-	int value = 0;
+	unsigned long value = 0;
+	unsigned char pattern[PATTERN_MAX];
+	int size = 1;
+	int result;
 
 	/* argument 3 ƴϸ  */
 	if (shell->argc != 3) {
@@ -421,63 +524,105 @@ void runCmdFill(Shell* shell)
 	/* arguments ˻  16 ȯ */
 	start_addr = (int)strtoul(shell->args[0], &ptr, 16);
 	if (*ptr != 0) {
-		printf("%s: ߸ \n", shell->args[0]);
+		printOutput(shell, "%s: ߸ \n", shell->args[0]);
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
 	end_addr = (int)strtoul(shell->args[1], &ptr, 16);
 	if (*ptr != 0) {
-		printf("%s: ߸ \n", shell->args[1]);
+		printOutput(shell, "%s: ߸ \n", shell->args[1]);
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
-	value = (int)strtoul(shell->args[2], &ptr, 16);
-	if (*ptr != 0) {
-		printf("%s: ߸ \n", shell->args[2]);
-		shell->error = ERR_RUN_FAIL;
-		return;
+	if (!strncmp(shell->args[2], "pattern", 7) && isspace((unsigned char)shell->args[2][7])) {
+		for (ptr = shell->args[2] + 7; isspace((unsigned char)*ptr); ptr++);
+		size = parsePattern(ptr, pattern);
+		if (size == 0) {
+			printOutput(shell, "%s: ߸ pattern,  ڸ ¦ ̷ 16 մϴ.\n", ptr);
+			shell->error = ERR_RUN_FAIL;
+			return;
+		}
+	}
+	else {
+		value = strtoul(shell->args[2], &ptr, 16);
+		if (*ptr != 0 || shell->args[2][0] == 0) {
+			printOutput(shell, "%s: ߸ \n", shell->args[2]);
+			shell->error = ERR_RUN_FAIL;
+			return;
+		}
+		/* byte ϳ  ʴ  pattern д´ */
+		if (value > 0xFF) {
+			size = parsePattern(shell->args[2], pattern);
+			if (size == 0) {
+				printOutput(shell, "%s:  ȿ : [0, FF]  ϴ.\n", shell->args[2]);
+				shell->error = ERR_RUN_FAIL;
+				return;
+			}
+		}
 	}
 
 	/* check range */
 	if (start_addr < 0 || start_addr >= MEM_SIZE) {
-		printf("%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", start_addr);
+		printOutput(shell, "%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", start_addr);
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
 	if (end_addr < 0 || end_addr >= MEM_SIZE) {
-		printf("%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", end_addr);
+		printOutput(shell, "%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", end_addr);
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
 	if (start_addr > end_addr) {
-		printf("߸ :  ּҰ  ּҰ ʰϿϴ.\n");
+		printOutput(shell, "߸ :  ּҰ  ּҰ ʰϿϴ.\n");
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
-	if (value < 0 || value > 255) {
-		printf("%X:  ȿ : [0, FF]  ϴ.\n", value);
+
+	/* fill */
+	if (size == 1)
+		pattern[0] = (unsigned char)value;
+	result = fillSicPattern(&shell->machine, start_addr, end_addr - start_addr + 1, pattern, size);
+	if (result == SIC_ERR_ROM) {
+		printOutput(shell, "%X-%X: ROM ִ    ϴ.\n", start_addr, end_addr);
 		shell->error = ERR_RUN_FAIL;
 		return;
 	}
-
-	/* fill */
-	memset(shell->vm + start_addr, (char)value, sizeof(char) * (end_addr - start_addr + 1));
+	if (result != SIC_OK) {
+		printOutput(shell, "޸𸮸 Ҵ ߽ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	STATS_ADD_VM(shell, end_addr - start_addr + 1);
 }
 
 /*************************************************************************************
-* : ޸ ü  0 Ų.
+* : ޸ ü  0 Ų. ROM ġ   ״ д.
+*       symbol table , undoϸ ޸𸮿 Բ ǵ.
 * :
 * - shell: shell    ִ ü  
 * ȯ: 
 *************************************************************************************/
 void runCmdReset(Shell* shell)
 {
+	unsigned long long change;
+
 	if (shell->argc != 0) {
 		shell->error = ERR_INVALID_USE;
 		return;
 	}
 
-	memset(shell->vm, 0, sizeof(char) * MEM_SIZE);
+	/*  ޸𸮸 Ű symbol . undoϸ Բ ǵ */
+	change = getSicChange(&shell->machine, 0);
+	if (!stageClearSymbols(&shell->symbols)) {
+		printOutput(shell, "޸𸮸 Ҵ ߽ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	resetSicMemory(&shell->machine);
+	change = getSicChange(&shell->machine, 0) != change ? getSicChange(&shell->machine, 0) : 0;
+	if (!commitSymbols(&shell->symbols, change, getSicOldestChange(&shell->machine)))
+		printOutput(shell, "symbol  ޸𸮸 Ҵ ؼ undo  symbol ǵ ʽϴ.\n");
+	STATS_ADD_VM(shell, MEM_SIZE);
 }
 
 /*************************************************************************************
@@ -493,11 +638,18 @@ void runCmdOpcode(Shell* shell)
 		return;
 	}
 
-	int* code = (int*)getValue(&shell->op_table, shell->args[0]);
-	if (code == NULL)
-		printf("        ش  ã  ϴ.\n");
+	const Opcode* op = findSicOpcode(beginSicLookup(&shell->machine), shell->args[0]);
+	if (shell->format == OUTPUT_JSON) {
+		if (op == NULL)
+			printField(shell, ",\"opcode\":null");
+		else
+			printField(shell, ",\"opcode\":%d,\"format\":%d", op->code, op->format);
+	}
+	else if (op == NULL)
+		printOutput(shell, "        ش  ã  ϴ.\n");
 	else
-		printf("        opcode is %X\n", *code);
+		printOutput(shell, "        opcode is %X\n", op->code);
+	endSicLookup(&shell->machine);
 }
 
 /*************************************************************************************
@@ -508,184 +660,1649 @@ void runCmdOpcode(Shell* shell)
 *************************************************************************************/
 void runCmdOplist(Shell* shell)
 {
+	const SicOpTable* table;
 	int i;
 	if (shell->argc != 0) {
 		shell->error = ERR_INVALID_USE;
 		return;
 	}
 
+	table = beginSicLookup(&shell->machine);
+	if (shell->format == OUTPUT_JSON) {
+		int first = true;
+		printField(shell, ",\"opcodes\":[");
+		for (i = 0; i < BUCKET_SIZE; i++) {
+			Node* ptr;
+			for (ptr = table->table.buckets[i].head; ptr != NULL; ptr = ptr->next) {
+				Entry* entry = (Entry*)ptr->data;
+				Opcode* op = (Opcode*)entry->value;
+				printField(shell, "%s{\"mnemonic\":\"%s\",\"opcode\":%d,\"format\":%d,\"bucket\":%d}",
+					first ? "" : ",", op->mnemonic, op->code, op->format, i);
+				first = false;
+			}
+		}
+		printField(shell, "]");
+		endSicLookup(&shell->machine);
+		return;
+	}
+
 	for (i = 0; i < BUCKET_SIZE; i++) {
 		Node* ptr;
-		printf("        %-2d : ", i + 1);
+		printOutput(shell, "        %-2d : ", i + 1);
 
-		ptr = shell->op_table.buckets[i].head;
+		ptr = table->table.buckets[i].head;
 		if (ptr != NULL) {
 			Entry* entry = (Entry*)ptr->data;
-			printf("[%s, %02X]", (char*)entry->key, *(int*)entry->value);
+			printOutput(shell, "[%s, %02X]", (char*)entry->key, ((Opcode*)entry->value)->code);
 			ptr = ptr->next;
 
 			while (ptr != NULL) {
 				Entry* entry = (Entry*)ptr->data;
-				printf("  [%s, %02X]", (char*)entry->key, *(int*)entry->value);
+				printOutput(shell, "  [%s, %02X]", (char*)entry->key, ((Opcode*)entry->value)->code);
 				ptr = ptr->next;
 			}
 		}
-		printf("\n");
+		printOutput(shell, "\n");
 	}
+	endSicLookup(&shell->machine);
 }
 
 /*************************************************************************************
-* : shell  cmd_code ̿Ͽ ش code ε Լ ȣ
+* : ޸ start end SIC/XE ɾ ؼϿ Ѵ.
+*       format 1/2/3/4 n/i/x/b/p/e flag ؼϿ mnemonic, operand ְ,
+*       PC relative  Ǵ target address operand ڸ ش.
+*       symbol  symbol ּҿ ϴ ɾ տ "NAME:" label ,
+*       target address ڿ  ּ̰ų     symbol
+*       "<NAME>" Ǵ "<NAME+offset>" δ.
+*        پ printf ʰ  ۿ ٷ ؼѴ.
 * :
 * - shell: shell    ִ ü  
 * ȯ: 
 *************************************************************************************/
-void runCommand(Shell* shell)
+void runCmdDisasm(Shell* shell)
 {
-	if (shell->cmd_code < 0 || shell->cmd_code >= CMD_CNT) {
-		shell->error = ERR_NO_CMD;
+	Output* out = getOutput(shell);
+	const SicOpTable* table;
+	const char* data;
+	char* copy;
+	char* ptr;
+	unsigned int target;
+	int symbol;
+	int last_symbol;
+	int start_addr;
+	int end_addr;
+	int data_end;
+	int cur_addr;
+
+	if (shell->argc != 2) {
+		shell->error = ERR_INVALID_USE;
 		return;
 	}
-	else {
-		shell->cmds[shell->cmd_code](shell);
-		if (shell->error == ERR_NONE)
-			addList(&shell->history, strdup(shell->cmd_line));
+
+	/* arguments ˻  16 ȯ */
+	start_addr = (int)strtoul(shell->args[0], &ptr, 16);
+	if (*ptr != 0) {
+		printOutput(shell, "%s: ߸ \n", shell->args[0]);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	end_addr = (int)strtoul(shell->args[1], &ptr, 16);
+	if (*ptr != 0) {
+		printOutput(shell, "%s: ߸ \n", shell->args[1]);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+
+	/* check range */
+	if (start_addr < 0 || start_addr >= MEM_SIZE) {
+		printOutput(shell, "%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", start_addr);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	if (end_addr < 0 || end_addr >= MEM_SIZE) {
+		printOutput(shell, "%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", end_addr);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	if (start_addr > end_addr) {
+		printOutput(shell, "߸ :  ּҰ  ּҰ ʰϿϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+
+	/*  ɾ end ڷ 3 byte ̾  ִ */
+	data_end = end_addr + 4 < MEM_SIZE ? end_addr + 4 : MEM_SIZE;
+	data = getMemory(shell, start_addr, data_end - start_addr, &copy);
+	if (data == NULL)
+		return;
+
+	/* disassemble,  پ  ۿ ٷ . symbol ִ ּҴ label   */
+	symbol = findSymbolRange(&shell->symbols, (unsigned int)start_addr, (unsigned int)end_addr, &last_symbol);
+	table = beginSicLookup(&shell->machine);
+	for (cur_addr = start_addr; cur_addr <= end_addr; ) {
+		int line_len;
+		char* dst;
+
+		while (symbol < last_symbol && shell->symbols.by_addr[symbol]->addr < (unsigned int)cur_addr)
+			symbol++;
+		while (symbol < last_symbol && shell->symbols.by_addr[symbol]->addr == (unsigned int)cur_addr)
+			printOutput(shell, "%s:\n", shell->symbols.by_addr[symbol++]->name);
+
+		dst = reserveOutput(out, DISASM_LINE_MAX + DISASM_SYMBOL_MAX);
+		if (dst == NULL)
+			break;
+
+		cur_addr += disassemble(dst, &line_len, &target, (const unsigned char*)data, (unsigned int)start_addr,
+			(unsigned int)cur_addr, (unsigned int)data_end, table->decode);
+
+		/* target address symbol ٹٲ ڸ δ */
+		if (target != DISASM_NO_TARGET && shell->symbols.cnt > 0) {
+			const Symbol* found = findSymbolAt(&shell->symbols, target);
+
+			if (found != NULL && found->addr == target)
+				line_len += sprintf(dst + line_len - 1, " <%s>\n", found->name) - 1;
+			else if (found != NULL)
+				line_len += sprintf(dst + line_len - 1, " <%s+%X>\n", found->name, target - found->addr) - 1;
+		}
+		out->len += line_len;
+		STATS_ADD_OUTPUT(shell, line_len);
 	}
+	endSicLookup(&shell->machine);
+	free(copy);
+	STATS_ADD_VM(shell, cur_addr - start_addr);
 }
 
 /*************************************************************************************
-* : ش  ڵ忡 شϴ  
+* : ɺ  Ƚ, error Ƚ,  ð(p50, p99, ִ), Ҵ Ƚ, ·,
+*        ޸ ٷ Ѵ. reset ڸ ָ ݱ 踦 .
+*       ð  ns̰,       ʴ´.
 * :
-* - err_code: error Ÿ 
+* - shell: shell    ִ ü  
 * ȯ: 
 *************************************************************************************/
-static void printError(int err_code)
+void runCmdStats(Shell* shell)
 {
-	switch (err_code) {
-	case ERR_NONE:
-	case ERR_EMPTY:
-		break;
-
-	case ERR_INIT:
-		printf("Shell ʱȭϴµ ߽ϴ. մϴ.\n");
-		break;
+#ifdef SHELL_STATS
+	char allocs[24];
+	int i;
 
-	case ERR_NO_CMD:
-		printf("   Դϴ. h[elp] ԷϿ   Ȯϼ.\n");
-		break;
+	if (shell->argc > 1 || (shell->argc == 1 && strcmp(shell->args[0], "reset"))) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+	if (shell->stats == NULL && shell->machine.shared) {
+		printOutput(shell, "server session ɺ 踦  ʽϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	if (shell->stats == NULL) {
+		printOutput(shell, "踦  ޸𸮸 Ҵ ߽ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
 
-	case ERR_INVALID_USE:
-		printf(" ڰ ߸Ǿϴ. h[elp] ԷϿ  Ȯϼ.\n");
-		break;
+	if (shell->argc == 1) {
+		resetStats(shell->stats);
+		return;
+	}
 
-	case ERR_RUN_FAIL:
-		printf("   ϴ.\n");
-		break;
+	printOutput(shell, "%-12s %8s %6s %10s %10s %10s %8s %10s %10s\n",
+		"command", "count", "errors", "p50(ns)", "p99(ns)", "max(ns)", "allocs", "out", "vm");
+	for (i = 0; i < CMD_CNT; i++) {
+		const CommandStats* cmd = &shell->stats->cmds[i];
+		if (cmd->latency.count == 0)
+			continue;
 
-	default:
-		printf("   \n");
-		break;
+		/* ALLOC_COUNT  ϸ Ҵ Ƚ  ʴ´ */
+		if (isAllocCounted())
+			sprintf(allocs, "%llu", cmd->allocs);
+		else
+			strcpy(allocs, "-");
+		printOutput(shell, "%-12s %8llu %6llu %10llu %10llu %10llu %8s %10llu %10llu\n",
+			getCommandName(i), cmd->latency.count, cmd->errors,
+			getPercentile(&cmd->latency, 50.0), getPercentile(&cmd->latency, 99.0),
+			cmd->latency.max, allocs, cmd->out_bytes, cmd->vm_bytes);
 	}
+#else
+	printOutput(shell, "  (SHELL_STATS) Ǿϴ.\n");
+	shell->error = ERR_RUN_FAIL;
+#endif
 }
 
-
 /*************************************************************************************
-* : opcode.txt Ϸκ opcode  (code, mnemonic, type) 
-*       о hash table Ѵ.    еȴٰ ϰ
-*       strtok ̿Ͽ    о ĽѴ.  ٿ ؼ
-*       Ľϴ ߿ ܰ ߻ϸ ش  ǳʶٰ   д´.
+* : ޸    ״ Ͽ Ѵ.
+* :
+* - save filename: ޸ ü(1MB) Ѵ.
+* - save filename, start, end: start end  Ѵ.
 * :
 * - shell: shell    ִ ü  
 * ȯ: 
 *************************************************************************************/
-static void parseOpcode(Shell* shell)
+void runCmdSave(Shell* shell)
 {
-	char buffer[LINE_MAX];
-	FILE* fp = fopen("./opcode.txt", "r");
-	if (fp == NULL) {
-		shell->error = ERR_INIT;
+	FILE* fp;
+	const char* data;
+	char* copy;
+	char* ptr;
+	int start_addr = 0;
+	int end_addr = MEM_SIZE - 1;
+	size_t len;
+
+	if (shell->argc != 1 && shell->argc != 3) {
+		shell->error = ERR_INVALID_USE;
 		return;
 	}
 
-	while (!feof(fp)) {
-		char* ptr;
-		char* mne;
-		int* code_ptr;
-		int code;
-
-		fgets(buffer, LINE_MAX, fp);
-		buffer[strlen(buffer) - 1] = 0;
+	/* arguments ˻  16 ȯ */
+	if (shell->argc == 3) {
+		start_addr = (int)strtoul(shell->args[1], &ptr, 16);
+		if (*ptr != 0) {
+			printOutput(shell, "%s: ߸ \n", shell->args[1]);
+			shell->error = ERR_RUN_FAIL;
+			return;
+		}
+		end_addr = (int)strtoul(shell->args[2], &ptr, 16);
+		if (*ptr != 0) {
+			printOutput(shell, "%s: ߸ \n", shell->args[2]);
+			shell->error = ERR_RUN_FAIL;
+			return;
+		}
+	}
 
-		/* parse opcode */
-		ptr = strtok(buffer, " \t");
-		if (ptr == NULL)
-			continue;
-		code = (int)strtoul(ptr, NULL, 16);
+	/* check range */
+	if (start_addr < 0 || start_addr >= MEM_SIZE) {
+		printOutput(shell, "%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", start_addr);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	if (end_addr < 0 || end_addr >= MEM_SIZE) {
+		printOutput(shell, "%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", end_addr);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	if (start_addr > end_addr) {
+		printOutput(shell, "߸ :  ּҰ  ּҰ ʰϿϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
 
-		/* parse mnemonic */
-		ptr = strtok(NULL, " \t");
-		if (ptr == NULL)
-			continue;
+	len = (size_t)(end_addr - start_addr + 1);
+	data = getMemory(shell, start_addr, (int)len, &copy);
+	if (data == NULL)
+		return;
 
-		mne = strdup(ptr);
-		code_ptr = (int*)malloc(sizeof(int));
-		if (mne == NULL || code_ptr == NULL) {
-			shell->error = ERR_INIT;
-			return;
-		}
+	fp = fopen(shell->args[0], "wb");
+	if (fp == NULL) {
+		printOutput(shell, "%s:    ϴ.\n", shell->args[0]);
+		shell->error = ERR_RUN_FAIL;
+		free(copy);
+		return;
+	}
 
-		*code_ptr = code;
-		insertHash(&shell->op_table, mne, code_ptr);
+	/* save */
+	if (fwrite(data, sizeof(char), len, fp) != len || fclose(fp) != 0) {
+		printOutput(shell, "%s:   ߽ϴ.\n", shell->args[0]);
+		shell->error = ERR_RUN_FAIL;
+		free(copy);
+		return;
 	}
+	free(copy);
+	STATS_ADD_VM(shell, len);
 }
 
 /*************************************************************************************
-* : ڷκ   command-line Է¹ް, ĽϿ command argument
-*       ´. ܰ ߻ ʴ´ٸ, command-line  ϰ, command
-*        code ִ 3 argument ϰ ȴ.
+* : save  Ͱ    о ޸𸮿 ״ .
+*        ü ޸  ȿ   ƹ͵  ʴ´.
+* :
+* - load filename: 0   .
+* - load filename, address: address   .
 * :
 * - shell: shell    ִ ü  
 * ȯ: 
 *************************************************************************************/
-static void parseCommandLine(Shell* shell)
+void runCmdLoad(Shell* shell)
 {
-	char buffer[LINE_MAX] = { 0, };
+	FILE* fp;
 	char* ptr;
-	char* ptr2;
-
-	/*  Է */
-	fgets(buffer, LINE_MAX, stdin);
-
-	/* \n  */
-	buffer[strlen(buffer) - 1] = 0;
-
-	/* shell command line Ͽ  */
-	strncpy(shell->cmd_line, buffer, LINE_MAX);
-
-	/* ɾ Ľ*/
-	ptr = strtok(buffer, " \t");
+	char* dst;
+	int addr = 0;
+	long size;
 
-	/*  ڿ   ó */
-	if (ptr == NULL) {
-		shell->error = ERR_EMPTY;
+	if (shell->argc != 1 && shell->argc != 2) {
+		shell->error = ERR_INVALID_USE;
 		return;
 	}
 
-	/*  ڿ ڵ ȯ */
-	shell->cmd_code = getCommandCode(ptr);
-	if (shell->cmd_code == CMD_INVALID) {
-		shell->error = ERR_NO_CMD;
-		return;
+	/* arguments ˻  16 ȯ */
+	if (shell->argc == 2) {
+		addr = (int)strtoul(shell->args[1], &ptr, 16);
+		if (*ptr != 0) {
+			printOutput(shell, "%s: ߸ \n", shell->args[1]);
+			shell->error = ERR_RUN_FAIL;
+			return;
+		}
 	}
 
-	/* ɿ  ڸ Ľ */
-	ptr = strtok(NULL, "");
-	if (ptr == NULL) {
-		shell->argc = 0;
+	/* check range */
+	if (addr < 0 || addr >= MEM_SIZE) {
+		printOutput(shell, "%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", addr);
+		shell->error = ERR_RUN_FAIL;
 		return;
 	}
 
-	/* ڴ ','  */
+	fp = fopen(shell->args[0], "rb");
+	if (fp == NULL) {
+		printOutput(shell, "%s:    ϴ.\n", shell->args[0]);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+
+	/*  ũ Ȯ */
+	if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+		printOutput(shell, "%s:    ϴ.\n", shell->args[0]);
+		shell->error = ERR_RUN_FAIL;
+		fclose(fp);
+		return;
+	}
+	if (size > MEM_SIZE - addr) {
+		printOutput(shell, "%s:  ũ(%lX) %X  ޸ ũ(%X) ʰմϴ.\n",
+			shell->args[0], size, addr, MEM_SIZE - addr);
+		shell->error = ERR_RUN_FAIL;
+		fclose(fp);
+		return;
+	}
+
+	/* load, ߰ ص ٲ ŭ undo  ֵ Ѵ */
+	dst = beginSicWrite(&shell->machine, addr, (unsigned int)size);
+	if (dst != NULL) {
+		if (fread(dst, sizeof(char), (size_t)size, fp) != (size_t)size) {
+			printOutput(shell, "%s:    ϴ.\n", shell->args[0]);
+			shell->error = ERR_RUN_FAIL;
+		}
+		endSicWrite(&shell->machine);
+	}
+	/* ROM̳ ġ ִ      page   */
+	else {
+		char* buffer = (char*)malloc((size_t)size);
+
+		if (buffer == NULL || fread(buffer, sizeof(char), (size_t)size, fp) != (size_t)size) {
+			printOutput(shell, "%s:    ϴ.\n", shell->args[0]);
+			shell->error = ERR_RUN_FAIL;
+		}
+		else if (writeSicMemory(&shell->machine, addr, buffer, (unsigned int)size) == SIC_ERR_ROM) {
+			printOutput(shell, "%X-%lX: ROM ִ    ϴ.\n", addr, addr + size - 1);
+			shell->error = ERR_RUN_FAIL;
+		}
+		free(buffer);
+	}
+	fclose(fp);
+	STATS_ADD_VM(shell, size);
+}
+
+/*************************************************************************************
+* :  mmapϿ ޸𸮷 Ѵ.  Ƿ ū ϵ ٷ   ִ.
+*       private̸ ޸𸮸 ٲ㵵  ״̰, shared̸ ٲ  Ͽ
+*       ϵȴ.  1MB ª  0 ä, shared  
+*       ũ⸦ 1MB ø. 1MB    1MB Ѵ.
+*       munmapϸ mmapϱ  ޸𸮷 ư.
+* :
+* - mmap filename: private mmapѴ.
+* - mmap filename, private|shared
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdMmap(Shell* shell)
+{
+#ifdef _WIN32
+	printOutput(shell, " ȯ濡 mmap  ʽϴ.\n");
+	shell->error = ERR_RUN_FAIL;
+#else
+	struct stat fs;
+	int flags = MAP_PRIVATE;
+	char* vm;
+	int fd;
+
+	if (shell->argc != 1 && shell->argc != 2) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+	if (shell->argc == 2) {
+		if (!strcmp(shell->args[1], "shared"))
+			flags = MAP_SHARED;
+		else if (strcmp(shell->args[1], "private")) {
+			shell->error = ERR_INVALID_USE;
+			return;
+		}
+	}
+	if (shell->vm_origin != NULL) {
+		printOutput(shell, "̹ mmap  ֽϴ. munmap Ŀ ٽ õϼ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+
+	fd = open(shell->args[0], flags == MAP_SHARED ? O_RDWR : O_RDONLY);
+	if (fd < 0 || fstat(fd, &fs) < 0) {
+		printOutput(shell, "%s:    ϴ.\n", shell->args[0]);
+		shell->error = ERR_RUN_FAIL;
+		if (fd >= 0)
+			close(fd);
+		return;
+	}
+
+	/* shared   Ͽ ƾ ϹǷ  1MB ø */
+	if (flags == MAP_SHARED && fs.st_size < MEM_SIZE) {
+		if (ftruncate(fd, MEM_SIZE) < 0) {
+			printOutput(shell, "%s:  ũ⸦ ø  ϴ.\n", shell->args[0]);
+			shell->error = ERR_RUN_FAIL;
+			close(fd);
+			return;
+		}
+		fs.st_size = MEM_SIZE;
+	}
+
+	if (fs.st_size >= MEM_SIZE) {
+		vm = (char*)mmap(NULL, MEM_SIZE, PROT_READ | PROT_WRITE, flags, fd, 0);
+	}
+	else {
+		/* ª    Ѿ page ϸ SIGBUS Ƿ,
+		   0 ä ͸ mapping   ִ κи ļ mmapѴ */
+		vm = (char*)mmap(NULL, MEM_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (vm != MAP_FAILED && fs.st_size > 0 &&
+			mmap(vm, (size_t)fs.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+			munmap(vm, MEM_SIZE);
+			vm = (char*)MAP_FAILED;
+		}
+	}
+	close(fd);
+
+	if (vm == (char*)MAP_FAILED) {
+		printOutput(shell, "%s: mmap ߽ϴ.\n", shell->args[0]);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+
+	/* ޸ ü ٲǷ   symbol ϰ Բ  */
+	setSicMemory(&shell->machine, vm, &shell->vm_origin);
+	dropSymbolEdits(&shell->symbols);
+#endif
+}
+
+/*************************************************************************************
+* : mmap  ϰ mmapϱ  ޸𸮷 ư. shared mmap
+*       ٲ  Ͽ   ڿ Ѵ.
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdMunmap(Shell* shell)
+{
+	if (shell->argc != 0) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+	if (shell->vm_origin == NULL) {
+		printOutput(shell, "mmap  ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+
+	releaseMapping(shell);
+}
+
+/*************************************************************************************
+* : SIC/XE assembly source macro ȮϿ output Ͽ Ѵ.
+*       macro ǿ Ȯ Է   鼭  óѴ. (macro.c )
+*       ϸ ΰ  ȣ ϰ output  .
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdMacro(Shell* shell)
+{
+	MacroProcessor* mp;
+	FILE* in;
+	FILE* out;
+	int success;
+
+	if (shell->argc != 2) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+
+	in = fopen(shell->args[0], "r");
+	if (in == NULL) {
+		printOutput(shell, "%s:    ϴ.\n", shell->args[0]);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	out = fopen(shell->args[1], "w");
+	if (out == NULL) {
+		printOutput(shell, "%s:    ϴ.\n", shell->args[1]);
+		shell->error = ERR_RUN_FAIL;
+		fclose(in);
+		return;
+	}
+
+	/* frame stack Ŀ stack  heap д */
+	mp = (MacroProcessor*)malloc(sizeof(MacroProcessor));
+	if (mp == NULL) {
+		printOutput(shell, "޸𸮸 Ҵ ߽ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		fclose(in);
+		fclose(out);
+		return;
+	}
+
+	initializeMacro(mp);
+	success = processMacroFile(mp, in, out);
+	fclose(in);
+	if (fclose(out) != 0 && success) {
+		printOutput(shell, "%s:   ߽ϴ.\n", shell->args[1]);
+		success = false;
+	}
+	else if (!success) {
+		printOutput(shell, "%s:%d: %s\n", shell->args[0], mp->line_no, getMacroErrorMessage(mp->error));
+	}
+	releaseMacro(mp);
+	free(mp);
+
+	if (!success) {
+		remove(shell->args[1]);
+		shell->error = ERR_RUN_FAIL;
+	}
+}
+
+/*************************************************************************************
+* :  ֱٿ ޸𸮸 ٲ (edit, fill, reset, load, loadobj) ǵ.
+*        ũ (JOURNAL_BUDGET) ־  ͺ ,
+*       mmap̳ munmap ϸ  . ġ    ROM̳ MMIO
+*        ǵ , ׷ κ  RAM ǵȴٰ ˸.
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdUndo(Shell* shell)
+{
+	unsigned int addr;
+	unsigned int len;
+	unsigned long long change;
+	int result;
+
+	if (shell->argc != 0) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+
+	change = getSicChange(&shell->machine, 0);
+	result = undoSicMemory(&shell->machine, &addr, &len);
+	if (result == SIC_ERR_EMPTY) {
+		printOutput(shell, "ǵ ۾ ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	if (result == SIC_ERR_NOMEM) {
+		printOutput(shell, "޸𸮸 Ҵ ߽ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	if (result == SIC_ERR_DEVICE)
+		printOutput(shell, "%05X-%05X: ġ ROM κ ǵ   RAM ǵȽϴ.\n",
+			addr, addr + len - 1);
+	if (!replaySymbols(&shell->symbols, change, 0))
+		printOutput(shell, "symbol  ޸𸮸 Ҵ ؼ Ϻ symbol ǵ ߽ϴ.\n");
+	if (shell->format == OUTPUT_JSON)
+		printField(shell, ",\"start\":%u,\"length\":%u,\"partial\":%s", addr, len,
+			result == SIC_ERR_DEVICE ? "true" : "false");
+	STATS_ADD_VM(shell, len);
+}
+
+/*************************************************************************************
+* : undo ǵ  ٽ Ѵ. undo Ŀ ޸𸮸 ٲٴ  ϸ
+*       ٽ   .
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdRedo(Shell* shell)
+{
+	unsigned int addr;
+	unsigned int len;
+	unsigned long long change;
+	int result;
+
+	if (shell->argc != 0) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+
+	change = getSicChange(&shell->machine, 1);
+	result = redoSicMemory(&shell->machine, &addr, &len);
+	if (result == SIC_ERR_EMPTY) {
+		printOutput(shell, "ٽ  ۾ ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	if (result == SIC_ERR_NOMEM) {
+		printOutput(shell, "޸𸮸 Ҵ ߽ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	if (result == SIC_ERR_DEVICE)
+		printOutput(shell, "%05X-%05X: ġ ROM κ ǵ   RAM ٽ ߽ϴ.\n",
+			addr, addr + len - 1);
+	if (!replaySymbols(&shell->symbols, change, 1))
+		printOutput(shell, "symbol  ޸𸮸 Ҵ ؼ Ϻ symbol ٽ  ߽ϴ.\n");
+	if (shell->format == OUTPUT_JSON)
+		printField(shell, ",\"start\":%u,\"length\":%u,\"partial\":%s", addr, len,
+			result == SIC_ERR_DEVICE ? "true" : "false");
+	STATS_ADD_VM(shell, len);
+}
+
+/*************************************************************************************
+* : object file ٸ  ٲ۴. text (H/D/R/T/M/E record)̸ binary
+*       , binary ̸ text  ٲٸ  file պκ
+*       ˾Ƴ. (objfile.h ) ϸ  ϰ output  .
+* :
+* - objconv source, output
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdObjconv(Shell* shell)
+{
+	ObjectFile obj;
+	FILE* out;
+	int success;
+
+	if (shell->argc != 2) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+
+	/* source output  ̾ ǵ    ڿ  */
+	initializeObject(&obj);
+	if (!openObjectFile(&obj, shell->args[0]) || !readObjectImage(&obj)) {
+		printObjectError(shell, shell->args[0], &obj);
+		shell->error = ERR_RUN_FAIL;
+		releaseObject(&obj);
+		return;
+	}
+
+	out = fopen(shell->args[1], obj.binary ? "w" : "wb");
+	if (out == NULL) {
+		printOutput(shell, "%s:    ϴ.\n", shell->args[1]);
+		shell->error = ERR_RUN_FAIL;
+		releaseObject(&obj);
+		return;
+	}
+
+	success = obj.binary ? writeObjectText(&obj, out) : writeObjectBinary(&obj, out);
+	if (fclose(out) != 0 || !success) {
+		printOutput(shell, "%s:   ߽ϴ.\n", shell->args[1]);
+		shell->error = ERR_RUN_FAIL;
+		remove(shell->args[1]);
+	}
+	else if (shell->format == OUTPUT_JSON) {
+		printField(shell, ",\"format\":\"%s\"", obj.binary ? "text" : "binary");
+	}
+	releaseObject(&obj);
+}
+
+/*************************************************************************************
+* : object file ޸𸮿 ø relocation  load map Ѵ.
+*       text İ binary     , binary  segment
+*       Ͽ ޸𸮷 ٷ д´.    ϹǷ undo  ִ.
+*       control section ̸ D record symbol ޸𸮸 ٲٱ  ø ּҷ
+*       symbol table ߰ϰ, ø ϸ ǵ. undoϸ symbol Բ
+*       ǵ.
+* :
+* - loadobj filename: H record  ּҿ ø.
+* - loadobj filename, address: address ø.
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdLoadobj(Shell* shell)
+{
+	ObjectFile obj;
+	unsigned int progaddr = 0;
+	unsigned int delta;
+	unsigned long long change;
+	char* ptr;
+	int loaded;
+	int i;
+
+	if (shell->argc != 1 && shell->argc != 2) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+
+	/* arguments ˻  16 ȯ */
+	if (shell->argc == 2) {
+		progaddr = (unsigned int)strtoul(shell->args[1], &ptr, 16);
+		if (*ptr != 0) {
+			printOutput(shell, "%s: ߸ \n", shell->args[1]);
+			shell->error = ERR_RUN_FAIL;
+			return;
+		}
+		if (progaddr >= MEM_SIZE) {
+			printOutput(shell, "%X: ּҰ ȿ : [0, FFFFF]  ϴ.\n", progaddr);
+			shell->error = ERR_RUN_FAIL;
+			return;
+		}
+	}
+
+	initializeObject(&obj);
+	if (!openObjectFile(&obj, shell->args[0])) {
+		printObjectError(shell, shell->args[0], &obj);
+		shell->error = ERR_RUN_FAIL;
+		releaseObject(&obj);
+		return;
+	}
+	if (shell->argc == 1)
+		progaddr = obj.start;
+	delta = progaddr - obj.start;
+
+	/* symbol ּҴ α׷ ȿ , α׷ ޸    Ű
+	   symbol ޸  ȴ */
+	loaded = obj.length <= MEM_SIZE - progaddr;
+	if (!loaded) {
+		obj.error = OBJ_ERR_LOAD;
+		obj.line_no = 0;
+		printObjectError(shell, shell->args[0], &obj);
+	}
+	for (i = 0; i < obj.sym_cnt && loaded; i++) {
+		if (obj.syms[i].addr + delta >= MEM_SIZE) {
+			printOutput(shell, "%s: symbol %s ּҰ ޸  ϴ.\n", shell->args[0], obj.syms[i].name);
+			loaded = false;
+		}
+	}
+	if (!loaded) {
+		shell->error = ERR_RUN_FAIL;
+		releaseObject(&obj);
+		return;
+	}
+
+	/* symbol ޸𸮸 ٲٱ  ߰ϰ, ޸𸮸 ø ϸ ǵ */
+	change = getSicChange(&shell->machine, 0);
+	loaded = stageSymbol(&shell->symbols, obj.name, progaddr);
+	for (i = 0; i < obj.sym_cnt && loaded; i++)
+		loaded = stageSymbol(&shell->symbols, obj.syms[i].name, obj.syms[i].addr + delta);
+	if (!loaded) {
+		rollbackSymbols(&shell->symbols);
+		printOutput(shell, "symbol  ޸𸮸 Ҵ ߽ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		releaseObject(&obj);
+		return;
+	}
+
+	if (!loadObject(&obj, &shell->machine, progaddr)) {
+		rollbackSymbols(&shell->symbols);
+		printObjectError(shell, shell->args[0], &obj);
+		shell->error = ERR_RUN_FAIL;
+		releaseObject(&obj);
+		return;
+	}
+
+	/* undo  symbol Բ ǵ ̹ ޸ 濡 Ѵ.  ʾ
+	     ȣ ״̴ */
+	if (getSicChange(&shell->machine, 0) == change)
+		change = 0;
+	else
+		change = getSicChange(&shell->machine, 0);
+	if (!commitSymbols(&shell->symbols, change, getSicOldestChange(&shell->machine)))
+		printOutput(shell, "symbol  ޸𸮸 Ҵ ؼ undo  symbol ǵ ʽϴ.\n");
+
+	if (shell->format == OUTPUT_JSON) {
+		printField(shell, ",\"name\":");
+		appendJsonString(&shell->out, obj.name, strlen(obj.name));
+		printField(shell, ",\"start\":%u,\"length\":%u,\"entry\":%u,\"relocations\":%d,\"symbols\":[",
+			progaddr, obj.length, obj.entry + delta, obj.reloc_cnt);
+		for (i = 0; i < obj.sym_cnt; i++) {
+			printField(shell, "%s{\"name\":", i > 0 ? "," : "");
+			appendJsonString(&shell->out, obj.syms[i].name, strlen(obj.syms[i].name));
+			printField(shell, ",\"address\":%u}", obj.syms[i].addr + delta);
+		}
+		printField(shell, "]");
+	}
+	/* load map */
+	else {
+		printOutput(shell, "control  symbol   address  length\n");
+		printOutput(shell, "section  name\n");
+		printOutput(shell, "---------------------------------\n");
+		printOutput(shell, "%-6s            %05X    %05X\n", obj.name, progaddr, obj.length);
+		for (i = 0; i < obj.sym_cnt; i++)
+			printOutput(shell, "         %-6s   %05X\n", obj.syms[i].name, obj.syms[i].addr + delta);
+		printOutput(shell, "---------------------------------\n");
+		printOutput(shell, "entry: %05X, relocation: %d\n", obj.entry + delta, obj.reloc_cnt);
+	}
+
+	STATS_ADD_VM(shell, obj.length);
+	releaseObject(&obj);
+}
+
+/*************************************************************************************
+* : ޸ start end ġ Ѵ.   а 
+*       ޸  ġ а .  page(1000)  ϰ, ROM̳ ٸ
+*       ġ  page   ȴ. ϸ undo  .
+* :
+* - mmio start, end, console:  byte ״ ϴ ġ.  0̴.
+* - mmio start, end, filename: host . start  0° byte̴.
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdMmio(Shell* shell)
+{
+	SicDevice* device;
+	unsigned int addr;
+	unsigned int len;
+
+	if (shell->argc != 3) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+	if (!parsePageRange(shell, &addr, &len))
+		return;
+
+	if (!strcmp(shell->args[2], "console"))
+		device = createConsoleDevice(getOutput(shell));
+	else
+		device = createFileDevice(shell->args[2]);
+	if (device == NULL) {
+		printOutput(shell, "%s: ġ   ϴ.\n", shell->args[2]);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+
+	if (mapSicDevice(&shell->machine, addr, len, device) != SIC_OK) {
+		printOutput(shell, "%X-%X: ̹ ROM̳ ġ  page ֽϴ. ram ǵ ڿ ٽ õϼ.\n",
+			addr, addr + len - 1);
+		shell->error = ERR_RUN_FAIL;
+		device->release(device);
+	}
+}
+
+/*************************************************************************************
+* : ޸ start end ROM .  ״̰,
+*       edit, fill, load     ȴ.  page(1000)  Ѵ.
+*       ٲٸ undo  .
+* :
+* - rom start, end
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdRom(Shell* shell)
+{
+	unsigned int addr;
+	unsigned int len;
+
+	if (shell->argc != 2) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+	if (!parsePageRange(shell, &addr, &len))
+		return;
+
+	if (setSicPages(&shell->machine, addr, len, SIC_PAGE_ROM) != SIC_OK) {
+		printOutput(shell, "%X-%X: ġ  page ֽϴ. ram ǵ ڿ ٽ õϼ.\n",
+			addr, addr + len - 1);
+		shell->error = ERR_RUN_FAIL;
+	}
+}
+
+/*************************************************************************************
+* : ޸ start end ٽ RAM .  ġ ,
+*       ġ  page   ġ ݴ´.  page(1000)  Ѵ.
+*       ٲٸ undo  .
+* :
+* - ram start, end
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdRam(Shell* shell)
+{
+	unsigned int addr;
+	unsigned int len;
+
+	if (shell->argc != 2) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+	if (!parsePageRange(shell, &addr, &len))
+		return;
+
+	if (setSicPages(&shell->machine, addr, len, SIC_PAGE_RAM) != SIC_OK) {
+		printOutput(shell, "%X-%X: page ram ǵ ߽ϴ.\n", addr, addr + len - 1);
+		shell->error = ERR_RUN_FAIL;
+	}
+}
+
+/*************************************************************************************
+* : ޸ page table Ѵ.  ġ  page ̾  ٷ
+*       ļ " ּ  ּ  ġ"  ش.
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdMemmap(Shell* shell)
+{
+	static const char* type_names[] = { "RAM", "ROM", "MMIO" };
+	static const char* json_names[] = { "ram", "rom", "mmio" };
+	const SicPage* pages = shell->machine.pages;
+	int start;
+	int end;
+	int cnt = 0;
+
+	if (shell->argc != 0) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+
+	if (shell->format == OUTPUT_JSON)
+		printField(shell, ",\"regions\":[");
+
+	for (start = 0; start < SIC_PAGE_CNT; start = end) {
+		const SicDevice* device = pages[start].device;
+
+		/* ġ offset ̾ page  ٷ ģ */
+		for (end = start + 1; end < SIC_PAGE_CNT; end++) {
+			if (pages[end].type != pages[start].type || pages[end].device != device)
+				break;
+			if (device != NULL &&
+				pages[end].offset != pages[start].offset + (unsigned int)((end - start) << SIC_PAGE_SHIFT))
+				break;
+		}
+
+		if (shell->format == OUTPUT_JSON) {
+			printField(shell, "%s{\"start\":%d,\"end\":%d,\"type\":\"%s\",\"device\":", cnt > 0 ? "," : "",
+				start << SIC_PAGE_SHIFT, (end << SIC_PAGE_SHIFT) - 1, json_names[pages[start].type]);
+			if (device != NULL)
+				appendJsonString(&shell->out, device->name, strlen(device->name));
+			else
+				printField(shell, "null");
+			printField(shell, "}");
+		}
+		else {
+			if (device != NULL)
+				printOutput(shell, "%05X %05X %-4s %s\n", start << SIC_PAGE_SHIFT, (end << SIC_PAGE_SHIFT) - 1,
+					type_names[pages[start].type], device->name);
+			else
+				printOutput(shell, "%05X %05X %s\n", start << SIC_PAGE_SHIFT, (end << SIC_PAGE_SHIFT) - 1,
+					type_names[pages[start].type]);
+		}
+		cnt++;
+	}
+
+	if (shell->format == OUTPUT_JSON)
+		printField(shell, "]");
+}
+
+/*************************************************************************************
+* : opcode.txt   о opcode table   ٲ۴. ٸ
+*       session opcode ã ־  , ٲ ڿ ϴ ɺ 
+*       table . server  session table Բ ٲ.
+* :
+* - shell: shell    ִ ü  
+* - opreload [filename]: filename   opcode.txt ٽ д´.
+* ȯ: 
+*************************************************************************************/
+void runCmdOpreload(Shell* shell)
+{
+	const char* path = shell->argc == 1 ? shell->args[0] : OPCODE_FILE;
+	const SicOpTable* table;
+	char* text;
+	size_t len;
+	int result;
+	int cnt = 0;
+	int i;
+
+	if (shell->argc > 1) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+
+	text = readTextFile(path, &len);
+	if (text == NULL) {
+		printOutput(shell, "%s:    ϴ.\n", path);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	result = loadSicOpcodes(&shell->machine, text, len);
+	free(text);
+
+	if (result == SIC_ERR_BUSY) {
+		printOutput(shell, "ٸ  opcode table ٲٰ ֽϴ.  Ŀ ٽ õϼ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	if (result != SIC_OK) {
+		printOutput(shell, "޸𸮸 Ҵ ߽ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+
+	/*  table opcode   */
+	table = beginSicLookup(&shell->machine);
+	for (i = 0; i < BUCKET_SIZE; i++) {
+		Node* ptr;
+		for (ptr = table->table.buckets[i].head; ptr != NULL; ptr = ptr->next)
+			cnt++;
+	}
+	endSicLookup(&shell->machine);
+
+	if (shell->format == OUTPUT_JSON)
+		printField(shell, ",\"opcodes\":%d", cnt);
+	else
+		printOutput(shell, "%s: opcode %d оϴ.\n", path, cnt);
+}
+
+/*************************************************************************************
+* : ޸ source length byte destination ű.  
+*       ĵ ű   ״ Ű. undo  ִ.
+* :
+* - shell: shell    ִ ü  
+* - move source, destination, length:  16
+* ȯ: 
+*************************************************************************************/
+void runCmdMove(Shell* shell)
+{
+	int src;
+	int dst;
+	int len;
+	int result;
+
+	if (shell->argc != 3) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+	if (!parseBlockRange(shell, &src, &dst, &len))
+		return;
+
+	result = moveSicMemory(&shell->machine, (unsigned int)dst, (unsigned int)src, (unsigned int)len);
+	if (result == SIC_ERR_ROM) {
+		printOutput(shell, "%X-%X: ROM ִ    ϴ.\n", dst, dst + len - 1);
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	if (result != SIC_OK) {
+		printOutput(shell, "޸𸮸 Ҵ ߽ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return;
+	}
+	STATS_ADD_VM(shell, 2 * len);
+}
+
+/*************************************************************************************
+* : ޸ address1 address2 length byte Ͽ  ٸ
+*        Ѵ.  κ memcmp  block ǳʶٰ, ٸ byte
+*       ̾    ´.  COMPARE_LINE_MAX ϰ
+*         .
+* :
+* - shell: shell    ִ ü  
+* - compare address1, address2, length:  16
+* ȯ: 
+*************************************************************************************/
+void runCmdCompare(Shell* shell)
+{
+	const char* data0;
+	const char* data1;
+	char* copy0;
+	char* copy1;
+	int addr0;
+	int addr1;
+	int len;
+	int pos;
+	int cnt = 0;
+	int total = 0;
+
+	if (shell->argc != 3) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+	if (!parseBlockRange(shell, &addr0, &addr1, &len))
+		return;
+
+	data0 = getMemory(shell, addr0, len, &copy0);
+	if (data0 == NULL)
+		return;
+	data1 = getMemory(shell, addr1, len, &copy1);
+	if (data1 == NULL) {
+		free(copy0);
+		return;
+	}
+
+	if (shell->format == OUTPUT_JSON)
+		printField(shell, ",\"ranges\":[");
+
+	for (pos = findDifference(data0, data1, 0, len); pos < len; pos = findDifference(data0, data1, pos, len)) {
+		int start = pos;
+
+		while (pos < len && data0[pos] != data1[pos])
+			pos++;
+
+		if (cnt < COMPARE_LINE_MAX) {
+			if (shell->format == OUTPUT_JSON)
+				printField(shell, "%s{\"address1\":%d,\"address2\":%d,\"length\":%d}", cnt > 0 ? "," : "",
+					addr0 + start, addr1 + start, pos - start);
+			else
+				printOutput(shell, "%05X-%05X  %05X-%05X  (%X)\n", addr0 + start, addr0 + pos - 1,
+					addr1 + start, addr1 + pos - 1, pos - start);
+		}
+		cnt++;
+		total += pos - start;
+	}
+
+	if (shell->format == OUTPUT_JSON)
+		printField(shell, "],\"count\":%d,\"bytes\":%d", cnt, total);
+	else if (cnt == 0)
+		printOutput(shell, "   ϴ.\n");
+	else {
+		if (cnt > COMPARE_LINE_MAX)
+			printOutput(shell, "... %d   ãҽϴ.\n", cnt - COMPARE_LINE_MAX);
+		printOutput(shell, "ٸ  %d, %X byte\n", cnt, total);
+	}
+
+	free(copy0);
+	free(copy1);
+	STATS_ADD_VM(shell, 2 * len);
+}
+
+/*************************************************************************************
+* : symbol table ȸѴ. ̸  ּ  index  Ž ã´.
+* :
+* - symbol:  symbol ̸  Ѵ.
+* - symbol prefix: ̸ prefix ϴ symbol ̸  Ѵ.
+* - symbol @address: address̰ų     symbol Ÿ Ѵ.
+* - symbol @start, end: ּҰ [start, end] symbol ּ  Ѵ.
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCmdSymbol(Shell* shell)
+{
+	SymbolTable* symbols = &shell->symbols;
+	Symbol** list;
+	unsigned long addrs[2];
+	char* ptr;
+	int first;
+	int last;
+	int i;
+
+	if (shell->argc > 2 || (shell->argc == 2 && shell->args[0][0] != '@')) {
+		shell->error = ERR_INVALID_USE;
+		return;
+	}
+
+	/* ̸ ã */
+	if (shell->argc == 0 || shell->args[0][0] != '@') {
+		first = findSymbolPrefix(symbols, shell->argc == 0 ? "" : shell->args[0], &last);
+		list = symbols->by_name;
+	}
+	/* ּҷ ã */
+	else {
+		for (i = 0; i < shell->argc; i++) {
+			const char* arg = shell->args[i][0] == '@' ? shell->args[i] + 1 : shell->args[i];
+
+			addrs[i] = strtoul(arg, &ptr, 16);
+			if (*arg == 0 || *ptr != 0) {
+				printOutput(shell, "%s: ߸ \n", shell->args[i]);
+				shell->error = ERR_RUN_FAIL;
+				return;
+			}
+			if (addrs[i] >= MEM_SIZE) {
+				printOutput(shell, "%lX: ּҰ ȿ : [0, FFFFF]  ϴ.\n", addrs[i]);
+				shell->error = ERR_RUN_FAIL;
+				return;
+			}
+		}
+
+		if (shell->argc == 1) {
+			const Symbol* symbol = findSymbolAt(symbols, (unsigned int)addrs[0]);
+
+			if (shell->format == OUTPUT_JSON) {
+				if (symbol == NULL)
+					printField(shell, ",\"symbol\":null");
+				else {
+					printField(shell, ",\"symbol\":{\"name\":");
+					appendJsonString(&shell->out, symbol->name, strlen(symbol->name));
+					printField(shell, ",\"address\":%u,\"offset\":%u}", symbol->addr,
+						(unsigned int)addrs[0] - symbol->addr);
+				}
+			}
+			else if (symbol == NULL)
+				printOutput(shell, "%05lX: տ ִ symbol ϴ.\n", addrs[0]);
+			else if (symbol->addr == addrs[0])
+				printOutput(shell, "%05lX  %s\n", addrs[0], symbol->name);
+			else
+				printOutput(shell, "%05lX  %s+%X\n", addrs[0], symbol->name, (unsigned int)addrs[0] - symbol->addr);
+			return;
+		}
+
+		if (addrs[0] > addrs[1]) {
+			printOutput(shell, "߸ :  ּҰ  ּҰ ʰϿϴ.\n");
+			shell->error = ERR_RUN_FAIL;
+			return;
+		}
+		first = findSymbolRange(symbols, (unsigned int)addrs[0], (unsigned int)addrs[1], &last);
+		list = symbols->by_addr;
+	}
+
+	if (shell->format == OUTPUT_JSON) {
+		printField(shell, ",\"symbols\":[");
+		for (i = first; i < last; i++) {
+			printField(shell, "%s{\"name\":", i > first ? "," : "");
+			appendJsonString(&shell->out, list[i]->name, strlen(list[i]->name));
+			printField(shell, ",\"address\":%u}", list[i]->addr);
+		}
+		printField(shell, "]");
+		return;
+	}
+	for (i = first; i < last; i++)
+		printOutput(shell, "%-6s   %05X\n", list[i]->name, list[i]->addr);
+}
+
+/*************************************************************************************
+* : shell  cmd_code ̿Ͽ ش code ε Լ ȣ
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void runCommand(Shell* shell)
+{
+	if (shell->cmd_code < 0 || shell->cmd_code >= CMD_CNT) {
+		shell->error = ERR_NO_CMD;
+		return;
+	}
+	else {
+#ifdef SHELL_STATS
+		if (shell->stats != NULL) {
+			beginStats(shell->stats);
+			shell->cmds[shell->cmd_code](shell);
+			endStats(shell->stats, shell->cmd_code, shell->error);
+		}
+		else
+#endif
+		shell->cmds[shell->cmd_code](shell);
+		if (shell->error == ERR_NONE)
+			addList(&shell->history, strdup(shell->cmd_line));
+	}
+}
+
+/*************************************************************************************
+* : shell ü   history list ʱȭϰ ɾ Լ Ѵ.
+*        ޸𸮿 opcode table ϰ initializeShell initializeSession
+*        ϴ ۾̴.
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+static void initializeState(Shell* shell)
+{
+	int i;
+
+	/* init variables */
+	shell->cmd_code = CMD_INVALID;
+	shell->argc = 0;
+	shell->quit = false;
+	shell->init = false;
+	shell->mem_addr = 0;
+	shell->error = ERR_NONE;
+	shell->vm_origin = NULL;
+	shell->format = OUTPUT_TEXT;
+	initializeOutput(&shell->out, fileno(stdout));
+	initializeOutput(&shell->capture, -1);
+	shell->stats = NULL;
+
+	for (i = 0; i < ARG_CNT_MAX; i++) {
+		memset(shell->args[i], 0, sizeof(char) * ARG_LEN_MAX);
+	}
+
+	/* init list */
+	initializeList(&shell->history);
+	initializeSymbols(&shell->symbols);
+
+	/* command function mapping */
+	shell->cmds[CMD_HELP] = runCmdHelp;
+	shell->cmds[CMD_DIR] = runCmdDir;
+	shell->cmds[CMD_QUIT] = runCmdQuit;
+	shell->cmds[CMD_HISTORY] = runCmdHistory;
+	shell->cmds[CMD_DUMP] = runCmdDump;
+	shell->cmds[CMD_EDIT] = runCmdEdit;
+	shell->cmds[CMD_FILL] = runCmdFill;
+	shell->cmds[CMD_RESET] = runCmdReset;
+	shell->cmds[CMD_OPCODE] = runCmdOpcode;
+	shell->cmds[CMD_OPLIST] = runCmdOplist;
+	shell->cmds[CMD_DISASM] = runCmdDisasm;
+	shell->cmds[CMD_STATS] = runCmdStats;
+	shell->cmds[CMD_SAVE] = runCmdSave;
+	shell->cmds[CMD_LOAD] = runCmdLoad;
+	shell->cmds[CMD_MMAP] = runCmdMmap;
+	shell->cmds[CMD_MUNMAP] = runCmdMunmap;
+	shell->cmds[CMD_MACRO] = runCmdMacro;
+	shell->cmds[CMD_UNDO] = runCmdUndo;
+	shell->cmds[CMD_REDO] = runCmdRedo;
+	shell->cmds[CMD_OBJCONV] = runCmdObjconv;
+	shell->cmds[CMD_LOADOBJ] = runCmdLoadobj;
+	shell->cmds[CMD_MMIO] = runCmdMmio;
+	shell->cmds[CMD_ROM] = runCmdRom;
+	shell->cmds[CMD_RAM] = runCmdRam;
+	shell->cmds[CMD_MEMMAP] = runCmdMemmap;
+	shell->cmds[CMD_OPRELOAD] = runCmdOpreload;
+	shell->cmds[CMD_MOVE] = runCmdMove;
+	shell->cmds[CMD_COMPARE] = runCmdCompare;
+	shell->cmds[CMD_SYMBOL] = runCmdSymbol;
+}
+
+/*************************************************************************************
+* :    shell  (shell->out) Ѵ.
+*       interactive mode stdout̰, server mode client socket̴.
+*       OUTPUT_JSON ̸ record output ڿ    Ƶд.
+* :
+* - shell: shell    ִ ü  
+* - format: printf   ڿ
+* ȯ: 
+*************************************************************************************/
+static void printOutput(Shell* shell, const char* format, ...)
+{
+	va_list ap;
+	int len;
+
+	va_start(ap, format);
+	len = formatOutput(getOutput(shell), format, ap);
+	va_end(ap);
+
+	if (len > 0)
+		STATS_ADD_OUTPUT(shell, len);
+}
+
+/*************************************************************************************
+* : OUTPUT_JSON Ŀ   record field Ѵ. format
+*       ",\"name\":value"ó  field ϴ ',' ؾ Ѵ.
+* :
+* - shell: shell    ִ ü  
+* - format: printf   ڿ
+* ȯ: 
+*************************************************************************************/
+static void printField(Shell* shell, const char* format, ...)
+{
+	va_list ap;
+	int len;
+
+	va_start(ap, format);
+	len = formatOutput(&shell->out, format, ap);
+	va_end(ap);
+
+	if (len > 0)
+		STATS_ADD_OUTPUT(shell, len);
+}
+
+/*************************************************************************************
+* :     ۸ .
+* :
+* - shell: shell    ִ ü  
+* ȯ: OUTPUT_JSON̸ record   Ƶδ capture, ƴϸ out
+*************************************************************************************/
+static Output* getOutput(Shell* shell)
+{
+	return shell->format == OUTPUT_JSON ? &shell->capture : &shell->out;
+}
+
+/*************************************************************************************
+* : OUTPUT_JSON Ŀ  ϳ record Ѵ.  ̸ Է 
+*       ϰ,  ϴ field ڿ ̾.
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+static void beginRecord(Shell* shell)
+{
+	if (shell->error == ERR_NO_CMD)
+		printField(shell, "{\"command\":null,\"line\":");
+	else
+		printField(shell, "{\"command\":\"%s\",\"line\":", getCommandName(shell->cmd_code));
+	appendJsonString(&shell->out, shell->cmd_line, strlen(shell->cmd_line));
+}
+
+/*************************************************************************************
+* : OUTPUT_JSON Ŀ  ϳ record .  ¸ ASCII error
+*       code,    output ڿ ϰ  ٲ۴.
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+static void endRecord(Shell* shell)
+{
+	printField(shell, ",\"status\":\"%s\",\"output\":", getErrorName(shell->error));
+	appendJsonString(&shell->out, shell->capture.buffer, shell->capture.len);
+	appendOutput(&shell->out, "}\n", 2);
+	clearOutput(&shell->capture);
+}
+
+/*************************************************************************************
+* : dump   . "ּ 16 ; ASCII" ̸ [start_addr, end_addr]
+*         ĭ ΰ,    ڴ '.' ش.
+* :
+* - dst:    . DUMP_LINE_LEN ̻  ־ Ѵ.
+* - data: start_addr ޸
+* - base:   ּ. MEM_LINE 
+* - start_addr, end_addr:  
+* ȯ:   . ׻ DUMP_LINE_LEN
+*************************************************************************************/
+static int formatDumpLine(char* dst, const char* data, int base, int start_addr, int end_addr)
+{
+	char* ascii = dst + 6 + MEM_LINE * 3 + 2;
+	int i;
+
+	for (i = 4; i >= 0; i--)
+		dst[4 - i] = hex_digits[(base >> (i * 4)) & 0xF];
+	dst[5] = ' ';
+	dst += 6;
+
+	for (i = 0; i < MEM_LINE; i++) {
+		int addr = base + i;
+
+		if (addr >= start_addr && addr <= end_addr) {
+			unsigned char value = (unsigned char)data[addr - start_addr];
+			dst[0] = hex_digits[value >> 4];
+			dst[1] = hex_digits[value & 0xF];
+			ascii[i] = value >= 0x20 && value <= 0x7E ? (char)value : '.';
+		}
+		else {
+			dst[0] = ' ';
+			dst[1] = ' ';
+			ascii[i] = '.';
+		}
+		dst[2] = ' ';
+		dst += 3;
+	}
+	dst[0] = ';';
+	dst[1] = ' ';
+	ascii[MEM_LINE] = '\n';
+
+	return DUMP_LINE_LEN;
+}
+
+/*************************************************************************************
+* : ش  ڵ忡 شϴ  . OUTPUT_JSON ̸  ʴ´.
+* :
+* - shell: shell    ִ ü  
+* - err_code: error Ÿ 
+* ȯ: 
+*************************************************************************************/
+static void printError(Shell* shell, int err_code)
+{
+	/* JSON record status error code Ƿ   ʴ´ */
+	if (shell->format == OUTPUT_JSON)
+		return;
+
+	switch (err_code) {
+	case ERR_NONE:
+	case ERR_EMPTY:
+		break;
+
+	case ERR_INIT:
+		printOutput(shell, "Shell ʱȭϴµ ߽ϴ. մϴ.\n");
+		break;
+
+	case ERR_NO_CMD:
+		printOutput(shell, "   Դϴ. h[elp] ԷϿ   Ȯϼ.\n");
+		break;
+
+	case ERR_INVALID_USE:
+		printOutput(shell, " ڰ ߸Ǿϴ. h[elp] ԷϿ  Ȯϼ.\n");
+		break;
+
+	case ERR_RUN_FAIL:
+		printOutput(shell, "   ϴ.\n");
+		break;
+
+	default:
+		printOutput(shell, "   \n");
+		break;
+	}
+}
+
+/*************************************************************************************
+* :  ڵ带 JSON record status  ASCII ̸ ٲ۴.
+* :
+* - err_code: error Ÿ 
+* ȯ: "ok", "init", "no_cmd", "invalid_use", "run_fail"  ϳ
+*************************************************************************************/
+static const char* getErrorName(int err_code)
+{
+	switch (err_code) {
+	case ERR_NONE:        return "ok";
+	case ERR_INIT:        return "init";
+	case ERR_NO_CMD:      return "no_cmd";
+	case ERR_INVALID_USE: return "invalid_use";
+	default:              return "run_fail";
+	}
+}
+
+/*************************************************************************************
+* : macro ó error code شϴ  ȯѴ. macro.c code
+*       , ڿ   ٸ °  ڵ ⿡ д.
+* :
+* - error: MACRO_ERR_*  ϳ
+* ȯ: error  
+*************************************************************************************/
+static const char* getMacroErrorMessage(int error)
+{
+	switch (error) {
+	case MACRO_ERR_NONE:    return "";
+	case MACRO_ERR_MEMORY:  return "޸𸮸 Ҵ ߽ϴ.";
+	case MACRO_ERR_LINE:    return " ʹ ϴ.";
+	case MACRO_ERR_NAME:    return "MACRO ̸(label) ϴ.";
+	case MACRO_ERR_PARAM:   return " ǰ ߸Ǿų ǵ  ڸ մϴ.";
+	case MACRO_ERR_NO_MEND: return "MEND   ϴ.";
+	case MACRO_ERR_MEND:    return "MACRO  MEND Խϴ.";
+	case MACRO_ERR_COND:    return "IF, ELSE, ENDIF ¦  ʽϴ.";
+	case MACRO_ERR_ARG:     return "macro ȣ ڰ ߸Ǿϴ.";
+	case MACRO_ERR_DEPTH:   return "macro ȣ ʹ  øǾϴ.";
+	case MACRO_ERR_EXPR:    return "IF ǽ ߸Ǿϴ.";
+	default:                return "   ";
+	}
+}
+
+
+/*************************************************************************************
+* : object file error code شϴ  ȯѴ. objfile.c code
+*       , ڿ   ٸ °  ڵ ⿡ д.
+* :
+* - error: OBJ_ERR_*  ϳ
+* ȯ: error  
+*************************************************************************************/
+static const char* getObjectErrorMessage(int error)
+{
+	switch (error) {
+	case OBJ_ERR_NONE:   return "";
+	case OBJ_ERR_IO:     return " аų   ϴ.";
+	case OBJ_ERR_MEMORY: return "޸𸮸 Ҵ ߽ϴ.";
+	case OBJ_ERR_LINE:   return " ʹ ϴ.";
+	case OBJ_ERR_RECORD: return "record  ߸Ǿϴ.";
+	case OBJ_ERR_HEADER: return "H record header ų ߸Ǿϴ.";
+	case OBJ_ERR_RANGE:  return "record ּҰ α׷  ϴ.";
+	case OBJ_ERR_RELOC:  return " ʴ M recordԴϴ. (ٸ control section symbol)";
+	case OBJ_ERR_LOAD:   return "α׷ ޸  ų ROM, ġ Ĩϴ.";
+	default:             return "   ";
+	}
+}
+
+/*************************************************************************************
+* : opcode.txt  о opcode  (code, mnemonic, format)
+*       machine opcode table Ѵ. Ľ loadSicOpcodes Ѵ.
+* :
+* - shell: shell    ִ ü  
+* ȯ: 
+*************************************************************************************/
+void parseOpcode(Shell* shell)
+{
+	size_t len;
+	char* text = readTextFile(OPCODE_FILE, &len);
+
+	if (text == NULL || loadSicOpcodes(&shell->machine, text, len) != SIC_OK)
+		shell->error = ERR_INIT;
+	free(text);
+}
+
+/*************************************************************************************
+* :   command-line ĽϿ command argument ´.
+*       ܰ ߻ ʴ´ٸ, command-line  ϰ, command
+*        code ִ 3 argument ϰ ȴ.
+* :
+* - shell: shell    ִ ü  
+* - line: ڰ Է  
+* ȯ: 
+*************************************************************************************/
+void parseCommandLine(Shell* shell, const char* line)
+{
+	char buffer[LINE_MAX] = { 0, };
+	char* ptr;
+	char* ptr2;
+	size_t len;
+
+	/*   */
+	strncpy(buffer, line, LINE_MAX - 1);
+
+	/* \n , socket  Է \r\n   ִ */
+	len = strlen(buffer);
+	while (len > 0 && (buffer[len - 1] == '\n' || buffer[len - 1] == '\r'))
+		buffer[--len] = 0;
+
+	/* shell command line Ͽ  */
+	strncpy(shell->cmd_line, buffer, LINE_MAX);
+
+	/* ɾ Ľ.  session ÿ ĽϹǷ static ¸  strtok  ʴ´ */
+	for (ptr = buffer; *ptr == ' ' || *ptr == '\t'; ptr++);
+	for (ptr2 = ptr; *ptr2 != 0 && *ptr2 != ' ' && *ptr2 != '\t'; ptr2++);
+
+	/*  ڿ   ó */
+	if (ptr == ptr2) {
+		shell->error = ERR_EMPTY;
+		return;
+	}
+	if (*ptr2 != 0)
+		*ptr2++ = 0;
+
+	/*  ڿ ڵ ȯ */
+	shell->cmd_code = getCommandCode(ptr);
+	if (shell->cmd_code == CMD_INVALID) {
+		shell->error = ERR_NO_CMD;
+		return;
+	}
+
+	/* ɿ  ڸ Ľ */
+	ptr = ptr2;
+	if (*ptr == 0) {
+		shell->argc = 0;
+		return;
+	}
+
+	/* ڴ ','  */
 	/* argument0 */
 	for (ptr2 = ptr; *ptr2 != 0 && *ptr2 != ','; ptr2++);
 	if (*ptr2 == 0) {
@@ -751,7 +2368,7 @@ static char* trim(char* start, char* end)
 * - cmd: ɾ ڿ
 * ȯ: ش ɾ ڿ εǴ  ȯ
 *************************************************************************************/
-static int getCommandCode(char* cmd)
+int getCommandCode(char* cmd)
 {
 	if (cmd == NULL)
 		return CMD_INVALID;
@@ -775,42 +2392,67 @@ static int getCommandCode(char* cmd)
 		return CMD_OPCODE;
 	else if (!strncmp(cmd, "opcodelist", CMD_LEN_MAX))
 		return CMD_OPLIST;
+	else if (!strncmp(cmd, "disasm", CMD_LEN_MAX))
+		return CMD_DISASM;
+	else if (!strncmp(cmd, "stats", CMD_LEN_MAX))
+		return CMD_STATS;
+	else if (!strncmp(cmd, "save", CMD_LEN_MAX))
+		return CMD_SAVE;
+	else if (!strncmp(cmd, "load", CMD_LEN_MAX))
+		return CMD_LOAD;
+	else if (!strncmp(cmd, "mmap", CMD_LEN_MAX))
+		return CMD_MMAP;
+	else if (!strncmp(cmd, "munmap", CMD_LEN_MAX))
+		return CMD_MUNMAP;
+	else if (!strncmp(cmd, "macro", CMD_LEN_MAX))
+		return CMD_MACRO;
+	else if (!strncmp(cmd, "undo", CMD_LEN_MAX))
+		return CMD_UNDO;
+	else if (!strncmp(cmd, "redo", CMD_LEN_MAX))
+		return CMD_REDO;
+	else if (!strncmp(cmd, "objconv", CMD_LEN_MAX))
+		return CMD_OBJCONV;
+	else if (!strncmp(cmd, "loadobj", CMD_LEN_MAX))
+		return CMD_LOADOBJ;
+	else if (!strncmp(cmd, "mmio", CMD_LEN_MAX))
+		return CMD_MMIO;
+	else if (!strncmp(cmd, "rom", CMD_LEN_MAX))
+		return CMD_ROM;
+	else if (!strncmp(cmd, "ram", CMD_LEN_MAX))
+		return CMD_RAM;
+	else if (!strncmp(cmd, "memmap", CMD_LEN_MAX))
+		return CMD_MEMMAP;
+	else if (!strncmp(cmd, "opreload", CMD_LEN_MAX))
+		return CMD_OPRELOAD;
+	else if (!strncmp(cmd, "move", CMD_LEN_MAX))
+		return CMD_MOVE;
+	else if (!strncmp(cmd, "compare", CMD_LEN_MAX))
+		return CMD_COMPARE;
+	else if (!strncmp(cmd, "symbol", CMD_LEN_MAX))
+		return CMD_SYMBOL;
 	else
 		return CMD_INVALID;
 }
 
 /*************************************************************************************
-* : ڷ ޵ keyκ  hash  .
-*       ⺻ Ǵ hash function ̴.
+* :  code شϴ ɾ ̸( ̸) ȯѴ.
 * :
-* - key: key
-* ȯ: ش key ̿Ͽ  hash 
+* - cmd_code:  code
+* ȯ: ɾ ̸, ߸ code̸ "invalid"
 *************************************************************************************/
-static int hashFunc(void* key)
+const char* getCommandName(int cmd_code)
 {
-	char* str = (char*)key;
-	int i, sum;
-	int len = strlen(str);
-	for (i = 0, sum = 0; i< len; i++)
-		sum += str[i];
-
-	return sum % 20;
-}
-
-/*************************************************************************************
-* :  key  hash table entry ߿  key  ִ
-*       entry ã   Լ̴.
-* :
-* - key0: entry key Ȥ ڰ ˻ ϴ key.  ϹǷ .
-* - key1: ڰ ˻ ϴ key Ȥ entry key.  ϹǷ .
-* ȯ:  0, ٸ  ̿ 
-*************************************************************************************/
-static int hashCmp(void* key0, void* key1)
-{
-	char* str_a = (char*)key0;
-	char* str_b = (char*)key1;
-
-	return strcmp(str_a, str_b);
+	static const char* names[CMD_CNT] = {
+		"help", "dir", "quit", "history", "dump", "edit",
+		"fill", "reset", "opcode", "opcodelist", "disasm", "stats",
+		"save", "load", "mmap", "munmap", "macro", "undo", "redo",
+		"objconv", "loadobj", "mmio", "rom", "ram", "memmap", "opreload",
+		"move", "compare", "symbol"
+	};
+
+	if (cmd_code < 0 || cmd_code >= CMD_CNT)
+		return "invalid";
+	return names[cmd_code];
 }
 
 /*************************************************************************************
@@ -830,23 +2472,255 @@ static void releaseHistory(void* data, void* aux)
 }
 
 /*************************************************************************************
-* : opcodelist hash table Ǵµ,  entry key ڿ ҴǷ,
-*       Ҵ ޸𸮸  ־ Ѵ. hash table  entry Ǵ
-*       action function data Ҵ ޸𸮸 ϴ  Ѵ.
+* : mmap   ϰ vm mmapϱ  ޸𸮷 ǵ.
+*       shared mapping ϱ  ٲ  Ͽ Ѵ. ޸ ü
+*       ٲǷ ޸𸮿 symbol   .
 * :
-* - data: list  item 
-* - aux: ߰ ʿϸ Ȱϱ  . auxiliary
+* - shell: shell    ִ ü  
 * ȯ: 
 *************************************************************************************/
-static void releaseOplist(void* data, void* aux)
+static void releaseMapping(Shell* shell)
 {
-	if (data != NULL) {
-		Entry* entry = (Entry*)data;
-		if (entry->key != NULL)
-			free(entry->key);
-		if (entry->value != NULL) {
-			free(entry->value);
+#ifndef _WIN32
+	char* vm;
+
+	if (shell->vm_origin == NULL)
+		return;
+
+	setSicMemory(&shell->machine, shell->vm_origin, &vm);
+	dropSymbolEdits(&shell->symbols);
+	shell->vm_origin = NULL;
+	msync(vm, MEM_SIZE, MS_SYNC);
+	munmap(vm, MEM_SIZE);
+#endif
+}
+
+/*************************************************************************************
+* : ޸ [addr, addr + len)   ͸ ´. ġ  page
+*         ʰ ޸𸮸 ״ Ű,  ġ   е
+*        ü  Ҵ ۿ од. ϸ  Ѵ.
+* :
+* - shell: shell    ִ ü  
+* - addr, len:  . ޸ ȿ ־ Ѵ.
+* - copy: Ҵ ۸  . Ҵ ʾ NULL̸   ڿ freeѴ.
+* ȯ: addr 뿡  . ޸𸮸 Ҵ ϸ NULL
+*************************************************************************************/
+static const char* getMemory(Shell* shell, int addr, int len, char** copy)
+{
+	const char* data = getSicDirect(&shell->machine, (unsigned int)addr, (unsigned int)len);
+
+	*copy = NULL;
+	if (data != NULL)
+		return data;
+
+	*copy = (char*)malloc((size_t)len);
+	if (*copy == NULL) {
+		printOutput(shell, "޸𸮸 Ҵ ߽ϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return NULL;
+	}
+	readSicMemory(&shell->machine, (unsigned int)addr, *copy, (unsigned int)len);
+	return *copy;
+}
+
+/*************************************************************************************
+* : args[0], args[1] start, end page   д´. start page
+*       ù ּ, end page  ּҿ Ѵ. ߸Ǿ  Ѵ.
+* :
+* - shell: shell    ִ ü  
+* - addr, len:    ּҿ ũ⸦  
+* ȯ: ϸ true, ϸ false
+*************************************************************************************/
+static int parsePageRange(Shell* shell, unsigned int* addr, unsigned int* len)
+{
+	char* ptr;
+	unsigned long start_addr;
+	unsigned long end_addr;
+
+	/* arguments ˻  16 ȯ */
+	start_addr = strtoul(shell->args[0], &ptr, 16);
+	if (*ptr != 0) {
+		printOutput(shell, "%s: ߸ \n", shell->args[0]);
+		shell->error = ERR_RUN_FAIL;
+		return false;
+	}
+	end_addr = strtoul(shell->args[1], &ptr, 16);
+	if (*ptr != 0) {
+		printOutput(shell, "%s: ߸ \n", shell->args[1]);
+		shell->error = ERR_RUN_FAIL;
+		return false;
+	}
+
+	/* check range */
+	if (start_addr >= MEM_SIZE) {
+		printOutput(shell, "%lX: ּҰ ȿ : [0, FFFFF]  ϴ.\n", start_addr);
+		shell->error = ERR_RUN_FAIL;
+		return false;
+	}
+	if (end_addr >= MEM_SIZE) {
+		printOutput(shell, "%lX: ּҰ ȿ : [0, FFFFF]  ϴ.\n", end_addr);
+		shell->error = ERR_RUN_FAIL;
+		return false;
+	}
+	if (start_addr > end_addr) {
+		printOutput(shell, "߸ :  ּҰ  ּҰ ʰϿϴ.\n");
+		shell->error = ERR_RUN_FAIL;
+		return false;
+	}
+	if (start_addr % SIC_PAGE_SIZE != 0 || (end_addr + 1) % SIC_PAGE_SIZE != 0) {
+		printOutput(shell, "%lX-%lX: page(%X)   ƴմϴ.\n", start_addr, end_addr, SIC_PAGE_SIZE);
+		shell->error = ERR_RUN_FAIL;
+		return false;
+	}
+
+	*addr = (unsigned int)start_addr;
+	*len = (unsigned int)(end_addr - start_addr + 1);
+	return true;
+}
+
+/*************************************************************************************
+* : args[0], args[1], args[2]   ּҿ ̷ д´.  ּҺ ̸ŭ
+*        ޸ ȿ ־ Ѵ. ߸Ǿ  Ѵ.
+* :
+* - shell: shell    ִ ü  
+* - addr0, addr1, len:   ּҿ ̸  
+* ȯ: ϸ true, ϸ false
+*************************************************************************************/
+static int parseBlockRange(Shell* shell, int* addr0, int* addr1, int* len)
+{
+	unsigned long values[3];
+	char* ptr;
+	int i;
+
+	/* arguments ˻  16 ȯ */
+	for (i = 0; i < 3; i++) {
+		values[i] = strtoul(shell->args[i], &ptr, 16);
+		if (*ptr != 0) {
+			printOutput(shell, "%s: ߸ \n", shell->args[i]);
+			shell->error = ERR_RUN_FAIL;
+			return false;
 		}
-		free(data);
 	}
+
+	/* check range */
+	for (i = 0; i < 2; i++) {
+		if (values[i] >= MEM_SIZE) {
+			printOutput(shell, "%lX: ּҰ ȿ : [0, FFFFF]  ϴ.\n", values[i]);
+			shell->error = ERR_RUN_FAIL;
+			return false;
+		}
+	}
+	if (values[2] == 0 || values[2] > MEM_SIZE - values[0] || values[2] > MEM_SIZE - values[1]) {
+		printOutput(shell, "%lX: ̰ ȿ  ϴ.  ּҺ ̸ŭ [0, FFFFF] ȿ ־ մϴ.\n",
+			values[2]);
+		shell->error = ERR_RUN_FAIL;
+		return false;
+	}
+
+	*addr0 = (int)values[0];
+	*addr1 = (int)values[1];
+	*len = (int)values[2];
+	return true;
+}
+
+/*************************************************************************************
+* : 16 ڿ  ڸ byte о pattern .
+* :
+* - arg:  ڿ. ̰ ¦̰ PATTERN_MAX byte  ʾƾ Ѵ.
+* - pattern:  byte  . PATTERN_MAX byte ̻̾ Ѵ.
+* ȯ: pattern . ߸ ڿ̸ 0
+*************************************************************************************/
+static int parsePattern(const char* arg, unsigned char* pattern)
+{
+	size_t len = strlen(arg);
+	size_t i;
+
+	if (len == 0 || len % 2 != 0 || len / 2 > PATTERN_MAX)
+		return 0;
+
+	for (i = 0; i < len; i += 2) {
+		char digits[3] = { arg[i], arg[i + 1], 0 };
+		char* ptr;
+
+		if (!isxdigit((unsigned char)digits[0]))
+			return 0;
+		pattern[i / 2] = (unsigned char)strtoul(digits, &ptr, 16);
+		if (*ptr != 0)
+			return 0;
+	}
+	return (int)(len / 2);
+}
+
+/*************************************************************************************
+* : data0 data1 pos ó ٸ byte ã´.  κ memcmp
+*       COMPARE_BLOCK byte Ͽ ǳʶڴ. memcmp    byte ϹǷ
+*        byte ϴ ͺ ξ .
+* :
+* - data0, data1:   
+* - pos: ã  ġ
+* - len:   
+* ȯ: ó ٸ ġ.   len
+*************************************************************************************/
+static int findDifference(const char* data0, const char* data1, int pos, int len)
+{
+	while (len - pos >= COMPARE_BLOCK && !memcmp(data0 + pos, data1 + pos, COMPARE_BLOCK))
+		pos += COMPARE_BLOCK;
+	while (pos < len && data0[pos] == data1[pos])
+		pos++;
+	return pos;
+}
+
+/*************************************************************************************
+* : object file аų ø   Ѵ. text  record 
+*       ̸  ȣ Բ Ѵ.
+* :
+* - shell: shell    ִ ü  
+* - path: object file 
+* - obj:  object
+* ȯ: 
+*************************************************************************************/
+static void printObjectError(Shell* shell, const char* path, const ObjectFile* obj)
+{
+	if (obj->error == OBJ_ERR_IO && obj->fd < 0 && obj->line_no == 0)
+		printOutput(shell, "%s:    ϴ.\n", path);
+	else if (obj->line_no > 0)
+		printOutput(shell, "%s:%d: %s\n", path, obj->line_no, getObjectErrorMessage(obj->error));
+	else
+		printOutput(shell, "%s: %s\n", path, getObjectErrorMessage(obj->error));
+}
+
+/*************************************************************************************
+* :  ü о  Ҵ ۿ ´.
+* :
+* - path:   
+* - len:  ̸  
+* ȯ:  .    ų Ҵ翡 ϸ NULL
+*************************************************************************************/
+static char* readTextFile(const char* path, size_t* len)
+{
+	char* text = NULL;
+	size_t cap = 0;
+	size_t read;
+	FILE* fp = fopen(path, "rb");
+	if (fp == NULL)
+		return NULL;
+
+	*len = 0;
+	do {
+		if (*len == cap) {
+			char* tmp = (char*)realloc(text, cap + 4096);
+			if (tmp == NULL) {
+				free(text);
+				fclose(fp);
+				return NULL;
+			}
+			text = tmp;
+			cap += 4096;
+		}
+		read = fread(text + *len, sizeof(char), cap - *len, fp);
+		*len += read;
+	} while (read > 0);
+	fclose(fp);
+
+	return text;
 }
\ No newline at end of file
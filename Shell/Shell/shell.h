@@ -1,26 +1,28 @@
 #ifndef SHELL_H_
 #define SHELL_H_
 
+#include <stdio.h>
 #include "list.h"
-#include "hash.h"
-
-#ifndef true
-#define true 1
-#endif
-#ifndef false
-#define false 0
-#endif
+#include "sicsim.h"
+#include "output.h"
+#include "symtab.h"
 
 
 #define OP_LEN_MAX 16;
 
-#define MEM_SIZE 0xFFFFF
+#define SHELL_PROMPT "sicsim>"
+#define OPCODE_FILE "./opcode.txt"
+
 #define MEM_LINE 0x10
 
 #define LINE_MAX    256
 #define CMD_LEN_MAX 80
 #define ARG_LEN_MAX 80
 #define ARG_CNT_MAX 3
+#define PATTERN_MAX (ARG_LEN_MAX / 2)
+#define COMPARE_LINE_MAX 256
+#define DISASM_SYMBOL_MAX (SYMBOL_NAME_LEN + 16)
+#define COMPARE_BLOCK 256
 
 #define ERR_NONE        0
 #define ERR_INIT        1
@@ -29,7 +31,7 @@
 #define ERR_RUN_FAIL    4
 #define ERR_EMPTY       5
 
-#define CMD_CNT 10
+#define CMD_CNT 29
 #define CMD_INVALID -1
 #define CMD_HELP    0
 #define CMD_DIR     1
@@ -41,6 +43,25 @@
 #define CMD_RESET   7
 #define CMD_OPCODE  8
 #define CMD_OPLIST  9
+#define CMD_DISASM  10
+#define CMD_STATS   11
+#define CMD_SAVE    12
+#define CMD_LOAD    13
+#define CMD_MMAP    14
+#define CMD_MUNMAP  15
+#define CMD_MACRO   16
+#define CMD_UNDO    17
+#define CMD_REDO    18
+#define CMD_OBJCONV 19
+#define CMD_LOADOBJ 20
+#define CMD_MMIO    21
+#define CMD_ROM     22
+#define CMD_RAM     23
+#define CMD_MEMMAP  24
+#define CMD_OPRELOAD 25
+#define CMD_MOVE    26
+#define CMD_COMPARE 27
+#define CMD_SYMBOL  28
 
 /*************************************************************************************
 * : Shell    ü
@@ -50,12 +71,18 @@
 * quit: shell  θ Ÿ ÷
 * init: shell  ʱȭ Ǿ θ Ÿ ÷
 * mem_addr: dump   ϴ memory ּҰ
-* vm: virtual memory
+* machine:  ޸𸮿 opcode table. ɵ Է Ľϰ  ϸ,
+*           ۾ machine  Լ(sicsim.h) Ѵ.
+* vm_origin: mmap  machine vm    vm. mmap  ƴϸ NULL
+* symbols: loadobj ø α׷ control section ܺ symbol
 * cmd_line:  Է
 * args: ɿ  ڵ
 * cmds:  ϴ Լ   迭
 * history:   ɿ  command-line ϱ  list
-* op_table: opcode code, mnemonic, type    hash table
+* out:    Ƶξٰ ϴ 
+* capture: OUTPUT_JSON Ŀ     Ƶδ 
+* format:  . OUTPUT_TEXT Ȥ OUTPUT_JSON
+* stats: ɺ  . SHELL_STATS  ϸ ׻ NULL
 *************************************************************************************/
 typedef struct Shell_ {
 	int cmd_code;
@@ -65,17 +92,62 @@ typedef struct Shell_ {
 	int init;
 	unsigned int mem_addr;
 
-	char* vm;
+	SicMachine machine;
+	char* vm_origin;
+	SymbolTable symbols;
 	char cmd_line[LINE_MAX];
 	char args[ARG_CNT_MAX][ARG_LEN_MAX];
 	void(*cmds[CMD_CNT])(struct Shell_*);
 	List history;
-	HashTable op_table;
+	Output out;
+	Output capture;
+	int format;
+	struct ShellStats_* stats;
 } Shell;
 
 /* Shell  Լ */
 extern void initializeShell(Shell* shell);
+extern void initializeSession(Shell* shell, const Shell* base, char* vm);
 extern void startShell(Shell* shell);
+extern void runCommandLine(Shell* shell, const char* line);
 extern void releaseShell(Shell* shell);
 
+/* Command  Լ */
+extern void runCmdHelp(Shell* shell);
+extern void runCmdDir(Shell* shell);
+extern void runCmdQuit(Shell* shell);
+extern void runCmdHistory(Shell* shell);
+extern void runCmdDump(Shell* shell);
+extern void runCmdEdit(Shell* shell);
+extern void runCmdFill(Shell* shell);
+extern void runCmdReset(Shell* shell);
+extern void runCmdOpcode(Shell* shell);
+extern void runCmdOplist(Shell* shell);
+extern void runCmdDisasm(Shell* shell);
+extern void runCmdStats(Shell* shell);
+extern void runCmdSave(Shell* shell);
+extern void runCmdLoad(Shell* shell);
+extern void runCmdMmap(Shell* shell);
+extern void runCmdMunmap(Shell* shell);
+extern void runCmdMacro(Shell* shell);
+extern void runCmdUndo(Shell* shell);
+extern void runCmdRedo(Shell* shell);
+extern void runCmdObjconv(Shell* shell);
+extern void runCmdLoadobj(Shell* shell);
+extern void runCmdMmio(Shell* shell);
+extern void runCmdRom(Shell* shell);
+extern void runCmdRam(Shell* shell);
+extern void runCmdMemmap(Shell* shell);
+extern void runCmdOpreload(Shell* shell);
+extern void runCmdMove(Shell* shell);
+extern void runCmdCompare(Shell* shell);
+extern void runCmdSymbol(Shell* shell);
+extern void runCommand(Shell* shell);
+
+/* Ľ  Լ */
+extern void parseOpcode(Shell* shell);
+extern void parseCommandLine(Shell* shell, const char* line);
+extern int getCommandCode(char* cmd);
+extern const char* getCommandName(int cmd_code);
+
 #endif
\ No newline at end of file
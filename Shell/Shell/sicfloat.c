@@ -0,0 +1,537 @@
+﻿#include "sicfloat.h"
+#include <float.h>
+#include <string.h>
+
+#define SICF_SIGN     (1ULL << 47)
+#define SICF_FRAC     ((1ULL << SICF_FRAC_BITS) - 1)
+#define SICF_FRAC_TOP (1ULL << (SICF_FRAC_BITS - 1))
+
+/* value = fraction × 2^(exponent - SICF_EXP_SHIFT), fraction을 정수로 볼 때 */
+#define SICF_EXP_SHIFT (SICF_EXP_BIAS + SICF_FRAC_BITS)
+
+/* double 연산이 중간 결과를 더 넓은 형식으로 계산하면(x87) 결과가 double로 한 번만
+   round 되었다고 볼 수 없으므로 fast path를 쓰지 않는다 */
+#if (defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0) || defined(__x86_64__) || \
+	defined(_M_X64) || defined(__aarch64__) || defined(_M_ARM64)
+#define SICF_FAST_PATH 1
+#else
+#define SICF_FAST_PATH 0
+#endif
+
+/*************************************************************************************
+* 설명: 부호와 정규화된 정수 fraction, exponent로 풀어놓은 수. 값은 mant × 2^exp이다.
+*       mant가 0이면 0이고, 아니면 bit 35가 1이다.
+*************************************************************************************/
+typedef struct {
+	int sign;
+	int exp;
+	unsigned long long mant;
+} Unpacked;
+
+static int unpack(SicFloat x, Unpacked* u);
+static int pack(int sign, unsigned long long mant, int exp, SicFloat* out);
+static int getBitLength(unsigned long long x);
+static int addSlow(SicFloat a, SicFloat b, SicFloat* out);
+static int mulSlow(SicFloat a, SicFloat b, SicFloat* out);
+static int divSlow(SicFloat a, SicFloat b, SicFloat* out);
+static int toDouble(SicFloat x, double* d);
+static int fromDouble(double d, SicFloat* x);
+
+/*************************************************************************************
+* 설명: 메모리의 6 byte(big endian)를 부동소수점 수로 읽는다.
+* 인자:
+* - mem: 읽을 메모리의 시작
+* 반환값: 읽은 수
+*************************************************************************************/
+SicFloat loadSicFloat(const unsigned char* mem)
+{
+	SicFloat value = 0;
+	int i;
+
+	for (i = 0; i < SICF_SIZE; i++)
+		value = (value << 8) | mem[i];
+	return value;
+}
+
+/*************************************************************************************
+* 설명: 부동소수점 수를 메모리의 6 byte에 big endian으로 쓴다.
+* 인자:
+* - mem: 쓸 메모리의 시작
+* - value: 쓸 수
+* 반환값: 없음
+*************************************************************************************/
+void storeSicFloat(unsigned char* mem, SicFloat value)
+{
+	int i;
+
+	for (i = SICF_SIZE - 1; i >= 0; i--) {
+		mem[i] = (unsigned char)value;
+		value >>= 8;
+	}
+}
+
+/*************************************************************************************
+* 설명: F ← F op m 을 계산한다. fast가 true이고 두 수가 정규화되어 있고 exponent가
+*       충분히 안쪽에 있으면 double로 바꾸어 계산한다. double은 정확한 결과를 53 bit로
+*       한 번 round 하는데, 36 bit로 round할 때 기준이 되는 중간값은 53 bit로 표현
+*       가능하므로 double 결과가 정확히 중간값이 아닌 이상 다시 36 bit로 round한
+*       결과는 정확한 값을 바로 36 bit로 round한 결과와 같다. 중간값이거나 범위를
+*       벗어나면 정수 연산으로 정확하게 계산하는 slow path를 사용한다.
+* 인자:
+* - op: SICF_ADD, SICF_SUB, SICF_MUL, SICF_DIV 중 하나
+* - f: F register
+* - m: 메모리에서 읽은 operand
+* - fast: fast path를 사용할지 여부. false이면 항상 slow path로 계산한다.
+* 반환값: SICF_OK, SICF_OVERFLOW, SICF_UNDERFLOW, SICF_DIVZERO 중 하나.
+*         overflow면 F는 같은 부호의 가장 큰 수, underflow면 0이 되고,
+*         0으로 나누면 F는 바뀌지 않는다.
+*************************************************************************************/
+int operateSicFloat(int op, SicFloat* f, SicFloat m, int fast)
+{
+	SicFloat result = 0;
+	int status;
+
+#if SICF_FAST_PATH
+	double x, y, r;
+
+	if (fast && toDouble(*f, &x) && toDouble(m, &y)) {
+		switch (op) {
+		case SICF_ADD: r = x + y; break;
+		case SICF_SUB: r = x - y; break;
+		case SICF_MUL: r = x * y; break;
+		default:       r = y != 0 ? x / y : 0; break;
+		}
+
+		/* 덧셈과 뺄셈의 결과 0은 정확하다. 곱셈과 나눗셈은 underflow일 수 있다 */
+		if (r == 0 && (op == SICF_ADD || op == SICF_SUB)) {
+			*f = 0;
+			return SICF_OK;
+		}
+		if (r != 0 && fromDouble(r, &result)) {
+			*f = result;
+			return SICF_OK;
+		}
+	}
+#else
+	(void)fast;
+#endif
+
+	switch (op) {
+	case SICF_ADD: status = addSlow(*f, m, &result); break;
+	case SICF_SUB: status = addSlow(*f, m ^ SICF_SIGN, &result); break;
+	case SICF_MUL: status = mulSlow(*f, m, &result); break;
+	default:       status = divSlow(*f, m, &result); break;
+	}
+
+	if (status != SICF_DIVZERO)
+		*f = result;
+	return status;
+}
+
+/*************************************************************************************
+* 설명: ADDF, SUBF, MULF, DIVF. F ← F op m
+* 인자:
+* - f: F register
+* - m: 메모리에서 읽은 operand
+* 반환값: operateSicFloat과 같다.
+*************************************************************************************/
+int addSicFloat(SicFloat* f, SicFloat m)
+{
+	return operateSicFloat(SICF_ADD, f, m, 1);
+}
+
+int subSicFloat(SicFloat* f, SicFloat m)
+{
+	return operateSicFloat(SICF_SUB, f, m, 1);
+}
+
+int mulSicFloat(SicFloat* f, SicFloat m)
+{
+	return operateSicFloat(SICF_MUL, f, m, 1);
+}
+
+int divSicFloat(SicFloat* f, SicFloat m)
+{
+	return operateSicFloat(SICF_DIV, f, m, 1);
+}
+
+/*************************************************************************************
+* 설명: COMPF. F와 m의 값을 비교한다. 정규화되지 않은 수도 값으로 비교한다.
+* 인자:
+* - f: F register
+* - m: 메모리에서 읽은 operand
+* 반환값: F < m이면 음수, 같으면 0, F > m이면 양수 (condition code)
+*************************************************************************************/
+int compareSicFloat(SicFloat f, SicFloat m)
+{
+	Unpacked a, b;
+	int cmp;
+
+	if (!unpack(f, &a)) {
+		if (!unpack(m, &b))
+			return 0;
+		return b.sign ? 1 : -1;
+	}
+	if (!unpack(m, &b))
+		return a.sign ? -1 : 1;
+	if (a.sign != b.sign)
+		return a.sign ? -1 : 1;
+
+	if (a.exp != b.exp)
+		cmp = a.exp > b.exp ? 1 : -1;
+	else if (a.mant != b.mant)
+		cmp = a.mant > b.mant ? 1 : -1;
+	else
+		cmp = 0;
+
+	return a.sign ? -cmp : cmp;
+}
+
+/*************************************************************************************
+* 설명: FIX. F를 0 방향으로 버림하여 24 bit 정수로 바꾼다.
+* 인자:
+* - f: F register
+* - a: 결과를 저장할 A register. overflow면 바뀌지 않는다.
+* 반환값: SICF_OK 또는 24 bit를 넘으면 SICF_OVERFLOW
+*************************************************************************************/
+int fixSicFloat(SicFloat f, int* a)
+{
+	Unpacked u;
+	unsigned long long mag;
+
+	if (!unpack(f, &u)) {
+		*a = 0;
+		return SICF_OK;
+	}
+
+	/* mant는 2^35 이상이므로 exp가 0 이상이면 24 bit를 넘는다 */
+	if (u.exp >= 0)
+		return SICF_OVERFLOW;
+	mag = -u.exp >= 64 ? 0 : u.mant >> -u.exp;
+
+	if (mag > (u.sign ? 0x800000ULL : 0x7FFFFFULL))
+		return SICF_OVERFLOW;
+	*a = u.sign ? -(int)mag : (int)mag;
+	return SICF_OK;
+}
+
+/*************************************************************************************
+* 설명: FLOAT. 24 bit 정수를 부동소수점 수로 바꾼다. 항상 정확하다.
+* 인자:
+* - a: A register의 값(부호 확장된 값)
+* 반환값: 바꾼 수
+*************************************************************************************/
+SicFloat floatSicFloat(int a)
+{
+	SicFloat result = 0;
+
+	if (a != 0)
+		pack(a < 0, a < 0 ? (unsigned long long)-(long long)a : (unsigned long long)a, 0, &result);
+	return result;
+}
+
+/*************************************************************************************
+* 설명: NORM. F를 정규화한다. exponent가 0보다 작아져야 하면 0이 된다.
+* 인자:
+* - f: F register
+* 반환값: SICF_OK 또는 SICF_UNDERFLOW
+*************************************************************************************/
+int normSicFloat(SicFloat* f)
+{
+	Unpacked u;
+
+	if (!unpack(*f, &u)) {
+		*f = 0;
+		return SICF_OK;
+	}
+	return pack(u.sign, u.mant, u.exp, f);
+}
+
+/*************************************************************************************
+* 설명: 수를 부호, 정규화된 fraction, exponent로 푼다.
+* 인자:
+* - x: 풀 수
+* - u: 결과를 저장할 곳
+* 반환값: 0이 아니면 1, 0이면 0
+*************************************************************************************/
+static int unpack(SicFloat x, Unpacked* u)
+{
+	unsigned long long mant = x & SICF_FRAC;
+	int exp = (int)((x >> SICF_FRAC_BITS) & SICF_EXP_MAX);
+
+	u->sign = (int)((x >> 47) & 1);
+	u->mant = 0;
+	u->exp = 0;
+	if (mant == 0)
+		return 0;
+
+	while (!(mant & SICF_FRAC_TOP)) {
+		mant <<= 1;
+		exp--;
+	}
+	u->mant = mant;
+	u->exp = exp - SICF_EXP_SHIFT;
+	return 1;
+}
+
+/*************************************************************************************
+* 설명: mant × 2^exp를 fraction 36 bit로 round-to-nearest-even 하여 정규화된 수를
+*       만든다. mant가 36 bit보다 길면 잘려나가는 bit 중 가장 아래 bit는 그 아래에서
+*       버려진 bit가 있는지(sticky)를 나타내야 하고, 잘려나가는 bit는 2개 이상이어야
+*       한다.
+* 인자:
+* - sign: 부호
+* - mant: 0이 아닌 정수
+* - exp: 2의 지수
+* - out: 결과를 저장할 곳
+* 반환값: SICF_OK, SICF_OVERFLOW, SICF_UNDERFLOW 중 하나
+*************************************************************************************/
+static int pack(int sign, unsigned long long mant, int exp, SicFloat* out)
+{
+	int len = getBitLength(mant);
+	unsigned long long frac;
+	int e;
+
+	if (len > SICF_FRAC_BITS) {
+		int shift = len - SICF_FRAC_BITS;
+		unsigned long long rem = mant & ((1ULL << shift) - 1);
+		unsigned long long half = 1ULL << (shift - 1);
+
+		frac = mant >> shift;
+		if (rem > half || (rem == half && (frac & 1)))
+			frac++;
+		exp += shift;
+		if (frac >> SICF_FRAC_BITS) {
+			frac >>= 1;
+			exp++;
+		}
+	}
+	else {
+		frac = mant << (SICF_FRAC_BITS - len);
+		exp -= SICF_FRAC_BITS - len;
+	}
+
+	e = exp + SICF_EXP_SHIFT;
+	if (e > SICF_EXP_MAX) {
+		*out = (sign ? SICF_SIGN : 0) | ((SicFloat)SICF_EXP_MAX << SICF_FRAC_BITS) | SICF_FRAC;
+		return SICF_OVERFLOW;
+	}
+	if (e < 0) {
+		*out = 0;
+		return SICF_UNDERFLOW;
+	}
+
+	*out = (sign ? SICF_SIGN : 0) | ((SicFloat)e << SICF_FRAC_BITS) | frac;
+	return SICF_OK;
+}
+
+/*************************************************************************************
+* 설명: 0이 아닌 정수의 bit 길이를 구한다.
+* 인자:
+* - x: 0이 아닌 정수
+* 반환값: 최상위 1 bit의 위치 + 1
+*************************************************************************************/
+static int getBitLength(unsigned long long x)
+{
+#if defined(__GNUC__)
+	return 64 - __builtin_clzll(x);
+#else
+	int len = 0;
+	while (x != 0) {
+		x >>= 1;
+		len++;
+	}
+	return len;
+#endif
+}
+
+/*************************************************************************************
+* 설명: a + b를 정수 연산으로 정확하게 계산한다. 큰 쪽의 fraction을 26 bit 올려
+*       자리를 맞추고, 작은 쪽에서 잘려나간 bit는 최하위 bit에 sticky로 남긴다.
+* 인자:
+* - a, b: 더할 수
+* - out: 결과를 저장할 곳
+* 반환값: pack과 같다.
+*************************************************************************************/
+static int addSlow(SicFloat a, SicFloat b, SicFloat* out)
+{
+	Unpacked ua, ub, tmp;
+	unsigned long long big, small, sum;
+	int sign, shift;
+
+	if (!unpack(a, &ua)) {
+		if (!unpack(b, &ub)) {
+			*out = 0;
+			return SICF_OK;
+		}
+		return pack(ub.sign, ub.mant, ub.exp, out);
+	}
+	if (!unpack(b, &ub))
+		return pack(ua.sign, ua.mant, ua.exp, out);
+
+	if (ua.exp < ub.exp) {
+		tmp = ua;
+		ua = ub;
+		ub = tmp;
+	}
+
+	big = ua.mant << 26;
+	small = ub.mant << 26;
+	shift = ua.exp - ub.exp;
+	if (shift >= 64)
+		small = 1;
+	else if (shift > 0)
+		small = (small >> shift) | ((small & ((1ULL << shift) - 1)) != 0);
+
+	if (ua.sign == ub.sign) {
+		sum = big + small;
+		sign = ua.sign;
+	}
+	else if (big >= small) {
+		sum = big - small;
+		sign = ua.sign;
+	}
+	else {
+		sum = small - big;
+		sign = ub.sign;
+	}
+
+	if (sum == 0) {
+		*out = 0;
+		return SICF_OK;
+	}
+	return pack(sign, sum, ua.exp - 26, out);
+}
+
+/*************************************************************************************
+* 설명: a × b를 정수 연산으로 정확하게 계산한다. 36 bit × 36 bit = 72 bit 곱을 18 bit씩
+*       나누어 구하고, 하위 8 bit는 sticky로 접는다.
+* 인자:
+* - a, b: 곱할 수
+* - out: 결과를 저장할 곳
+* 반환값: pack과 같다.
+*************************************************************************************/
+static int mulSlow(SicFloat a, SicFloat b, SicFloat* out)
+{
+	Unpacked ua, ub;
+	unsigned long long a1, a0, b1, b0, mid, high, low;
+
+	if (!unpack(a, &ua) || !unpack(b, &ub)) {
+		*out = 0;
+		return SICF_OK;
+	}
+
+	a1 = ua.mant >> 18;
+	a0 = ua.mant & 0x3FFFF;
+	b1 = ub.mant >> 18;
+	b0 = ub.mant & 0x3FFFF;
+
+	/* 곱 = high × 2^36 + low, low < 2^36 */
+	mid = a1 * b0 + a0 * b1;
+	low = a0 * b0 + ((mid & 0x3FFFF) << 18);
+	high = a1 * b1 + (mid >> 18) + (low >> 36);
+	low &= (1ULL << 36) - 1;
+
+	return pack(ua.sign ^ ub.sign, (high << 28) | (low >> 8) | ((low & 0xFF) != 0),
+		ua.exp + ub.exp + 8, out);
+}
+
+/*************************************************************************************
+* 설명: a / b를 정수 연산으로 정확하게 계산한다. 한 bit씩 나누어 38 bit 이상의 몫을
+*       구하고 나머지는 sticky로 남긴다.
+* 인자:
+* - a, b: 나눌 수와 나누는 수
+* - out: 결과를 저장할 곳
+* 반환값: pack과 같다. b가 0이면 SICF_DIVZERO
+*************************************************************************************/
+static int divSlow(SicFloat a, SicFloat b, SicFloat* out)
+{
+	Unpacked ua, ub;
+	unsigned long long quot, rem;
+	int i;
+
+	if (!unpack(b, &ub))
+		return SICF_DIVZERO;
+	if (!unpack(a, &ua)) {
+		*out = 0;
+		return SICF_OK;
+	}
+
+	rem = ua.mant;
+	quot = 0;
+	if (rem >= ub.mant) {
+		rem -= ub.mant;
+		quot = 1;
+	}
+	for (i = 0; i < 38; i++) {
+		rem <<= 1;
+		quot <<= 1;
+		if (rem >= ub.mant) {
+			rem -= ub.mant;
+			quot |= 1;
+		}
+	}
+
+	return pack(ua.sign ^ ub.sign, quot | (rem != 0), ua.exp - ub.exp - 38, out);
+}
+
+/*************************************************************************************
+* 설명: 정규화된 수를 double로 바꾼다. fraction이 36 bit라서 항상 정확하다.
+*       double의 정규화된 범위 안쪽에서만 바꾸고, 0은 항상 바꾼다.
+* 인자:
+* - x: 바꿀 수
+* - d: 결과를 저장할 곳
+* 반환값: 바꿨으면 1, slow path를 써야 하면 0
+*************************************************************************************/
+static int toDouble(SicFloat x, double* d)
+{
+	unsigned long long bits;
+	int e = (int)((x >> SICF_FRAC_BITS) & SICF_EXP_MAX);
+
+	if ((x & SICF_FRAC) == 0) {
+		*d = 0;
+		return 1;
+	}
+	if (!(x & SICF_FRAC_TOP) || e < 64 || e > SICF_EXP_MAX - 8)
+		return 0;
+
+	/* 0.1f × 2^(e-1024) = 1.f × 2^(e-1025), double의 biased exponent는 e - 2 */
+	bits = ((x & SICF_SIGN) << 16) | ((unsigned long long)(e - 2) << 52) |
+		((x & (SICF_FRAC_TOP - 1)) << (52 - (SICF_FRAC_BITS - 1)));
+	memcpy(d, &bits, sizeof(bits));
+	return 1;
+}
+
+/*************************************************************************************
+* 설명: double을 fraction 36 bit로 round하여 정규화된 수로 바꾼다. 버려지는 17 bit가
+*       정확히 중간값이면 double로 계산하기 전의 값이 어느 쪽이었는지 알 수 없으므로
+*       바꾸지 않는다.
+* 인자:
+* - d: 0이 아닌 double
+* - x: 결과를 저장할 곳
+* 반환값: 바꿨으면 1, slow path를 써야 하면 0
+*************************************************************************************/
+static int fromDouble(double d, SicFloat* x)
+{
+	unsigned long long bits;
+	unsigned long long frac, low;
+	int e;
+
+	memcpy(&bits, &d, sizeof(bits));
+	e = (int)((bits >> 52) & 0x7FF);
+	if (e < 64 || e > 0x7FF - 16)
+		return 0;
+
+	low = bits & 0x1FFFF;
+	if (low == 0x10000)
+		return 0;
+
+	frac = SICF_FRAC_TOP | ((bits >> 17) & (SICF_FRAC_TOP - 1));
+	if (low > 0x10000 && ++frac >> SICF_FRAC_BITS) {
+		frac >>= 1;
+		e++;
+	}
+
+	*x = ((bits >> 16) & SICF_SIGN) | ((SicFloat)(e + 2) << SICF_FRAC_BITS) | frac;
+	return 1;
+}
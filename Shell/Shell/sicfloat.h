@@ -0,0 +1,41 @@
+﻿#ifndef SICFLOAT_H_
+#define SICFLOAT_H_
+
+/*************************************************************************************
+* 설명: SIC/XE의 48 bit 부동소수점 수. 하위 48 bit만 사용한다.
+*       bit 47은 부호, bit 46~36은 exponent(excess 1024), bit 35~0은 fraction이고,
+*       값은 0.fraction × 2^(exponent - 1024)이다. fraction의 최상위 bit가 1이면
+*       정규화된 수이고, fraction이 0이면 exponent와 부호에 상관없이 0이다.
+*       연산 결과는 항상 정규화하고, fraction 36 bit로 round-to-nearest-even 한다.
+*************************************************************************************/
+typedef unsigned long long SicFloat;
+
+#define SICF_SIZE      6
+#define SICF_FRAC_BITS 36
+#define SICF_EXP_BIAS  1024
+#define SICF_EXP_MAX   2047
+
+#define SICF_OK        0
+#define SICF_OVERFLOW  1
+#define SICF_UNDERFLOW 2
+#define SICF_DIVZERO   3
+
+#define SICF_ADD 0
+#define SICF_SUB 1
+#define SICF_MUL 2
+#define SICF_DIV 3
+
+/* SIC/XE 부동소수점 관련 함수 */
+extern SicFloat loadSicFloat(const unsigned char* mem);
+extern void storeSicFloat(unsigned char* mem, SicFloat value);
+extern int operateSicFloat(int op, SicFloat* f, SicFloat m, int fast);
+extern int addSicFloat(SicFloat* f, SicFloat m);
+extern int subSicFloat(SicFloat* f, SicFloat m);
+extern int mulSicFloat(SicFloat* f, SicFloat m);
+extern int divSicFloat(SicFloat* f, SicFloat m);
+extern int compareSicFloat(SicFloat f, SicFloat m);
+extern int fixSicFloat(SicFloat f, int* a);
+extern SicFloat floatSicFloat(int a);
+extern int normSicFloat(SicFloat* f);
+
+#endif
@@ -0,0 +1,982 @@
+﻿#include "sicsim.h"
+#include "disasm.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define loadAtomic(p)        InterlockedCompareExchange((p), 0, 0)
+#define addAtomic(p, v)      InterlockedExchangeAdd((p), (v))
+#define swapAtomic(p, v)     InterlockedExchange((p), (v))
+#define loadPointer(p)       InterlockedCompareExchangePointer((PVOID volatile*)(p), NULL, NULL)
+#define swapPointer(p, v)    InterlockedExchangePointer((PVOID volatile*)(p), (v))
+#define yieldThread()        SwitchToThread()
+#else
+#include <sched.h>
+#define loadAtomic(p)        __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define addAtomic(p, v)      __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+#define swapAtomic(p, v)     __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define loadPointer(p)       __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define swapPointer(p, v)    __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define yieldThread()        sched_yield()
+#endif
+
+#define OPCODE_FIELD_CNT 3
+#define PATTERN_BLOCK    0x10000
+
+static int isSpace(char c);
+static int checkRange(unsigned int addr, unsigned int len);
+static int checkPageRange(unsigned int addr, unsigned int len);
+static int hasPage(const SicMachine* machine, unsigned int addr, unsigned int len, int type);
+static void initializePages(SicMachine* machine);
+static void readPages(const SicMachine* machine, unsigned int addr, unsigned char* dst, unsigned int len);
+static int writePages(SicMachine* machine, unsigned int addr, const unsigned char* src, unsigned int len,
+	unsigned char value);
+static void repeatPattern(char* dst, unsigned int len, const unsigned char* pattern, unsigned int size);
+static int replaySicMemory(SicMachine* machine, const JournalEntry* entry,
+	int(*replay)(Journal*, unsigned char*, unsigned int*, unsigned int*), unsigned int* addr, unsigned int* len);
+static SicOpTable* createOpTable(void);
+static void releaseOpTable(SicOpTable* table);
+static int replaceOpTable(SicOpcodes* opcodes, SicOpTable* table);
+static int hashFunc(void* key);
+static int hashCmp(void* a, void* b);
+static void releaseOplist(void* data, void* aux);
+
+/*************************************************************************************
+* 설명: machine을 할당하고 초기화한 뒤 opcode table을 구성한다. 다른 프로그램이
+*       shell 없이 machine을 쓸 때 사용한다.
+* 인자:
+* - opcodes, len: opcode.txt와 같은 형식의 내용과 그 길이
+* - err: 실패한 이유(SIC_ERR_*)를 저장할 곳. 필요 없으면 NULL
+* 반환값: 만든 machine. 실패하면 NULL
+*************************************************************************************/
+SicMachine* createSicMachine(const char* opcodes, size_t len, int* err)
+{
+	SicMachine* machine = (SicMachine*)malloc(sizeof(SicMachine));
+	int result = SIC_ERR_NOMEM;
+
+	if (machine != NULL) {
+		result = initializeSicMachine(machine);
+		if (result == SIC_OK)
+			result = loadSicOpcodes(machine, opcodes, len);
+		if (result != SIC_OK) {
+			destroySicMachine(machine);
+			machine = NULL;
+		}
+	}
+
+	if (err != NULL)
+		*err = result;
+	return machine;
+}
+
+/*************************************************************************************
+* 설명: createSicMachine으로 만든 machine을 해제한다.
+* 인자:
+* - machine: 해제할 machine. NULL이면 아무 것도 하지 않는다.
+* 반환값: 없음
+*************************************************************************************/
+void destroySicMachine(SicMachine* machine)
+{
+	if (machine == NULL)
+		return;
+
+	releaseSicMachine(machine);
+	free(machine);
+}
+
+/*************************************************************************************
+* 설명: machine을 0으로 채운 메모리와 비어있는 opcode table로 초기화한다.
+*       실패하더라도 releaseSicMachine으로 해제할 수 있는 상태가 된다.
+* 인자:
+* - machine: 초기화할 machine
+* 반환값: SIC_OK 또는 메모리를 할당하지 못하면 SIC_ERR_NOMEM
+*************************************************************************************/
+int initializeSicMachine(SicMachine* machine)
+{
+	machine->shared = false;
+	machine->op_reader = -1;
+	initializeJournal(&machine->journal, JOURNAL_BUDGET);
+	initializePages(machine);
+
+	machine->vm = (char*)calloc(MEM_SIZE, sizeof(char));
+	machine->opcodes = (SicOpcodes*)calloc(1, sizeof(SicOpcodes));
+	if (machine->opcodes != NULL)
+		machine->opcodes->current = createOpTable();
+	if (machine->vm == NULL || machine->opcodes == NULL || machine->opcodes->current == NULL)
+		return SIC_ERR_NOMEM;
+	return SIC_OK;
+}
+
+/*************************************************************************************
+* 설명: base의 opcode table을 빌려쓰고 호출자가 준 메모리를 쓰는 machine을
+*       초기화한다. vm과 op_table은 빌려쓰는 것이므로 releaseSicMachine에서 해제하지
+*       않는다.
+* 인자:
+* - machine: 초기화할 machine
+* - base: opcode table을 구성한 machine
+* - vm: machine이 사용할, 0으로 초기화된 MEM_SIZE 크기의 메모리
+* 반환값: 없음
+*************************************************************************************/
+void initializeSicSession(SicMachine* machine, const SicMachine* base, char* vm)
+{
+	machine->shared = true;
+	machine->vm = vm;
+	machine->opcodes = base->opcodes;
+	machine->op_reader = -1;
+	initializeJournal(&machine->journal, JOURNAL_BUDGET);
+	initializePages(machine);
+}
+
+/*************************************************************************************
+* 설명: machine이 사용한 메모리를 모두 해제한다.
+* 인자:
+* - machine: 해제할 machine
+* 반환값: 없음
+*************************************************************************************/
+void releaseSicMachine(SicMachine* machine)
+{
+	setSicPages(machine, 0, MEM_SIZE, SIC_PAGE_RAM);
+	releaseJournal(&machine->journal);
+
+	/* session은 vm과 opcodes를 빌려쓰므로 해제하지 않는다 */
+	if (machine->shared)
+		return;
+
+	free(machine->vm);
+	machine->vm = NULL;
+
+	/* session이 모두 끝난 뒤이므로 읽고 있는 쪽이 없다 */
+	if (machine->opcodes != NULL) {
+		releaseOpTable(machine->opcodes->current);
+		free(machine->opcodes);
+		machine->opcodes = NULL;
+	}
+}
+
+/*************************************************************************************
+* 설명: opcode.txt 형식의 내용을 읽어서 새 opcode table을 만들고, 지금의 table과
+*       바꾼다. 한 줄은 공백으로 구분된 code(16진수), mnemonic, format("1", "2",
+*       "3/4")이고, 필드가 모자란 줄은 건너뛴다. 다 읽은 후에는 첫 바이트로 opcode를
+*       찾는 decode table도 구성한다. 이전 table은 읽고 있던 쪽이 모두 끝나기를 기다려서
+*       해제하므로, beginSicLookup과 endSicLookup 사이에서 부르면 안 된다.
+* 인자:
+* - machine: opcode table을 바꿀 machine. session이면 함께 쓰는 모든 machine의
+*       table이 바뀐다.
+* - text, len: 읽을 내용과 그 길이
+* 반환값: SIC_OK, 메모리를 할당하지 못하면 SIC_ERR_NOMEM, 다른 쪽이 table을 바꾸는
+*       중이면 SIC_ERR_BUSY. 실패하면 지금의 table을 그대로 둔다.
+*************************************************************************************/
+int loadSicOpcodes(SicMachine* machine, const char* text, size_t len)
+{
+	const char* end = text + len;
+	SicOpTable* table = createOpTable();
+	int result = table != NULL ? SIC_OK : SIC_ERR_NOMEM;
+
+	while (text < end && result == SIC_OK) {
+		const char* fields[OPCODE_FIELD_CNT];
+		size_t lens[OPCODE_FIELD_CNT];
+		int cnt = 0;
+		char* mne;
+		Opcode* op;
+
+		/* 한 줄에서 필드를 나눈다 */
+		while (text < end && *text != '\n') {
+			const char* start;
+
+			while (text < end && *text != '\n' && isSpace(*text))
+				text++;
+			start = text;
+			while (text < end && *text != '\n' && !isSpace(*text))
+				text++;
+			if (text > start && cnt < OPCODE_FIELD_CNT) {
+				fields[cnt] = start;
+				lens[cnt++] = text - start;
+			}
+		}
+		if (text < end)
+			text++;
+		if (cnt < OPCODE_FIELD_CNT)
+			continue;
+
+		mne = (char*)malloc(lens[1] + 1);
+		op = (Opcode*)malloc(sizeof(Opcode));
+		if (mne == NULL || op == NULL) {
+			free(mne);
+			free(op);
+			result = SIC_ERR_NOMEM;
+			break;
+		}
+		memcpy(mne, fields[1], lens[1]);
+		mne[lens[1]] = 0;
+
+		op->mnemonic = mne;
+		op->code = (int)strtoul(fields[0], NULL, 16);
+		if (fields[2][0] == '1')
+			op->format = OP_FORMAT_1;
+		else if (fields[2][0] == '2')
+			op->format = OP_FORMAT_2;
+		else
+			op->format = OP_FORMAT_34;
+		insertHash(&table->table, mne, op);
+	}
+
+	if (result != SIC_OK) {
+		releaseOpTable(table);
+		return result;
+	}
+
+	/* disassembler가 첫 바이트로 opcode를 바로 찾을 수 있도록 table 구성 */
+	buildDecodeTable(&table->table, table->decode);
+	return replaceOpTable(machine->opcodes, table);
+}
+
+/*************************************************************************************
+* 설명: opcode table을 빈 table로 바꾼다. 이전 table은 loadSicOpcodes와 같이 해제한다.
+* 인자:
+* - machine: 대상 machine
+* 반환값: SIC_OK, SIC_ERR_NOMEM 또는 SIC_ERR_BUSY
+*************************************************************************************/
+int clearSicOpcodes(SicMachine* machine)
+{
+	SicOpTable* table = createOpTable();
+
+	if (table == NULL)
+		return SIC_ERR_NOMEM;
+	return replaceOpTable(machine->opcodes, table);
+}
+
+/*************************************************************************************
+* 설명: opcode table을 읽기 시작한다. lock을 잡지 않고 counter 하나만 올리므로 다른
+*       쪽이 table을 바꾸더라도 기다리지 않는다. 반환된 table은 endSicLookup을 부를
+*       때까지 해제되지 않는다. machine 하나에서 겹쳐서 부를 수는 없다.
+* 인자:
+* - machine: 대상 machine
+* 반환값: 지금의 opcode table
+*************************************************************************************/
+const SicOpTable* beginSicLookup(SicMachine* machine)
+{
+	SicOpcodes* opcodes = machine->opcodes;
+	int reader = (int)(loadAtomic(&opcodes->epoch) & 1);
+
+	addAtomic(&opcodes->readers[reader], 1);
+	machine->op_reader = reader;
+	return (const SicOpTable*)loadPointer(&opcodes->current);
+}
+
+/*************************************************************************************
+* 설명: beginSicLookup으로 시작한 읽기를 끝낸다. 이후에는 받은 table을 쓰면 안 된다.
+* 인자:
+* - machine: 대상 machine
+* 반환값: 없음
+*************************************************************************************/
+void endSicLookup(SicMachine* machine)
+{
+	addAtomic(&machine->opcodes->readers[machine->op_reader], -1);
+	machine->op_reader = -1;
+}
+
+/*************************************************************************************
+* 설명: mnemonic에 해당하는 opcode를 찾는다.
+* 인자:
+* - table: beginSicLookup으로 받은 opcode table
+* - mnemonic: 찾을 mnemonic
+* 반환값: 찾은 opcode. 없으면 NULL
+*************************************************************************************/
+const Opcode* findSicOpcode(const SicOpTable* table, const char* mnemonic)
+{
+	return (const Opcode*)getValue((HashTable*)&table->table, (void*)mnemonic);
+}
+
+/*************************************************************************************
+* 설명: 메모리의 [addr, addr + len) 범위를 dst로 복사한다. MMIO page는 장치에서
+*       읽는다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 읽을 범위
+* - dst: 복사할 곳
+* 반환값: SIC_OK 또는 범위가 메모리를 벗어나면 SIC_ERR_RANGE
+*************************************************************************************/
+int readSicMemory(const SicMachine* machine, unsigned int addr, void* dst, unsigned int len)
+{
+	const char* src = getSicDirect(machine, addr, len);
+
+	if (src != NULL)
+		memcpy(dst, src, len);
+	else if (checkRange(addr, len))
+		readPages(machine, addr, (unsigned char*)dst, len);
+	else
+		return SIC_ERR_RANGE;
+	return SIC_OK;
+}
+
+/*************************************************************************************
+* 설명: src의 내용을 메모리의 [addr, addr + len) 범위에 쓴다. MMIO page는 장치에
+*       쓰고, ROM page가 있으면 아무 것도 쓰지 않는다. undo할 수 있다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 쓸 범위
+* - src: 쓸 내용
+* 반환값: SIC_OK, 범위가 메모리를 벗어나면 SIC_ERR_RANGE, ROM이 있으면 SIC_ERR_ROM
+*************************************************************************************/
+int writeSicMemory(SicMachine* machine, unsigned int addr, const void* src, unsigned int len)
+{
+	char* dst = beginSicWrite(machine, addr, len);
+
+	if (dst == NULL)
+		return writePages(machine, addr, (const unsigned char*)src, len, 0);
+
+	memcpy(dst, src, len);
+	endSicWrite(machine);
+	return SIC_OK;
+}
+
+/*************************************************************************************
+* 설명: 메모리의 [addr, addr + len) 범위를 value로 채운다. MMIO page는 장치에 쓰고,
+*       ROM page가 있으면 아무 것도 쓰지 않는다. undo할 수 있다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 채울 범위
+* - value: 채울 값
+* 반환값: SIC_OK, 범위가 메모리를 벗어나면 SIC_ERR_RANGE, ROM이 있으면 SIC_ERR_ROM
+*************************************************************************************/
+int fillSicMemory(SicMachine* machine, unsigned int addr, unsigned int len, unsigned char value)
+{
+	char* dst = beginSicWrite(machine, addr, len);
+
+	if (dst == NULL)
+		return writePages(machine, addr, NULL, len, value);
+
+	memset(dst, value, len);
+	endSicWrite(machine);
+	return SIC_OK;
+}
+
+/*************************************************************************************
+* 설명: 메모리의 [addr, addr + len) 범위를 size byte의 pattern을 반복해서 채운다.
+*       pattern을 한 번 쓴 뒤에는 채운 부분을 복사해서 늘려가므로 memcpy의 넓은 store로
+*       쓴다. ROM page가 있으면 아무 것도 쓰지 않는다. undo할 수 있다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 채울 범위
+* - pattern, size: 반복할 내용과 그 길이
+* 반환값: SIC_OK, 범위가 메모리를 벗어나거나 size가 0이면 SIC_ERR_RANGE, ROM이 있으면
+*         SIC_ERR_ROM, MMIO page가 있는데 버퍼를 할당하지 못하면 SIC_ERR_NOMEM
+*************************************************************************************/
+int fillSicPattern(SicMachine* machine, unsigned int addr, unsigned int len,
+	const unsigned char* pattern, unsigned int size)
+{
+	char* dst;
+	char* buffer;
+	int result;
+
+	if (size == 0 || !checkRange(addr, len))
+		return SIC_ERR_RANGE;
+	if (size == 1)
+		return fillSicMemory(machine, addr, len, pattern[0]);
+
+	dst = beginSicWrite(machine, addr, len);
+	if (dst != NULL) {
+		repeatPattern(dst, len, pattern, size);
+		endSicWrite(machine);
+		return SIC_OK;
+	}
+
+	/* ROM이나 MMIO page가 있으면 버퍼에 만든 뒤 page 단위로 쓴다 */
+	if (hasPage(machine, addr, len, SIC_PAGE_ROM))
+		return SIC_ERR_ROM;
+	buffer = (char*)malloc(len);
+	if (buffer == NULL)
+		return SIC_ERR_NOMEM;
+	repeatPattern(buffer, len, pattern, size);
+	result = writeSicMemory(machine, addr, buffer, len);
+	free(buffer);
+	return result;
+}
+
+/*************************************************************************************
+* 설명: 메모리의 [src, src + len) 범위를 dst로 옮긴다. 두 범위가 겹쳐도 memmove와 같이
+*       원래의 내용이 옮겨진다. MMIO page는 장치를 읽고 쓰며, dst에 ROM page가 있으면
+*       아무 것도 쓰지 않는다. undo할 수 있다.
+* 인자:
+* - machine: 대상 machine
+* - dst, src, len: 옮길 곳, 옮길 범위의 시작과 길이
+* 반환값: SIC_OK, 범위가 메모리를 벗어나면 SIC_ERR_RANGE, ROM이 있으면 SIC_ERR_ROM,
+*         MMIO page가 있는데 버퍼를 할당하지 못하면 SIC_ERR_NOMEM
+*************************************************************************************/
+int moveSicMemory(SicMachine* machine, unsigned int dst, unsigned int src, unsigned int len)
+{
+	const char* from;
+	char* to;
+	char* buffer;
+	int result;
+
+	if (!checkRange(src, len) || !checkRange(dst, len))
+		return SIC_ERR_RANGE;
+
+	/* 둘 다 vm에 있으면 vm 안에서 바로 옮긴다 */
+	from = getSicDirect(machine, src, len);
+	if (from != NULL && (to = beginSicWrite(machine, dst, len)) != NULL) {
+		memmove(to, from, len);
+		endSicWrite(machine);
+		return SIC_OK;
+	}
+
+	if (hasPage(machine, dst, len, SIC_PAGE_ROM))
+		return SIC_ERR_ROM;
+	buffer = (char*)malloc(len);
+	if (buffer == NULL)
+		return SIC_ERR_NOMEM;
+	readSicMemory(machine, src, buffer, len);
+	result = writeSicMemory(machine, dst, buffer, len);
+	free(buffer);
+	return result;
+}
+
+/*************************************************************************************
+* 설명: 메모리 전체를 0으로 채운다. ROM과 MMIO page는 그대로 둔다. undo할 수 있다.
+* 인자:
+* - machine: 대상 machine
+* 반환값: SIC_OK
+*************************************************************************************/
+int resetSicMemory(SicMachine* machine)
+{
+	unsigned int page;
+
+	if (machine->rom_pages == 0 && machine->mmio_pages == 0)
+		return fillSicMemory(machine, 0, MEM_SIZE, 0);
+
+	beginJournal(&machine->journal, (unsigned char*)machine->vm, 0, MEM_SIZE);
+	for (page = 0; page < SIC_PAGE_CNT; page++) {
+		if (machine->pages[page].type == SIC_PAGE_RAM)
+			memset(machine->vm + (page << SIC_PAGE_SHIFT), 0, SIC_PAGE_SIZE);
+	}
+	endSicWrite(machine);
+	return SIC_OK;
+}
+
+/*************************************************************************************
+* 설명: 메모리의 [addr, addr + len) 범위를 바꾸기 시작한다. 반환한 포인터로 직접 쓰고
+*       끝나면 endSicWrite를 호출해야 한다. 파일을 메모리로 바로 읽는 것처럼 복사 없이
+*       쓰고 싶을 때 사용하며, 그 사이에 다른 함수로 메모리를 바꾸면 안 된다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 바꿀 범위
+* 반환값: addr번지에 대한 포인터. 범위가 메모리를 벗어나거나 RAM이 아닌 page가 있으면
+*         NULL
+*************************************************************************************/
+char* beginSicWrite(SicMachine* machine, unsigned int addr, unsigned int len)
+{
+	if (!checkRange(addr, len))
+		return NULL;
+	if ((machine->rom_pages != 0 || machine->mmio_pages != 0) &&
+		(hasPage(machine, addr, len, SIC_PAGE_ROM) || hasPage(machine, addr, len, SIC_PAGE_MMIO)))
+		return NULL;
+
+	beginJournal(&machine->journal, (unsigned char*)machine->vm, addr, len);
+	return machine->vm + addr;
+}
+
+/*************************************************************************************
+* 설명: beginSicWrite로 시작한 변경을 끝내고 undo할 수 있도록 기록한다.
+* 인자:
+* - machine: 대상 machine
+* 반환값: 없음
+*************************************************************************************/
+void endSicWrite(SicMachine* machine)
+{
+	endJournal(&machine->journal, (unsigned char*)machine->vm);
+}
+
+/*************************************************************************************
+* 설명: 가장 최근의 메모리 변경을 되돌리거나(undo) 되돌린 변경을 다시 한다(redo).
+*       기록은 vm의 내용이므로 RAM page만 되돌린다. 장치에 쓴 내용은 기록하지 않고,
+*       지금 ROM이나 MMIO인 page의 vm은 그대로 두어 ROM의 내용이 바뀌지 않게 한다.
+*       되돌리지 못한 부분이 있으면 RAM을 되돌린 뒤 SIC_ERR_DEVICE를 반환한다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 바뀐 메모리의 범위를 저장할 곳
+* 반환값: SIC_OK, 되돌리거나 다시 할 변경이 없으면 SIC_ERR_EMPTY, 장치나 ROM인 부분을
+*         되돌리지 못했으면 SIC_ERR_DEVICE, 그 부분을 지킬 버퍼를 할당하지 못하면
+*         아무 것도 하지 않고 SIC_ERR_NOMEM
+*************************************************************************************/
+int undoSicMemory(SicMachine* machine, unsigned int* addr, unsigned int* len)
+{
+	return replaySicMemory(machine, getUndoEntry(&machine->journal), undoJournal, addr, len);
+}
+
+int redoSicMemory(SicMachine* machine, unsigned int* addr, unsigned int* len)
+{
+	return replaySicMemory(machine, getRedoEntry(&machine->journal), redoJournal, addr, len);
+}
+
+/*************************************************************************************
+* 설명: 다음에 undo하거나 redo할 메모리 변경의 번호를 얻는다. 번호는 변경마다 다르고
+*       다시 쓰지 않으므로, 메모리 변경과 함께 되돌려야 하는 다른 상태(symbol 등)를
+*       변경에 연결하는 데 쓴다. 변경을 기록하지 않았으면 바꾸기 전후의 번호가 같다.
+* 인자:
+* - machine: 대상 machine
+* - redo: 0이면 다음에 undo할 변경, 아니면 다음에 redo할 변경
+* 반환값: 변경의 번호, 없으면 0
+*************************************************************************************/
+unsigned long long getSicChange(const SicMachine* machine, int redo)
+{
+	const JournalEntry* entry = redo ? getRedoEntry(&machine->journal) : getUndoEntry(&machine->journal);
+
+	return entry != NULL ? entry->id : 0;
+}
+
+/*************************************************************************************
+* 설명: undo하거나 redo할 수 있는 메모리 변경 중 가장 오래된 것의 번호를 얻는다.
+*       번호가 이보다 작은 변경은 기록이 버려져서 다시 undo할 수 없다.
+* 인자:
+* - machine: 대상 machine
+* 반환값: 변경의 번호, 기록이 없으면 0
+*************************************************************************************/
+unsigned long long getSicOldestChange(const SicMachine* machine)
+{
+	const JournalEntry* entry = getOldestEntry(&machine->journal);
+
+	return entry != NULL ? entry->id : 0;
+}
+
+/*************************************************************************************
+* 설명: machine이 메모리로 쓰는 vm을 바꾼다. mmap한 파일처럼 다른 곳에 있는 MEM_SIZE
+*       크기의 메모리를 쓰게 할 때 사용한다. 메모리 전체가 바뀌므로 이전의 메모리 변경
+*       기록은 버린다. 이전의 vm은 해제하지 않고 old로 돌려준다.
+* 인자:
+* - machine: 대상 machine
+* - vm: 새로 쓸 MEM_SIZE 크기의 메모리
+* - old: 이전의 vm을 저장할 곳. 필요 없으면 NULL
+* 반환값: SIC_OK, vm이 NULL이면 SIC_ERR_RANGE
+*************************************************************************************/
+int setSicMemory(SicMachine* machine, char* vm, char** old)
+{
+	if (vm == NULL)
+		return SIC_ERR_RANGE;
+
+	if (old != NULL)
+		*old = machine->vm;
+	machine->vm = vm;
+	clearJournal(&machine->journal);
+	return SIC_OK;
+}
+
+/*************************************************************************************
+* 설명: undoSicMemory와 redoSicMemory의 공통 부분. RAM이 아닌 page가 범위에 있으면
+*       그 page들의 vm을 복사해 두었다가 기록을 푼 뒤에 다시 덮어쓴다.
+* 인자:
+* - machine: 대상 machine
+* - entry: 풀 기록. 없으면 NULL
+* - replay: undoJournal 혹은 redoJournal
+* - addr, len: 바뀐 메모리의 범위를 저장할 곳
+* 반환값: undoSicMemory와 같음
+*************************************************************************************/
+static int replaySicMemory(SicMachine* machine, const JournalEntry* entry,
+	int(*replay)(Journal*, unsigned char*, unsigned int*, unsigned int*), unsigned int* addr, unsigned int* len)
+{
+	unsigned char* saved = NULL;
+	unsigned int first;
+	unsigned int page;
+	int device;
+
+	if (entry == NULL)
+		return SIC_ERR_EMPTY;
+
+	first = entry->addr;
+	device = entry->device;
+	if ((machine->rom_pages != 0 || machine->mmio_pages != 0) && (hasPage(machine, first, entry->len, SIC_PAGE_ROM)
+		|| hasPage(machine, first, entry->len, SIC_PAGE_MMIO))) {
+		saved = (unsigned char*)malloc(entry->len);
+		if (saved == NULL)
+			return SIC_ERR_NOMEM;
+		memcpy(saved, machine->vm + first, entry->len);
+		device = true;
+	}
+
+	replay(&machine->journal, (unsigned char*)machine->vm, addr, len);
+
+	if (saved != NULL) {
+		for (page = first >> SIC_PAGE_SHIFT; page <= (first + *len - 1) >> SIC_PAGE_SHIFT; page++) {
+			unsigned int start = page << SIC_PAGE_SHIFT > first ? page << SIC_PAGE_SHIFT : first;
+			unsigned int end = (page + 1) << SIC_PAGE_SHIFT < first + *len ? (page + 1) << SIC_PAGE_SHIFT : first + *len;
+
+			if (machine->pages[page].type != SIC_PAGE_RAM)
+				memcpy(machine->vm + start, saved + (start - first), end - start);
+		}
+		free(saved);
+	}
+
+	return device ? SIC_ERR_DEVICE : SIC_OK;
+}
+
+/*************************************************************************************
+* 설명: 메모리의 [addr, addr + len) 범위를 복사 없이 읽을 수 있는 포인터를 얻는다.
+*       MMIO page가 없으면 page table을 보지 않으므로 vm을 바로 읽는 것과 같다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 읽을 범위
+* 반환값: addr번지에 대한 포인터. 범위가 메모리를 벗어나거나 MMIO page가 있으면 NULL
+*************************************************************************************/
+const char* getSicDirect(const SicMachine* machine, unsigned int addr, unsigned int len)
+{
+	if (!checkRange(addr, len))
+		return NULL;
+	if (machine->mmio_pages != 0 && hasPage(machine, addr, len, SIC_PAGE_MMIO))
+		return NULL;
+	return machine->vm + addr;
+}
+
+/*************************************************************************************
+* 설명: [addr, addr + len) 범위의 page들에 장치를 연결한다. 장치의 offset 0이 addr번지가
+*       된다. 연결하면 이전의 메모리 변경 기록은 버린다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 연결할 범위. SIC_PAGE_SIZE의 배수여야 한다.
+* - device: 연결할 장치. 실패하면 호출한 쪽에서 해제해야 한다.
+* 반환값: SIC_OK, 범위가 잘못되었으면 SIC_ERR_RANGE, RAM이 아닌 page가 있으면
+*         SIC_ERR_BUSY
+*************************************************************************************/
+int mapSicDevice(SicMachine* machine, unsigned int addr, unsigned int len, SicDevice* device)
+{
+	unsigned int page;
+
+	if (!checkPageRange(addr, len))
+		return SIC_ERR_RANGE;
+	if (hasPage(machine, addr, len, SIC_PAGE_ROM) || hasPage(machine, addr, len, SIC_PAGE_MMIO))
+		return SIC_ERR_BUSY;
+
+	device->pages = 0;
+	for (page = addr >> SIC_PAGE_SHIFT; page < (addr + len) >> SIC_PAGE_SHIFT; page++) {
+		machine->pages[page].type = SIC_PAGE_MMIO;
+		machine->pages[page].device = device;
+		machine->pages[page].offset = (page << SIC_PAGE_SHIFT) - addr;
+		device->pages++;
+	}
+	machine->mmio_pages += device->pages;
+	clearJournal(&machine->journal);
+	return SIC_OK;
+}
+
+/*************************************************************************************
+* 설명: [addr, addr + len) 범위의 page들을 RAM이나 ROM으로 바꾼다. RAM으로 바꾸면 연결된
+*       장치를 떼어내고, 장치의 마지막 page이면 장치를 해제한다. ROM의 내용은 vm에
+*       있던 그대로이다. 바꾸면 이전의 메모리 변경 기록은 버린다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 바꿀 범위. SIC_PAGE_SIZE의 배수여야 한다.
+* - type: SIC_PAGE_RAM 또는 SIC_PAGE_ROM
+* 반환값: SIC_OK, 범위나 type이 잘못되었으면 SIC_ERR_RANGE, ROM으로 바꿀 범위에
+*         MMIO page가 있으면 SIC_ERR_BUSY
+*************************************************************************************/
+int setSicPages(SicMachine* machine, unsigned int addr, unsigned int len, int type)
+{
+	unsigned int page;
+
+	if (!checkPageRange(addr, len) || (type != SIC_PAGE_RAM && type != SIC_PAGE_ROM))
+		return SIC_ERR_RANGE;
+	if (type == SIC_PAGE_ROM && hasPage(machine, addr, len, SIC_PAGE_MMIO))
+		return SIC_ERR_BUSY;
+
+	for (page = addr >> SIC_PAGE_SHIFT; page < (addr + len) >> SIC_PAGE_SHIFT; page++) {
+		SicPage* cur = &machine->pages[page];
+
+		if (cur->type == SIC_PAGE_ROM)
+			machine->rom_pages--;
+		else if (cur->type == SIC_PAGE_MMIO) {
+			machine->mmio_pages--;
+			if (--cur->device->pages == 0 && cur->device->release != NULL)
+				cur->device->release(cur->device);
+		}
+
+		cur->type = type;
+		cur->device = NULL;
+		cur->offset = 0;
+		if (type == SIC_PAGE_ROM)
+			machine->rom_pages++;
+	}
+	clearJournal(&machine->journal);
+	return SIC_OK;
+}
+
+static int isSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*************************************************************************************
+* 설명: [addr, addr + len) 범위가 메모리 안에 있는지 검사한다.
+* 인자:
+* - addr, len: 검사할 범위
+* 반환값: 메모리 안에 있으면 true(1), 아니면 false(0)
+*************************************************************************************/
+static int checkRange(unsigned int addr, unsigned int len)
+{
+	return addr <= MEM_SIZE && len <= MEM_SIZE - addr;
+}
+
+/*************************************************************************************
+* 설명: [addr, addr + len) 범위가 메모리 안에 있고 page 경계에 맞는지 검사한다.
+* 인자:
+* - addr, len: 검사할 범위
+* 반환값: 비어있지 않고 page 단위이면 true(1), 아니면 false(0)
+*************************************************************************************/
+static int checkPageRange(unsigned int addr, unsigned int len)
+{
+	return checkRange(addr, len) && len > 0 &&
+		(addr & (SIC_PAGE_SIZE - 1)) == 0 && (len & (SIC_PAGE_SIZE - 1)) == 0;
+}
+
+/*************************************************************************************
+* 설명: [addr, addr + len) 범위에 type인 page가 있는지 검사한다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 검사할 범위. 메모리 안에 있어야 한다.
+* - type: 찾을 page의 종류
+* 반환값: 있으면 true(1), 없으면 false(0)
+*************************************************************************************/
+static int hasPage(const SicMachine* machine, unsigned int addr, unsigned int len, int type)
+{
+	unsigned int page;
+
+	if (len == 0)
+		return false;
+
+	for (page = addr >> SIC_PAGE_SHIFT; page <= (addr + len - 1) >> SIC_PAGE_SHIFT; page++) {
+		if (machine->pages[page].type == type)
+			return true;
+	}
+	return false;
+}
+
+/*************************************************************************************
+* 설명: 모든 page를 RAM으로 초기화한다.
+* 인자:
+* - machine: 대상 machine
+* 반환값: 없음
+*************************************************************************************/
+static void initializePages(SicMachine* machine)
+{
+	memset(machine->pages, 0, sizeof(machine->pages));
+	machine->rom_pages = 0;
+	machine->mmio_pages = 0;
+}
+
+/*************************************************************************************
+* 설명: page 단위로 나누어 RAM과 ROM은 vm에서, MMIO는 장치에서 읽는다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 읽을 범위. 메모리 안에 있어야 한다.
+* - dst: 복사할 곳
+* 반환값: 없음
+*************************************************************************************/
+static void readPages(const SicMachine* machine, unsigned int addr, unsigned char* dst, unsigned int len)
+{
+	while (len > 0) {
+		const SicPage* page = &machine->pages[addr >> SIC_PAGE_SHIFT];
+		unsigned int offset = addr & (SIC_PAGE_SIZE - 1);
+		unsigned int cnt = SIC_PAGE_SIZE - offset < len ? SIC_PAGE_SIZE - offset : len;
+
+		if (page->type == SIC_PAGE_MMIO)
+			page->device->read(page->device, page->offset + offset, dst, cnt);
+		else
+			memcpy(dst, machine->vm + addr, cnt);
+
+		addr += cnt;
+		dst += cnt;
+		len -= cnt;
+	}
+}
+
+/*************************************************************************************
+* 설명: page 단위로 나누어 RAM은 vm에, MMIO는 장치에 쓴다. 범위에 ROM page가 있으면
+*       아무 것도 쓰지 않는다. vm에 쓴 내용만 undo할 수 있다.
+* 인자:
+* - machine: 대상 machine
+* - addr, len: 쓸 범위
+* - src: 쓸 내용. NULL이면 value로 채운다.
+* - value: src가 NULL일 때 채울 값
+* 반환값: SIC_OK, 범위가 메모리를 벗어나면 SIC_ERR_RANGE, ROM이 있으면 SIC_ERR_ROM
+*************************************************************************************/
+static int writePages(SicMachine* machine, unsigned int addr, const unsigned char* src, unsigned int len,
+	unsigned char value)
+{
+	unsigned char fill[SIC_PAGE_SIZE];
+
+	if (!checkRange(addr, len))
+		return SIC_ERR_RANGE;
+	if (hasPage(machine, addr, len, SIC_PAGE_ROM))
+		return SIC_ERR_ROM;
+
+	if (src == NULL)
+		memset(fill, value, sizeof(fill));
+
+	beginJournal(&machine->journal, (unsigned char*)machine->vm, addr, len);
+	while (len > 0) {
+		const SicPage* page = &machine->pages[addr >> SIC_PAGE_SHIFT];
+		unsigned int offset = addr & (SIC_PAGE_SIZE - 1);
+		unsigned int cnt = SIC_PAGE_SIZE - offset < len ? SIC_PAGE_SIZE - offset : len;
+
+		/* 장치에 쓴 내용은 기록하지 않고, 그 기록은 되돌릴 수 없다고 표시한다 */
+		if (page->type == SIC_PAGE_MMIO) {
+			page->device->write(page->device, page->offset + offset, src != NULL ? src : fill, cnt);
+			machine->journal.device = true;
+		}
+		else if (src != NULL)
+			memcpy(machine->vm + addr, src, cnt);
+		else
+			memset(machine->vm + addr, value, cnt);
+
+		addr += cnt;
+		if (src != NULL)
+			src += cnt;
+		len -= cnt;
+	}
+	endSicWrite(machine);
+	return SIC_OK;
+}
+
+/*************************************************************************************
+* 설명: 인자로 전달된 key로부터 적절한 hash 값을 얻어낸다.
+*       기본으로 제공되는 hash function 이다.
+* 인자:
+* - key: key
+* 반환값: 해당 key를 이용하여 계산한 hash 값
+*************************************************************************************/
+static int hashFunc(void* key)
+{
+	char* str = (char*)key;
+	int i, sum;
+	int len = strlen(str);
+	for (i = 0, sum = 0; i< len; i++)
+		sum += str[i];
+
+	return sum % 20;
+}
+
+/*************************************************************************************
+* 설명: dst의 len byte를 size byte의 pattern을 반복해서 채운다. 채운 앞부분을 뒤로
+*       복사하며 두 배씩 늘리고, PATTERN_BLOCK보다 커지면 cache에 남아있는 앞부분의
+*       PATTERN_BLOCK 정도만 반복해서 복사한다. 복사하는 크기는 항상 size의 배수이다.
+* 인자:
+* - dst, len: 채울 곳과 길이
+* - pattern, size: 반복할 내용과 그 길이
+* 반환값: 없음
+*************************************************************************************/
+static void repeatPattern(char* dst, unsigned int len, const unsigned char* pattern, unsigned int size)
+{
+	unsigned int block = size < PATTERN_BLOCK ? PATTERN_BLOCK / size * size : size;
+	unsigned int done = size < len ? size : len;
+
+	memcpy(dst, pattern, done);
+	while (done < len) {
+		unsigned int cnt = done < block ? done : block;
+		if (cnt > len - done)
+			cnt = len - done;
+		memcpy(dst + done, dst, cnt);
+		done += cnt;
+	}
+}
+
+/*************************************************************************************
+* 설명: 비어있는 opcode table을 할당한다.
+* 인자: 없음
+* 반환값: 만든 table. 할당하지 못하면 NULL
+*************************************************************************************/
+static SicOpTable* createOpTable(void)
+{
+	SicOpTable* table = (SicOpTable*)malloc(sizeof(SicOpTable));
+
+	if (table != NULL) {
+		initializeHash(&table->table, hashFunc, hashCmp);
+		memset(table->decode, 0, sizeof(table->decode));
+	}
+	return table;
+}
+
+/*************************************************************************************
+* 설명: opcode table과 그 안의 opcode를 모두 해제한다.
+* 인자:
+* - table: 해제할 table. NULL이면 아무 것도 하지 않는다.
+* 반환값: 없음
+*************************************************************************************/
+static void releaseOpTable(SicOpTable* table)
+{
+	if (table == NULL)
+		return;
+
+	foreachHash(&table->table, NULL, releaseOplist);
+	clearHash(&table->table);
+	free(table);
+}
+
+/*************************************************************************************
+* 설명: 새 table을 공개하고 이전 table을 해제한다. 공개한 뒤에 epoch를 넘기면, 새로
+*       읽기 시작하는 쪽은 다른 counter를 올리므로 이전 counter는 언젠가 0이 된다.
+*       epoch를 읽고 counter를 올리기 전에 멈춰 있던 쪽이 있을 수 있으므로 두 counter를
+*       모두 기다린다. 기다리는 것은 table을 바꾸는 쪽뿐이다.
+* 인자:
+* - opcodes: 대상 opcode table
+* - table: 새 table. 실패하면 해제한다.
+* 반환값: SIC_OK 또는 다른 쪽이 table을 바꾸는 중이면 SIC_ERR_BUSY
+*************************************************************************************/
+static int replaceOpTable(SicOpcodes* opcodes, SicOpTable* table)
+{
+	SicOpTable* old;
+	int i;
+
+	if (swapAtomic(&opcodes->reloading, 1) != 0) {
+		releaseOpTable(table);
+		return SIC_ERR_BUSY;
+	}
+
+	old = (SicOpTable*)swapPointer(&opcodes->current, table);
+	for (i = 0; i < 2; i++) {
+		long reader = addAtomic(&opcodes->epoch, 1) & 1;
+		while (loadAtomic(&opcodes->readers[reader]) != 0)
+			yieldThread();
+	}
+	releaseOpTable(old);
+
+	swapAtomic(&opcodes->reloading, 0);
+	return SIC_OK;
+}
+
+/*************************************************************************************
+* 설명: 임의의 key값을 넣으면 hash table의 entry 중에서 같은 key를 갖고 있는
+*       entry를 찾기 위한 비교 함수이다.
+* 인자:
+* - key0: entry의 key 혹은 사용자가 검색을 원하는 key. 같은지만 비교하므로 순서상관없음.
+* - key1: 사용자가 검색을 원하는 key 혹은 entry의 key. 같은지만 비교하므로 순서상관없음.
+* 반환값: 같으면 0, 다르면 그 이외의 값
+*************************************************************************************/
+static int hashCmp(void* key0, void* key1)
+{
+	char* str_a = (char*)key0;
+	char* str_b = (char*)key1;
+
+	return strcmp(str_a, str_b);
+}
+
+/*************************************************************************************
+* 설명: opcodelist는 hash table로 구성되는데, 각 entry의 key로 문자열을 할당했으므로,
+*       할당한 메모리를 해제해 주어야 한다. hash table의 모든 entry에 적용되는
+*       action function으로 data에 할당한 메모리를 해제하는 역할을 한다.
+* 인자:
+* - data: list 각 item의 데이터
+* - aux: 추가적으로 필요하면 활용하기 위한 변수. auxiliary
+* 반환값: 없음
+*************************************************************************************/
+static void releaseOplist(void* data, void* aux)
+{
+	if (data != NULL) {
+		Entry* entry = (Entry*)data;
+		if (entry->key != NULL)
+			free(entry->key);
+		if (entry->value != NULL) {
+			free(entry->value);
+		}
+		free(data);
+	}
+}
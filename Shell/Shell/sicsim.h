@@ -0,0 +1,168 @@
+﻿#ifndef SICSIM_H_
+#define SICSIM_H_
+
+#include <stddef.h>
+#include "hash.h"
+#include "journal.h"
+
+#ifndef true
+#define true 1
+#endif
+#ifndef false
+#define false 0
+#endif
+
+#define MEM_SIZE 0x100000
+
+#define OP_FORMAT_1  1
+#define OP_FORMAT_2  2
+#define OP_FORMAT_34 3
+#define DECODE_SIZE  256
+
+#define SIC_OK          0
+#define SIC_ERR_NOMEM   1
+#define SIC_ERR_RANGE   2
+#define SIC_ERR_EMPTY   3
+#define SIC_ERR_ROM     4
+#define SIC_ERR_BUSY    5
+#define SIC_ERR_DEVICE  6
+
+#define SIC_PAGE_SHIFT  12
+#define SIC_PAGE_SIZE   (1 << SIC_PAGE_SHIFT)
+#define SIC_PAGE_CNT    (MEM_SIZE >> SIC_PAGE_SHIFT)
+
+#define SIC_PAGE_RAM    0
+#define SIC_PAGE_ROM    1
+#define SIC_PAGE_MMIO   2
+
+/*************************************************************************************
+* 설명: opcode table에 저장되는 opcode 하나에 대한 정보
+* mnemonic: opcode의 mnemonic. hash table entry의 key와 같은 문자열을 가리킨다.
+* code: opcode 값
+* format: 명령어 형식. OP_FORMAT_1, OP_FORMAT_2, OP_FORMAT_34 중 하나
+*************************************************************************************/
+typedef struct {
+	char* mnemonic;
+	int code;
+	int format;
+} Opcode;
+
+/*************************************************************************************
+* 설명: opcode table 하나. 만든 뒤에는 바꾸지 않으므로 여러 thread가 lock 없이 읽는다.
+* table: mnemonic을 key로, Opcode를 value로 갖는 hash table
+* decode: 명령어의 첫 바이트로 table의 opcode를 바로 찾기 위한 table
+*************************************************************************************/
+typedef struct {
+	HashTable table;
+	Opcode* decode[DECODE_SIZE];
+} SicOpTable;
+
+/*************************************************************************************
+* 설명: 여러 machine이 함께 쓰는 opcode table. 새 table은 current를 바꾸는 것으로 한 번에
+*       공개한다. 읽는 쪽은 lock 없이 readers[epoch & 1]만 올리고 내리며, table을 바꾼
+*       쪽이 epoch를 두 번 넘기면서 두 counter가 차례로 0이 되기를 기다린 뒤에 이전
+*       table을 해제한다.
+* current: 지금 쓰는 table
+* epoch: 읽는 쪽이 올릴 counter를 고르는 번호
+* readers: epoch의 짝/홀 별로 table을 읽고 있는 수
+* reloading: table을 바꾸는 중인지 여부. 동시에 둘이 바꾸지 못하게 한다.
+*************************************************************************************/
+typedef struct {
+	SicOpTable* current;
+	long epoch;
+	long readers[2];
+	long reloading;
+} SicOpcodes;
+
+/*************************************************************************************
+* 설명: 메모리에 연결하는 장치. 장치를 연결한 page(MMIO)를 읽고 쓰면 vm 대신 장치의
+*       함수를 호출한다. 장치를 만드는 쪽은 이 구조체를 첫 번째 member로 갖는
+*       구조체를 만들고 함수들을 채운다.
+* name: memmap 등에서 보여줄 장치의 이름
+* read: 장치의 offset부터 len byte를 dst로 읽는다. offset은 장치를 연결한 첫 주소부터의
+*       거리이고, len은 page를 넘지 않는다.
+* write: src의 len byte를 장치의 offset부터 쓴다.
+* release: 장치를 연결한 page가 모두 없어지면 호출한다. 장치를 해제한다.
+* pages: 장치를 연결한 page의 수. machine이 관리한다.
+*************************************************************************************/
+typedef struct SicDevice_ {
+	const char* name;
+	void(*read)(struct SicDevice_* device, unsigned int offset, unsigned char* dst, unsigned int len);
+	void(*write)(struct SicDevice_* device, unsigned int offset, const unsigned char* src, unsigned int len);
+	void(*release)(struct SicDevice_* device);
+	int pages;
+} SicDevice;
+
+/*************************************************************************************
+* 설명: 메모리를 SIC_PAGE_SIZE 단위로 나눈 page 하나의 종류. RAM과 ROM은 vm을 그대로
+*       읽고, ROM은 쓸 수 없으며, MMIO는 vm 대신 장치를 읽고 쓴다.
+* type: SIC_PAGE_RAM, SIC_PAGE_ROM, SIC_PAGE_MMIO 중 하나
+* device: MMIO이면 연결한 장치, 아니면 NULL
+* offset: MMIO이면 page의 첫 주소가 장치 안에서 갖는 offset
+*************************************************************************************/
+typedef struct {
+	int type;
+	SicDevice* device;
+	unsigned int offset;
+} SicPage;
+
+/*************************************************************************************
+* 설명: SIC/XE machine 하나의 상태. shell을 거치지 않고 다른 프로그램에서 바로 쓸 수
+*       있도록 메모리와 opcode table만 다루며, 출력이나 파일 입출력은 하지 않는다.
+*       모든 함수는 인자를 검사하고 SIC_OK 또는 SIC_ERR_* 를 반환한다.
+* vm: MEM_SIZE 크기의 메모리
+* shared: vm과 opcodes를 다른 machine에게서 빌려쓰는지 여부
+* opcodes: opcode table. session은 base machine의 것을 함께 쓴다.
+* op_reader: beginSicLookup에서 올린 readers의 index. 읽고 있지 않으면 -1
+* journal: undo/redo를 위한 메모리 변경 기록
+* pages: 메모리 전체의 page table
+* rom_pages, mmio_pages: ROM, MMIO인 page의 수. 둘 다 0이면 page table을 보지 않고
+*       vm을 바로 읽고 쓴다.
+*************************************************************************************/
+typedef struct SicMachine_ {
+	char* vm;
+	int shared;
+	SicOpcodes* opcodes;
+	int op_reader;
+	Journal journal;
+	SicPage pages[SIC_PAGE_CNT];
+	int rom_pages;
+	int mmio_pages;
+} SicMachine;
+
+/* SicMachine 관련 함수 */
+extern SicMachine* createSicMachine(const char* opcodes, size_t len, int* err);
+extern void destroySicMachine(SicMachine* machine);
+extern int initializeSicMachine(SicMachine* machine);
+extern void initializeSicSession(SicMachine* machine, const SicMachine* base, char* vm);
+extern void releaseSicMachine(SicMachine* machine);
+
+/* opcode 관련 함수 */
+extern int loadSicOpcodes(SicMachine* machine, const char* text, size_t len);
+extern int clearSicOpcodes(SicMachine* machine);
+extern const SicOpTable* beginSicLookup(SicMachine* machine);
+extern void endSicLookup(SicMachine* machine);
+extern const Opcode* findSicOpcode(const SicOpTable* table, const char* mnemonic);
+
+/* 메모리 관련 함수 */
+extern int readSicMemory(const SicMachine* machine, unsigned int addr, void* dst, unsigned int len);
+extern int writeSicMemory(SicMachine* machine, unsigned int addr, const void* src, unsigned int len);
+extern int fillSicMemory(SicMachine* machine, unsigned int addr, unsigned int len, unsigned char value);
+extern int fillSicPattern(SicMachine* machine, unsigned int addr, unsigned int len,
+	const unsigned char* pattern, unsigned int size);
+extern int moveSicMemory(SicMachine* machine, unsigned int dst, unsigned int src, unsigned int len);
+extern int resetSicMemory(SicMachine* machine);
+extern char* beginSicWrite(SicMachine* machine, unsigned int addr, unsigned int len);
+extern void endSicWrite(SicMachine* machine);
+extern int undoSicMemory(SicMachine* machine, unsigned int* addr, unsigned int* len);
+extern int redoSicMemory(SicMachine* machine, unsigned int* addr, unsigned int* len);
+extern const char* getSicDirect(const SicMachine* machine, unsigned int addr, unsigned int len);
+extern unsigned long long getSicChange(const SicMachine* machine, int redo);
+extern unsigned long long getSicOldestChange(const SicMachine* machine);
+extern int setSicMemory(SicMachine* machine, char* vm, char** old);
+
+/* page table 관련 함수 */
+extern int mapSicDevice(SicMachine* machine, unsigned int addr, unsigned int len, SicDevice* device);
+extern int setSicPages(SicMachine* machine, unsigned int addr, unsigned int len, int type);
+
+#endif
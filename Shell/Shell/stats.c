@@ -0,0 +1,115 @@
+﻿#include "stats.h"
+#include "alloccount.h"
+#include <stdlib.h>
+
+/*************************************************************************************
+* 설명: 모든 값이 0인 통계를 새로 할당한다. 해제는 free로 한다.
+* 인자: 없음
+* 반환값: 할당한 통계, 실패하면 NULL
+*************************************************************************************/
+ShellStats* createStats(void)
+{
+	ShellStats* stats = (ShellStats*)malloc(sizeof(ShellStats));
+	if (stats != NULL) {
+		resetStats(stats);
+		stats->begin = 0;
+		stats->allocs = 0;
+		stats->out_bytes = 0;
+		stats->vm_bytes = 0;
+	}
+	return stats;
+}
+
+/*************************************************************************************
+* 설명: 지금까지 모은 명령별 통계를 모두 지운다. 실행 중인 명령에 대한 값은 그대로
+*       두므로 명령을 실행하는 도중에 호출해도 된다.
+* 인자:
+* - stats: 통계에 대한 포인터
+* 반환값: 없음
+*************************************************************************************/
+void resetStats(ShellStats* stats)
+{
+	int i;
+
+	for (i = 0; i < CMD_CNT; i++) {
+		initializeHistogram(&stats->cmds[i].latency);
+		stats->cmds[i].errors = 0;
+		stats->cmds[i].allocs = 0;
+		stats->cmds[i].out_bytes = 0;
+		stats->cmds[i].vm_bytes = 0;
+	}
+}
+
+/*************************************************************************************
+* 설명: 명령 실행을 시작하기 직전에 호출한다. 시작 시각과 할당 횟수를 기록하고
+*       출력/메모리 접근량을 0부터 다시 센다.
+* 인자:
+* - stats: 통계에 대한 포인터
+* 반환값: 없음
+*************************************************************************************/
+void beginStats(ShellStats* stats)
+{
+	stats->out_bytes = 0;
+	stats->vm_bytes = 0;
+	stats->allocs = getAllocCount();
+	stats->begin = getTimeNs();
+}
+
+/*************************************************************************************
+* 설명: 명령 실행이 끝난 직후에 호출한다. beginStats 이후의 시간, 할당 횟수,
+*       출력/메모리 접근량을 해당 명령의 통계에 더한다.
+* 인자:
+* - stats: 통계에 대한 포인터
+* - cmd_code: 실행한 명령의 code
+* - error: 명령 실행 후의 error 값
+* 반환값: 없음
+*************************************************************************************/
+void endStats(ShellStats* stats, int cmd_code, int error)
+{
+	unsigned long long elapsed = getTimeNs() - stats->begin;
+	CommandStats* cmd = &stats->cmds[cmd_code];
+
+	recordHistogram(&cmd->latency, elapsed);
+	cmd->allocs += getAllocCount() - stats->allocs;
+	cmd->out_bytes += stats->out_bytes;
+	cmd->vm_bytes += stats->vm_bytes;
+	if (error != ERR_NONE)
+		cmd->errors++;
+}
+
+/*************************************************************************************
+* 설명: 명령별 통계를 JSON으로 path에 저장한다. 한 번도 실행하지 않은 명령은 뺀다.
+*       시간의 단위는 ns이다.
+* 인자:
+* - stats: 통계에 대한 포인터
+* - path: 저장할 파일 경로
+* 반환값: 성공하면 true(1), 파일을 열 수 없으면 false(0)
+*************************************************************************************/
+int exportStats(const ShellStats* stats, const char* path)
+{
+	FILE* fp = fopen(path, "w");
+	int printed = 0;
+	int i;
+
+	if (fp == NULL)
+		return false;
+
+	fprintf(fp, "{\n  \"alloc_counted\": %s,\n  \"commands\": [", isAllocCounted() ? "true" : "false");
+	for (i = 0; i < CMD_CNT; i++) {
+		const CommandStats* cmd = &stats->cmds[i];
+		if (cmd->latency.count == 0)
+			continue;
+
+		fprintf(fp, "%s\n    {\"name\": \"%s\", \"count\": %llu, \"errors\": %llu, "
+			"\"p50_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu, \"total_ns\": %llu, "
+			"\"allocs\": %llu, \"out_bytes\": %llu, \"vm_bytes\": %llu}",
+			printed ? "," : "", getCommandName(i), cmd->latency.count, cmd->errors,
+			getPercentile(&cmd->latency, 50.0), getPercentile(&cmd->latency, 99.0),
+			cmd->latency.max, cmd->latency.sum, cmd->allocs, cmd->out_bytes, cmd->vm_bytes);
+		printed++;
+	}
+	fprintf(fp, "\n  ]\n}\n");
+	fclose(fp);
+
+	return true;
+}
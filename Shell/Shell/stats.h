@@ -0,0 +1,56 @@
+﻿#ifndef STATS_H_
+#define STATS_H_
+
+#include "shell.h"
+#include "histogram.h"
+
+/*************************************************************************************
+* 설명: 명령 하나에 대한 누적 통계
+* latency: 명령 실행 시간(ns)의 histogram
+* errors: 실행 중 error가 발생한 횟수
+* allocs: 메모리를 할당한 횟수의 합
+* out_bytes: 출력한 byte 수의 합
+* vm_bytes: 읽거나 쓴 가상 메모리 byte 수의 합
+*************************************************************************************/
+typedef struct {
+	Histogram latency;
+	unsigned long long errors;
+	unsigned long long allocs;
+	unsigned long long out_bytes;
+	unsigned long long vm_bytes;
+} CommandStats;
+
+/*************************************************************************************
+* 설명: shell 하나에 대한 명령별 통계. SHELL_STATS로 빌드했을 때만 사용한다.
+* cmds: 명령 code별 통계
+* begin: 실행 중인 명령의 시작 시각
+* allocs: 실행 중인 명령을 시작할 때의 할당 횟수
+* out_bytes: 실행 중인 명령이 지금까지 출력한 byte 수
+* vm_bytes: 실행 중인 명령이 지금까지 접근한 가상 메모리 byte 수
+*************************************************************************************/
+typedef struct ShellStats_ {
+	CommandStats cmds[CMD_CNT];
+	unsigned long long begin;
+	unsigned long long allocs;
+	unsigned long long out_bytes;
+	unsigned long long vm_bytes;
+} ShellStats;
+
+/* 명령이 출력하거나 접근한 양을 기록. 통계를 할당하지 못했으면 세지 않고,
+   SHELL_STATS 없이 빌드하면 아무 코드도 만들지 않는다 */
+#ifdef SHELL_STATS
+#define STATS_ADD_OUTPUT(shell, n) do { if ((shell)->stats != NULL) (shell)->stats->out_bytes += (n); } while (0)
+#define STATS_ADD_VM(shell, n)     do { if ((shell)->stats != NULL) (shell)->stats->vm_bytes += (n); } while (0)
+#else
+#define STATS_ADD_OUTPUT(shell, n) ((void)0)
+#define STATS_ADD_VM(shell, n)     ((void)0)
+#endif
+
+/* Stats 관련 함수 */
+extern ShellStats* createStats(void);
+extern void resetStats(ShellStats* stats);
+extern void beginStats(ShellStats* stats);
+extern void endStats(ShellStats* stats, int cmd_code, int error);
+extern int exportStats(const ShellStats* stats, const char* path);
+
+#endif
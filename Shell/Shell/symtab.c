@@ -0,0 +1,602 @@
+﻿#include "symtab.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int hashSymbol(void* key);
+static int compareSymbolKey(void* key0, void* key1);
+static int compareSymbolName(const void* a, const void* b);
+static void releaseSymbolEntry(void* data, void* aux);
+static void removeAllSymbols(SymbolTable* symbols);
+static void deleteSymbol(SymbolTable* symbols, const char* name);
+static int applySymbol(SymbolTable* symbols, const char* name, unsigned int addr);
+static int reserveChanges(SymbolTable* symbols, int cnt);
+
+/*************************************************************************************
+* 설명: symbol table을 비어있는 상태로 초기화한다.
+* 인자:
+* - symbols: 초기화할 table
+* 반환값: 없음
+*************************************************************************************/
+void initializeSymbols(SymbolTable* symbols)
+{
+	initializeHash(&symbols->table, hashSymbol, compareSymbolKey);
+	symbols->by_name = NULL;
+	symbols->by_addr = NULL;
+	symbols->buffer = NULL;
+	symbols->cnt = 0;
+	symbols->cap = 0;
+	symbols->dirty = 0;
+	symbols->staged = NULL;
+	symbols->staged_cnt = 0;
+	symbols->staged_cap = 0;
+	symbols->edits = NULL;
+}
+
+/*************************************************************************************
+* 설명: symbol table이 사용한 메모리를 모두 해제하고 비어있는 상태로 만든다.
+* 인자:
+* - symbols: 해제할 table
+* 반환값: 없음
+*************************************************************************************/
+void releaseSymbols(SymbolTable* symbols)
+{
+	removeAllSymbols(symbols);
+	free(symbols->by_name);
+	free(symbols->by_addr);
+	free(symbols->buffer);
+	dropSymbolEdits(symbols);
+	free(symbols->staged);
+	initializeSymbols(symbols);
+}
+
+/*************************************************************************************
+* 설명: symbol을 추가한다. 같은 이름이 이미 있으면 주소만 바꾼다. 이름은
+*       SYMBOL_NAME_LEN 글자까지만 쓴다. index는 다음 질의 때 다시 만든다.
+* 인자:
+* - symbols: 대상 table
+* - name: symbol 이름
+* - addr: symbol의 주소
+* 반환값: 성공하면 1, 메모리를 할당하지 못하면 0
+*************************************************************************************/
+int insertSymbol(SymbolTable* symbols, const char* name, unsigned int addr)
+{
+	char key[SYMBOL_NAME_LEN + 1];
+	Symbol* symbol;
+	Symbol** arrays[3];
+	int i;
+
+	strncpy(key, name, SYMBOL_NAME_LEN);
+	key[SYMBOL_NAME_LEN] = 0;
+
+	symbol = (Symbol*)getValue(&symbols->table, key);
+	if (symbol != NULL) {
+		symbol->addr = addr;
+		symbols->dirty = 1;
+		return 1;
+	}
+
+	/* 세 배열은 같은 크기로 늘린다. 일부만 늘어나도 cap은 그대로이므로 문제없다 */
+	if (symbols->cnt == symbols->cap) {
+		int cap = symbols->cap > 0 ? symbols->cap * 2 : 64;
+
+		arrays[0] = (Symbol**)realloc(symbols->by_name, sizeof(Symbol*) * cap);
+		if (arrays[0] != NULL)
+			symbols->by_name = arrays[0];
+		arrays[1] = (Symbol**)realloc(symbols->by_addr, sizeof(Symbol*) * cap);
+		if (arrays[1] != NULL)
+			symbols->by_addr = arrays[1];
+		arrays[2] = (Symbol**)realloc(symbols->buffer, sizeof(Symbol*) * cap);
+		if (arrays[2] != NULL)
+			symbols->buffer = arrays[2];
+		for (i = 0; i < 3; i++) {
+			if (arrays[i] == NULL)
+				return 0;
+		}
+		symbols->cap = cap;
+	}
+
+	symbol = (Symbol*)malloc(sizeof(Symbol));
+	if (symbol == NULL)
+		return 0;
+	memcpy(symbol->name, key, sizeof(key));
+	symbol->addr = addr;
+
+	insertHash(&symbols->table, symbol->name, symbol);
+	symbols->by_name[symbols->cnt++] = symbol;
+	symbols->dirty = 1;
+	return 1;
+}
+
+/*************************************************************************************
+* 설명: symbol이 추가되었으면 두 index를 다시 만든다. 이름 순 index는 qsort로 정렬하고,
+*       주소 순 index는 이름 순 index를 SYMBOL_RADIX_BITS씩 LSD radix sort로 정렬한다.
+*       radix sort는 안정 정렬이므로 주소가 같은 symbol은 이름 순으로 남는다. 가장 큰
+*       주소의 bit 수만큼만 반복한다.
+* 인자:
+* - symbols: 대상 table
+* 반환값: 없음
+*************************************************************************************/
+void sortSymbols(SymbolTable* symbols)
+{
+	Symbol** src;
+	Symbol** dst;
+	unsigned int max = 0;
+	unsigned int shift;
+	int i;
+
+	if (!symbols->dirty)
+		return;
+	symbols->dirty = 0;
+
+	/* 비어있으면 배열이 할당되지 않았을 수 있고, 하나뿐이면 정렬할 것이 없다 */
+	if (symbols->cnt < 2 || symbols->by_name == NULL) {
+		if (symbols->cnt == 1)
+			symbols->by_addr[0] = symbols->by_name[0];
+		return;
+	}
+
+	qsort(symbols->by_name, symbols->cnt, sizeof(Symbol*), compareSymbolName);
+
+	for (i = 0; i < symbols->cnt; i++) {
+		if (symbols->by_name[i]->addr > max)
+			max = symbols->by_name[i]->addr;
+	}
+
+	/* by_name에서 시작해서 by_addr와 buffer를 번갈아 쓴다 */
+	src = symbols->by_name;
+	dst = symbols->by_addr;
+	for (shift = 0; shift == 0 || (shift < 32 && (max >> shift) != 0); shift += SYMBOL_RADIX_BITS) {
+		int counts[(1 << SYMBOL_RADIX_BITS) + 1] = { 0, };
+		int digit;
+
+		for (i = 0; i < symbols->cnt; i++)
+			counts[((src[i]->addr >> shift) & ((1 << SYMBOL_RADIX_BITS) - 1)) + 1]++;
+		for (digit = 0; digit < (1 << SYMBOL_RADIX_BITS); digit++)
+			counts[digit + 1] += counts[digit];
+		for (i = 0; i < symbols->cnt; i++)
+			dst[counts[(src[i]->addr >> shift) & ((1 << SYMBOL_RADIX_BITS) - 1)]++] = src[i];
+
+		src = dst;
+		dst = dst == symbols->by_addr ? symbols->buffer : symbols->by_addr;
+	}
+
+	/* 마지막 결과가 buffer에 있으면 by_addr와 바꾼다 */
+	if (src == symbols->buffer) {
+		symbols->buffer = symbols->by_addr;
+		symbols->by_addr = src;
+	}
+}
+
+/*************************************************************************************
+* 설명: 이름이 prefix로 시작하는 symbol들을 이름 순 index에서 찾는다. 처음과 끝을
+*       각각 이진 탐색으로 찾는다.
+* 인자:
+* - symbols: 대상 table
+* - prefix: 찾을 이름의 앞부분. 빈 문자열이면 모든 symbol
+* - last: 찾은 범위의 끝(포함하지 않음)을 저장할 곳
+* 반환값: 찾은 범위의 처음. by_name[반환값, *last)가 찾은 symbol들이다.
+*************************************************************************************/
+int findSymbolPrefix(SymbolTable* symbols, const char* prefix, int* last)
+{
+	size_t len = strlen(prefix);
+	int lo = 0;
+	int hi;
+
+	sortSymbols(symbols);
+
+	/* prefix 이상인 첫 번째 이름 */
+	hi = symbols->cnt;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (strcmp(symbols->by_name[mid]->name, prefix) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	/* 앞부분이 prefix보다 큰 첫 번째 이름 */
+	*last = lo;
+	hi = symbols->cnt;
+	while (*last < hi) {
+		int mid = *last + (hi - *last) / 2;
+		if (strncmp(symbols->by_name[mid]->name, prefix, len) <= 0)
+			*last = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/*************************************************************************************
+* 설명: 주소가 [start, end] 범위에 있는 symbol들을 주소 순 index에서 찾는다.
+* 인자:
+* - symbols: 대상 table
+* - start, end: 찾을 주소의 범위. end도 포함한다.
+* - last: 찾은 범위의 끝(포함하지 않음)을 저장할 곳
+* 반환값: 찾은 범위의 처음. by_addr[반환값, *last)가 찾은 symbol들이다.
+*************************************************************************************/
+int findSymbolRange(SymbolTable* symbols, unsigned int start, unsigned int end, int* last)
+{
+	int lo = 0;
+	int hi;
+
+	sortSymbols(symbols);
+
+	/* 주소가 start 이상인 첫 번째 symbol */
+	hi = symbols->cnt;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (symbols->by_addr[mid]->addr < start)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	/* 주소가 end보다 큰 첫 번째 symbol */
+	*last = lo;
+	hi = symbols->cnt;
+	while (*last < hi) {
+		int mid = *last + (hi - *last) / 2;
+		if (symbols->by_addr[mid]->addr <= end)
+			*last = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/*************************************************************************************
+* 설명: addr번지이거나 그보다 앞에 있는 symbol 중 가장 가까운 것을 찾는다. 같은 주소의
+*       symbol이 여럿이면 이름 순으로 첫 번째 것이다.
+* 인자:
+* - symbols: 대상 table
+* - addr: 찾을 주소
+* 반환값: 찾은 symbol. addr보다 앞에 symbol이 없으면 NULL
+*************************************************************************************/
+const Symbol* findSymbolAt(SymbolTable* symbols, unsigned int addr)
+{
+	int lo = 0;
+	int hi = symbols->cnt;
+	int first;
+
+	sortSymbols(symbols);
+
+	/* 주소가 addr보다 큰 첫 번째 symbol의 바로 앞 */
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (symbols->by_addr[mid]->addr <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == 0)
+		return NULL;
+
+	/* 같은 주소 중 첫 번째 */
+	first = lo - 1;
+	while (first > 0 && symbols->by_addr[first - 1]->addr == symbols->by_addr[lo - 1]->addr)
+		first--;
+	return symbols->by_addr[first];
+}
+
+/*************************************************************************************
+* 설명: symbol을 추가하거나 주소를 바꾸고 그 변경을 staged에 남긴다. 메모리를 바꾸기
+*       전에 호출하고, 메모리를 바꾸면 commitSymbols로, 실패하면 rollbackSymbols로
+*       끝낸다.
+* 인자:
+* - symbols: 대상 table
+* - name: symbol 이름
+* - addr: symbol의 주소
+* 반환값: 성공하면 1, 메모리를 할당하지 못하면 아무 것도 바꾸지 않고 0
+*************************************************************************************/
+int stageSymbol(SymbolTable* symbols, const char* name, unsigned int addr)
+{
+	SymbolChange* change;
+	const Symbol* symbol;
+
+	if (!reserveChanges(symbols, symbols->staged_cnt + 1))
+		return 0;
+
+	change = &symbols->staged[symbols->staged_cnt];
+	strncpy(change->name, name, SYMBOL_NAME_LEN);
+	change->name[SYMBOL_NAME_LEN] = 0;
+	symbol = (const Symbol*)getValue(&symbols->table, change->name);
+	change->before = symbol != NULL ? symbol->addr : SYMBOL_NONE;
+	change->after = addr;
+
+	if (!insertSymbol(symbols, change->name, addr))
+		return 0;
+	symbols->staged_cnt++;
+	return 1;
+}
+
+/*************************************************************************************
+* 설명: 모든 symbol을 지우고 그 변경을 staged에 남긴다. 메모리 전체를 지울 때 쓴다.
+* 인자:
+* - symbols: 대상 table
+* 반환값: 성공하면 1, 메모리를 할당하지 못하면 아무 것도 바꾸지 않고 0
+*************************************************************************************/
+int stageClearSymbols(SymbolTable* symbols)
+{
+	int i;
+
+	if (!reserveChanges(symbols, symbols->staged_cnt + symbols->cnt))
+		return 0;
+
+	for (i = 0; i < symbols->cnt; i++) {
+		SymbolChange* change = &symbols->staged[symbols->staged_cnt++];
+
+		memcpy(change->name, symbols->by_name[i]->name, sizeof(change->name));
+		change->before = symbols->by_name[i]->addr;
+		change->after = SYMBOL_NONE;
+	}
+	removeAllSymbols(symbols);
+	return 1;
+}
+
+/*************************************************************************************
+* 설명: staged에 남은 변경을 거꾸로 되돌린다. 메모리를 바꾸지 못했을 때 쓴다.
+* 인자:
+* - symbols: 대상 table
+* 반환값: 모두 되돌렸으면 1, 지운 symbol을 다시 만들 메모리가 없었으면 0
+*************************************************************************************/
+int rollbackSymbols(SymbolTable* symbols)
+{
+	int result = 1;
+	int i;
+
+	for (i = symbols->staged_cnt - 1; i >= 0; i--)
+		result &= applySymbol(symbols, symbols->staged[i].name, symbols->staged[i].before);
+	symbols->staged_cnt = 0;
+	return result;
+}
+
+/*************************************************************************************
+* 설명: staged에 남은 변경을 id번 메모리 변경에 연결한다. 새 변경이 기록되면 redo할
+*       수 있던 변경은 버려지므로 undo된 기록을 버리고, 메모리 변경의 기록이 버려진
+*       oldest번보다 오래된 기록도 버린다. 메모리 변경을 기록하지 않았으면(id가 0)
+*       연결하지 않고 버리므로, 그 변경은 symbol과 함께 undo할 수 없다.
+* 인자:
+* - symbols: 대상 table
+* - id: 연결할 메모리 변경의 번호 (getSicChange), 없으면 0
+* - oldest: 남아있는 가장 오래된 메모리 변경의 번호 (getSicOldestChange)
+* 반환값: 성공하면 1, 기록을 위한 메모리를 할당하지 못하면 0. 실패해도 symbol은 그대로
+*         두고, 이번 변경은 symbol과 함께 undo할 수 없다.
+*************************************************************************************/
+int commitSymbols(SymbolTable* symbols, unsigned long long id, unsigned long long oldest)
+{
+	SymbolEdit** link = &symbols->edits;
+	SymbolEdit* edit;
+	int result = 1;
+
+	while (*link != NULL) {
+		edit = *link;
+		if (edit->id < oldest || (id != 0 && edit->undone)) {
+			*link = edit->next;
+			free(edit);
+		}
+		else
+			link = &edit->next;
+	}
+
+	if (id != 0 && symbols->staged_cnt > 0) {
+		edit = (SymbolEdit*)malloc(sizeof(SymbolEdit) + sizeof(SymbolChange) * (symbols->staged_cnt - 1));
+		if (edit != NULL) {
+			edit->id = id;
+			edit->cnt = symbols->staged_cnt;
+			edit->undone = 0;
+			memcpy(edit->changes, symbols->staged, sizeof(SymbolChange) * symbols->staged_cnt);
+			edit->next = symbols->edits;
+			symbols->edits = edit;
+		}
+		else
+			result = 0;
+	}
+	symbols->staged_cnt = 0;
+	return result;
+}
+
+/*************************************************************************************
+* 설명: id번 메모리 변경을 undo하거나 redo할 때 연결된 symbol 변경도 되돌리거나 다시
+*       한다. 연결된 기록이 없으면 아무 것도 하지 않는다.
+* 인자:
+* - symbols: 대상 table
+* - id: undo하거나 redo한 메모리 변경의 번호
+* - redo: 0이면 되돌리고, 아니면 다시 한다.
+* 반환값: 성공하면 1, symbol을 다시 만들 메모리가 없었으면 0
+*************************************************************************************/
+int replaySymbols(SymbolTable* symbols, unsigned long long id, int redo)
+{
+	SymbolEdit* edit;
+	int result = 1;
+	int i;
+
+	for (edit = symbols->edits; edit != NULL && edit->id != id; edit = edit->next);
+	if (edit == NULL || id == 0)
+		return 1;
+
+	edit->undone = !redo;
+	if (redo) {
+		for (i = 0; i < edit->cnt; i++)
+			result &= applySymbol(symbols, edit->changes[i].name, edit->changes[i].after);
+	}
+	else {
+		for (i = edit->cnt - 1; i >= 0; i--)
+			result &= applySymbol(symbols, edit->changes[i].name, edit->changes[i].before);
+	}
+	return result;
+}
+
+/*************************************************************************************
+* 설명: 메모리 변경에 연결한 기록과 staged를 모두 버린다. symbol은 그대로 둔다. 메모리
+*       변경 기록을 버릴 때 함께 호출한다.
+* 인자:
+* - symbols: 대상 table
+* 반환값: 없음
+*************************************************************************************/
+void dropSymbolEdits(SymbolTable* symbols)
+{
+	while (symbols->edits != NULL) {
+		SymbolEdit* edit = symbols->edits;
+		symbols->edits = edit->next;
+		free(edit);
+	}
+	symbols->staged_cnt = 0;
+}
+
+/*************************************************************************************
+* 설명: symbol 이름에 대한 hash 값을 계산한다.
+* 인자:
+* - key: symbol 이름
+* 반환값: [0, BUCKET_SIZE) 범위의 hash 값
+*************************************************************************************/
+static int hashSymbol(void* key)
+{
+	const unsigned char* str = (const unsigned char*)key;
+	unsigned int hash = 0;
+
+	while (*str != 0)
+		hash = hash * 31 + *str++;
+	return (int)(hash % BUCKET_SIZE);
+}
+
+/*************************************************************************************
+* 설명: hash table에서 symbol 이름을 비교한다.
+* 인자:
+* - key0, key1: 비교할 두 이름
+* 반환값: 같으면 0, 다르면 그 이외의 값
+*************************************************************************************/
+static int compareSymbolKey(void* key0, void* key1)
+{
+	return strcmp((const char*)key0, (const char*)key1);
+}
+
+/*************************************************************************************
+* 설명: qsort에서 두 symbol을 이름 순으로 비교한다.
+* 인자:
+* - a, b: Symbol*에 대한 포인터
+* 반환값: strcmp와 같다.
+*************************************************************************************/
+static int compareSymbolName(const void* a, const void* b)
+{
+	return strcmp((*(Symbol* const*)a)->name, (*(Symbol* const*)b)->name);
+}
+
+/*************************************************************************************
+* 설명: hash table의 entry를 해제한다. key와 value는 symbol이므로 따로 해제한다.
+* 인자:
+* - data: 해제할 entry
+* - aux: 사용하지 않음
+* 반환값: 없음
+*************************************************************************************/
+static void releaseSymbolEntry(void* data, void* aux)
+{
+	free(data);
+}
+
+/*************************************************************************************
+* 설명: 모든 symbol과 hash table의 entry를 해제한다. 배열과 변경 기록은 그대로 둔다.
+* 인자:
+* - symbols: 대상 table
+* 반환값: 없음
+*************************************************************************************/
+static void removeAllSymbols(SymbolTable* symbols)
+{
+	int i;
+
+	for (i = 0; i < symbols->cnt; i++)
+		free(symbols->by_name[i]);
+	foreachHash(&symbols->table, NULL, releaseSymbolEntry);
+	clearHash(&symbols->table);
+	symbols->cnt = 0;
+	symbols->dirty = 1;
+}
+
+/*************************************************************************************
+* 설명: name인 symbol을 지운다. hash table의 bucket에서 node를 떼어내고, 이름 순
+*       index에서는 마지막 symbol을 그 자리로 옮긴다. index는 다음 질의 때 다시 만든다.
+* 인자:
+* - symbols: 대상 table
+* - name: 지울 symbol의 이름
+* 반환값: 없음
+*************************************************************************************/
+static void deleteSymbol(SymbolTable* symbols, const char* name)
+{
+	List* bucket = &symbols->table.buckets[hashSymbol((void*)name)];
+	Node* prev = NULL;
+	Node* node;
+	Symbol* symbol = NULL;
+	int i;
+
+	for (node = bucket->head; node != NULL; prev = node, node = node->next) {
+		Entry* entry = (Entry*)node->data;
+
+		if (!strcmp((const char*)entry->key, name)) {
+			symbol = (Symbol*)entry->value;
+			if (prev != NULL)
+				prev->next = node->next;
+			else
+				bucket->head = node->next;
+			if (bucket->tail == node)
+				bucket->tail = prev;
+			free(entry);
+			free(node);
+			break;
+		}
+	}
+	if (symbol == NULL)
+		return;
+
+	for (i = 0; i < symbols->cnt; i++) {
+		if (symbols->by_name[i] == symbol) {
+			symbols->by_name[i] = symbols->by_name[--symbols->cnt];
+			break;
+		}
+	}
+	free(symbol);
+	symbols->dirty = 1;
+}
+
+/*************************************************************************************
+* 설명: 변경 기록의 주소 하나를 적용한다. SYMBOL_NONE이면 symbol을 지운다.
+* 인자:
+* - symbols: 대상 table
+* - name: symbol 이름
+* - addr: 적용할 주소
+* 반환값: 성공하면 1, 메모리를 할당하지 못하면 0
+*************************************************************************************/
+static int applySymbol(SymbolTable* symbols, const char* name, unsigned int addr)
+{
+	if (addr == SYMBOL_NONE) {
+		deleteSymbol(symbols, name);
+		return 1;
+	}
+	return insertSymbol(symbols, name, addr);
+}
+
+/*************************************************************************************
+* 설명: staged에 cnt개 이상의 변경을 담을 공간을 확보한다.
+* 인자:
+* - symbols: 대상 table
+* - cnt: 필요한 변경의 갯수
+* 반환값: 성공하면 1, 메모리를 할당하지 못하면 0
+*************************************************************************************/
+static int reserveChanges(SymbolTable* symbols, int cnt)
+{
+	SymbolChange* staged;
+	int cap = symbols->staged_cap > 0 ? symbols->staged_cap : 16;
+
+	if (cnt <= symbols->staged_cap)
+		return 1;
+	while (cap < cnt)
+		cap *= 2;
+
+	staged = (SymbolChange*)realloc(symbols->staged, sizeof(SymbolChange) * cap);
+	if (staged == NULL)
+		return 0;
+	symbols->staged = staged;
+	symbols->staged_cap = cap;
+	return 1;
+}
@@ -0,0 +1,93 @@
+﻿#ifndef SYMTAB_H_
+#define SYMTAB_H_
+
+#include "hash.h"
+
+#define SYMBOL_NAME_LEN 6
+#define SYMBOL_RADIX_BITS 8
+#define SYMBOL_NONE       0xFFFFFFFFu
+
+/*************************************************************************************
+* 설명: 이름과 주소를 갖는 symbol 하나
+* name: symbol 이름
+* addr: symbol의 주소
+*************************************************************************************/
+typedef struct {
+	char name[SYMBOL_NAME_LEN + 1];
+	unsigned int addr;
+} Symbol;
+
+/*************************************************************************************
+* 설명: symbol 하나의 변경. 주소가 SYMBOL_NONE이면 그 symbol이 없었다는 뜻이다.
+* name: symbol 이름
+* before, after: 바뀌기 전과 후의 주소
+*************************************************************************************/
+typedef struct {
+	char name[SYMBOL_NAME_LEN + 1];
+	unsigned int before;
+	unsigned int after;
+} SymbolChange;
+
+/*************************************************************************************
+* 설명: 메모리 변경 하나와 함께 한 symbol 변경들. 메모리를 undo/redo할 때 같은 번호의
+*       기록을 찾아서 symbol도 되돌린다.
+* id: 연결된 메모리 변경의 번호 (getSicChange)
+* cnt: changes의 갯수
+* undone: undo되어 redo를 기다리는지 여부
+* next: 더 오래된 기록
+* changes: 한 차례로 적용한 변경들
+*************************************************************************************/
+typedef struct SymbolEdit_ {
+	unsigned long long id;
+	int cnt;
+	int undone;
+	struct SymbolEdit_* next;
+	SymbolChange changes[1];
+} SymbolEdit;
+
+/*************************************************************************************
+* 설명: symbol들의 table. 이름으로는 hash table에서 바로 찾고, 순서가 필요한 질의는
+*       이름 순과 주소 순으로 정렬한 두 index에서 이진 탐색으로 찾는다. index는
+*       symbol이 추가되면 다음 질의 때 한 번에 다시 만든다. 주소 순 index는 이름 순
+*       index를 주소에 대한 radix sort로 정렬하므로 주소가 같으면 이름 순이다.
+* table: 이름을 key로, Symbol을 value로 갖는 hash table
+* by_name: 이름 순으로 정렬한 symbol들
+* by_addr: 주소 순으로 정렬한 symbol들
+* buffer: radix sort에서 쓰는 임시 배열
+* cnt, cap: symbol의 수와 배열들의 크기
+* dirty: index를 다시 만들어야 하는지 여부
+* staged: stageSymbol 등으로 바꾸었지만 아직 메모리 변경에 연결하지 않은 변경들
+* staged_cnt, staged_cap: staged의 갯수와 크기
+* edits: 메모리 변경에 연결한 기록들. 최근 것부터 연결되어 있고, 메모리 변경의
+*        기록이 버려지면 함께 버린다.
+*************************************************************************************/
+typedef struct {
+	HashTable table;
+	Symbol** by_name;
+	Symbol** by_addr;
+	Symbol** buffer;
+	int cnt;
+	int cap;
+	int dirty;
+	SymbolChange* staged;
+	int staged_cnt;
+	int staged_cap;
+	SymbolEdit* edits;
+} SymbolTable;
+
+/* SymbolTable 관련 함수 */
+extern void initializeSymbols(SymbolTable* symbols);
+extern void releaseSymbols(SymbolTable* symbols);
+extern int insertSymbol(SymbolTable* symbols, const char* name, unsigned int addr);
+extern void sortSymbols(SymbolTable* symbols);
+extern int findSymbolPrefix(SymbolTable* symbols, const char* prefix, int* last);
+extern int findSymbolRange(SymbolTable* symbols, unsigned int start, unsigned int end, int* last);
+extern const Symbol* findSymbolAt(SymbolTable* symbols, unsigned int addr);
+extern int stageSymbol(SymbolTable* symbols, const char* name, unsigned int addr);
+extern int stageClearSymbols(SymbolTable* symbols);
+extern int rollbackSymbols(SymbolTable* symbols);
+extern int commitSymbols(SymbolTable* symbols, unsigned long long id, unsigned long long oldest);
+extern int replaySymbols(SymbolTable* symbols, unsigned long long id, int redo);
+extern void dropSymbolEdits(SymbolTable* symbols);
+
+#endif